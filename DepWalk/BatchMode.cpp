@@ -0,0 +1,875 @@
+#include "pch.h"
+#include "BatchMode.h"
+#include "Reports.h"
+#include <shellapi.h>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <unordered_set>
+#include <BatchScanner.h>
+#include <ElfLoader.h>
+#include <ExportIndex.h>
+#include <GraphExport.h>
+#include <PathQuery.h>
+#include <ImportLibrary.h>
+#include <Toolchain.h>
+#include <Packing.h>
+#include <ScanDatabase.h>
+#include <SimdScan.h>
+
+namespace {
+	struct Arguments {
+		std::wstring Path;
+		std::wstring Report{ L"toolchain" };
+		std::wstring Output;
+		std::wstring Libraries;
+		std::wstring SysRoot;
+		std::wstring Database;
+		std::wstring Graph;
+		GraphExport::Options GraphOptions;
+		std::wstring Root;
+		std::wstring Module;
+		uint32_t MaxPaths{ 20 };
+		std::wstring Index;
+		std::wstring Function;
+		BatchScanner::Options Options;
+
+		Arguments() {
+			Options.MaxFileCpuTime = 10000;
+			Options.ParseOptions.ullMaxAlloc = 512ULL << 20;
+		}
+	};
+
+	using ReportFunction = std::wstring(*)(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const& args);
+
+	std::wstring ToolchainReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const&) {
+		auto histogram = scanner.Scan<ToolchainHistogram>(files, [](ToolchainHistogram& h, PEFile const& pe) {
+			h.Add(pe->GetRichHeader());
+			});
+		return histogram.ToString();
+	}
+
+	//
+	// imported module names as they occur in the corpus, duplicates included
+	//
+	struct ImportNames {
+		void Merge(ImportNames const& other) {
+			Names.insert(Names.end(), other.Names.begin(), other.Names.end());
+		}
+
+		std::vector<std::wstring> Names;
+	};
+
+	//
+	// times the locale-aware CRT compares against the SimdScan name kernels on the import names of the corpus
+	//
+	std::wstring NamesReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const&) {
+		auto imports = scanner.Scan<ImportNames>(files, [](ImportNames& state, PEFile const& pe) {
+			if (auto imports = pe->GetImport(); imports)
+				for (auto& lib : *imports)
+					state.Names.emplace_back((PCWSTR)CString(lib.ModuleName.c_str()));
+			});
+		auto& names = imports.Names;
+		if (names.empty())
+			return L"No imports\n";
+
+		std::vector<std::wstring> table(names);
+		std::ranges::sort(table, SimdScan::NameLess());
+		table.erase(std::unique(table.begin(), table.end(), SimdScan::NameEquals()), table.end());
+
+		std::wstring text = std::format(L"Import names: {}, distinct: {}\n\n{:<28} {:>12} {:>12} {:>8}\n",
+			names.size(), table.size(), L"Operation", L"CRT ns/op", L"SIMD ns/op", L"Speedup");
+
+		//
+		// each operation runs both ways on the same inputs; the results have to agree
+		//
+		size_t mismatches = 0;
+		auto measure = [&](PCWSTR operation, size_t ops, auto&& crt, auto&& simd) {
+			using Clock = std::chrono::steady_clock;
+			ops = (std::max<size_t>)(ops, 1);
+			auto start = Clock::now();
+			auto r1 = crt();
+			auto t1 = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+			start = Clock::now();
+			auto r2 = simd();
+			auto t2 = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+			if (r1 != r2)
+				mismatches++;
+			text += std::format(L"{:<28} {:>12.1f} {:>12.1f} {:>7.2f}x\n", operation, t1, t2, t2 > 0 ? t1 / t2 : 0.0);
+		};
+
+		measure(L"Equals (adjacent names)", names.size() - 1, [&] {
+			size_t equal = 0;
+			for (size_t i = 1; i < names.size(); i++)
+				equal += _wcsicmp(names[i - 1].c_str(), names[i].c_str()) == 0;
+			return equal;
+			}, [&] {
+			size_t equal = 0;
+			for (size_t i = 1; i < names.size(); i++)
+				equal += SimdScan::EqualsNoCase(names[i - 1], names[i]);
+			return equal;
+			});
+
+		measure(L"Api set classification", names.size(), [&] {
+			size_t count = 0;
+			for (auto& name : names)
+				count += _wcsnicmp(name.c_str(), L"api-ms-", 7) == 0 || _wcsnicmp(name.c_str(), L"ext-ms-", 7) == 0;
+			return count;
+			}, [&] {
+			size_t count = 0;
+			for (auto& name : names)
+				count += SimdScan::IsApiSetName(name);
+			return count;
+			});
+
+		auto sortOps = static_cast<size_t>(table.size() * (std::max)(1.0, std::log2(table.size())));
+		measure(L"Sort distinct names", sortOps, [&] {
+			auto sorted = table;
+			std::ranges::reverse(sorted);
+			std::ranges::sort(sorted, [](auto& s1, auto& s2) { return _wcsicmp(s1.c_str(), s2.c_str()) < 0; });
+			return sorted;
+			}, [&] {
+			auto sorted = table;
+			std::ranges::reverse(sorted);
+			std::ranges::sort(sorted, SimdScan::NameLess());
+			return sorted;
+			});
+
+		//
+		// module table lookups as done during resolution: ordered map keyed with _wcsicmp
+		// (what the module table used to be) against the hashed table
+		//
+		struct CrtLess {
+			bool operator()(std::wstring const& s1, std::wstring const& s2) const {
+				return _wcsicmp(s1.c_str(), s2.c_str()) < 0;
+			}
+		};
+		std::map<std::wstring, size_t, CrtLess> crtMap;
+		std::unordered_map<std::wstring, size_t, SimdScan::NameHash, SimdScan::NameEquals> simdMap;
+		for (size_t i = 0; i < table.size(); i++) {
+			crtMap.insert({ table[i], i });
+			simdMap.insert({ table[i], i });
+		}
+		measure(L"Module table lookup", names.size(), [&] {
+			size_t sum = 0;
+			for (auto& name : names)
+				if (auto it = crtMap.find(name); it != crtMap.end())
+					sum += it->second;
+			return sum;
+			}, [&] {
+			size_t sum = 0;
+			for (auto& name : names)
+				if (auto it = simdMap.find(name); it != simdMap.end())
+					sum += it->second;
+			return sum;
+			});
+
+		if (mismatches)
+			text += std::format(L"\n{} operation(s) gave different results!\n", mismatches);
+		return text;
+	}
+
+	//
+	// PE entries of each package and the modules they import
+	//
+	struct PackageImports {
+		struct Package {
+			std::vector<std::wstring> Entries;
+			std::vector<std::wstring> Imports;
+		};
+
+		void Merge(PackageImports const& other) {
+			for (auto& [name, package] : other.Packages) {
+				auto& p = Packages[name];
+				p.Entries.insert(p.Entries.end(), package.Entries.begin(), package.Entries.end());
+				p.Imports.insert(p.Imports.end(), package.Imports.begin(), package.Imports.end());
+			}
+		}
+
+		std::map<std::wstring, Package> Packages;
+	};
+
+	//
+	// resolves the imports of every package's PE entries against the other entries of the same package
+	//
+	std::wstring PackagesReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const&) {
+		auto result = scanner.Scan<PackageImports>(files, [](PackageImports& state, PEFile const& pe) {
+			std::wstring_view package, entry;
+			BatchScanner::SplitPath(pe.GetPath(), package, entry);
+			if (package.empty())
+				return;
+
+			auto& p = state.Packages[std::wstring(package)];
+			p.Entries.emplace_back(entry);
+			if (auto imports = pe->GetImport(); imports)
+				for (auto& lib : *imports)
+					p.Imports.emplace_back((PCWSTR)CString(lib.ModuleName.c_str()));
+			});
+
+		std::wstring text = std::format(L"Packages with PE entries: {}\n", result.Packages.size());
+		for (auto& [name, package] : result.Packages) {
+			std::unordered_set<std::wstring_view, SimdScan::NameHash, SimdScan::NameEquals> entryNames;
+			for (auto& entry : package.Entries) {
+				auto slash = entry.find_last_of(L"/\\");
+				entryNames.insert(slash == std::wstring::npos ? std::wstring_view(entry) : std::wstring_view(entry).substr(slash + 1));
+			}
+
+			auto& imports = package.Imports;
+			std::ranges::sort(imports, SimdScan::NameLess());
+			imports.erase(std::unique(imports.begin(), imports.end(), SimdScan::NameEquals()), imports.end());
+
+			std::wstring inside, outside;
+			size_t insideCount = 0, apiSets = 0;
+			for (auto& import : imports) {
+				if (entryNames.contains(import)) {
+					inside += (insideCount++ ? L", " : L"") + import;
+				}
+				else if (SimdScan::IsApiSetName(import))
+					apiSets++;
+				else
+					outside += (outside.empty() ? L"" : L", ") + import;
+			}
+
+			text += std::format(L"\n{}\n  {} PE entries, {} imported modules: {} in package, {} api sets, {} outside\n",
+				name, package.Entries.size(), imports.size(), insideCount, apiSets, imports.size() - insideCount - apiSets);
+			if (!inside.empty())
+				text += L"  in package: " + inside + L"\n";
+			if (!outside.empty())
+				text += L"  outside: " + outside + L"\n";
+		}
+		return text;
+	}
+
+	//
+	// scanned DLLs checked against the import libraries naming them
+	//
+	struct ImportLibraryChecks {
+		struct Result {
+			std::wstring Path;
+			size_t Library;
+			std::vector<ImportLibrary::Mismatch> Mismatches;
+		};
+
+		void Merge(ImportLibraryChecks const& other) {
+			Results.insert(Results.end(), other.Results.begin(), other.Results.end());
+		}
+
+		std::vector<Result> Results;
+	};
+
+	//
+	// what the import libraries under /libs make the linker expect, against what the DLLs found by /scan export
+	//
+	std::wstring ImportLibraryReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const& args) {
+		if (args.Libraries.empty())
+			return L"No import libraries given (/libs)\n";
+
+		//
+		// the libraries stay mapped for the whole scan, the imports point into them
+		//
+		std::vector<std::wstring> paths = scanner.EnumerateFiles(args.Libraries, [](auto ext) { return SimdScan::EqualsNoCase(ext, L".lib"); });
+		std::vector<std::unique_ptr<ImportLibrary>> libraries;
+		struct Expectation {
+			size_t Library;
+			std::string_view Dll;		// as spelled in the library
+		};
+		std::unordered_map<std::wstring, std::vector<Expectation>, SimdScan::NameHash, SimdScan::NameEquals> byDll;
+		std::vector<std::wstring> libraryPaths;
+		size_t imports = 0, symbols = 0;
+		for (auto& path : paths) {
+			auto lib = std::make_unique<ImportLibrary>();
+			if (!lib->Open(path) || lib->GetImports().empty())
+				continue;
+			for (auto dll : lib->GetDlls())
+				byDll[(PCWSTR)CString(dll.data(), (int)dll.size())].push_back({ libraries.size(), dll });
+			imports += lib->GetImports().size();
+			symbols += lib->GetSymbolCount();
+			libraryPaths.push_back(path);
+			libraries.push_back(std::move(lib));
+		}
+
+		auto result = scanner.Scan<ImportLibraryChecks>(files, [&](ImportLibraryChecks& state, PEFile const& pe) {
+			auto& path = pe.GetPath();
+			auto slash = path.find_last_of(L"\\/|");
+			auto it = byDll.find(slash == std::wstring::npos ? path : path.substr(slash + 1));
+			auto exports = pe->GetExport();
+			if (it == byDll.end() || exports == nullptr)
+				return;
+
+			for (auto& e : it->second)
+				state.Results.push_back({ path, e.Library, libraries[e.Library]->Check(e.Dll, *exports) });
+			});
+
+		std::ranges::sort(result.Results, [](auto& r1, auto& r2) { return SimdScan::CompareNoCase(r1.Path, r2.Path) < 0; });
+		std::unordered_set<std::wstring_view, SimdScan::NameHash, SimdScan::NameEquals> found;
+		std::wstring text = std::format(L"Import libraries: {}, symbols: {}, short imports: {}, DLLs named: {}\n",
+			libraries.size(), symbols, imports, byDll.size());
+
+		for (auto& r : result.Results) {
+			auto slash = r.Path.find_last_of(L"\\/|");
+			found.insert(slash == std::wstring::npos ? std::wstring_view(r.Path) : std::wstring_view(r.Path).substr(slash + 1));
+
+			text += std::format(L"\n{}\n  {}: {} mismatch(es)\n", r.Path, libraryPaths[r.Library], r.Mismatches.size());
+			for (auto& m : r.Mismatches) {
+				auto& import = *m.Entry;
+				text += std::format(L"  {:<16} {}", ImportLibrary::MismatchKindToString(m.Problem), (PCWSTR)CString(import.Symbol.data(), (int)import.Symbol.size()));
+				if (import.ByOrdinal())
+					text += std::format(L" (ordinal {})\n", import.OrdinalOrHint);
+				else
+					text += std::format(L" ({}, hint {})\n", (PCWSTR)CString(import.Name.data(), (int)import.Name.size()), import.OrdinalOrHint);
+			}
+		}
+
+		std::vector<std::wstring_view> missing;
+		for (auto& [dll, libs] : byDll)
+			if (!found.contains(dll))
+				missing.push_back(dll);
+		std::ranges::sort(missing, SimdScan::NameLess());
+		if (!missing.empty()) {
+			text += std::format(L"\nDLLs not found in the scan: {}\n", missing.size());
+			for (auto dll : missing)
+				text += std::format(L"  {}\n", dll);
+		}
+		return text;
+	}
+
+	//
+	// imports no call/jmp goes through, per module
+	//
+	struct ImportUsage {
+		struct Module {
+			std::wstring Path;
+			size_t Imports;
+			std::vector<std::wstring> Unreferenced;		// "module!function"
+			std::vector<std::wstring> UnreferencedModules;	// no function of the module is referenced
+		};
+
+		void Merge(ImportUsage const& other) {
+			Modules.insert(Modules.end(), other.Modules.begin(), other.Modules.end());
+		}
+
+		std::vector<Module> Modules;
+	};
+
+	//
+	// imports the code never calls: whole modules are delay-load or removal candidates.
+	// Imports whose address is only taken (mov/lea) count as unreferenced too.
+	//
+	std::wstring UsageReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const&) {
+		auto result = scanner.Scan<ImportUsage>(files, [](ImportUsage& state, PEFile const& pe) {
+			auto imports = pe->GetImport();
+			if (imports == nullptr || !pe->GetFileInfo()->HasImportUsage)
+				return;
+
+			ImportUsage::Module m{ pe.GetPath(), 0 };
+			for (auto& lib : *imports) {
+				std::wstring name = (PCWSTR)CString(lib.ModuleName.c_str());
+				size_t unreferenced = 0;
+				for (auto& func : lib.ImportFunc) {
+					if (func.References)
+						continue;
+					unreferenced++;
+					m.Unreferenced.push_back(name + L"!" + (func.FuncName.empty()
+						? std::format(L"#{}", func.unThunk.Thunk32.u1.Ordinal & 0xffff) : (PCWSTR)CString(func.FuncName.c_str())));
+				}
+				if (unreferenced && unreferenced == lib.ImportFunc.size())
+					m.UnreferencedModules.push_back(std::move(name));
+				m.Imports += lib.ImportFunc.size();
+			}
+			if (!m.Unreferenced.empty())
+				state.Modules.push_back(std::move(m));
+			});
+
+		std::ranges::sort(result.Modules, [](auto& m1, auto& m2) { return SimdScan::CompareNoCase(m1.Path, m2.Path) < 0; });
+		size_t functions = 0, modules = 0;
+		for (auto& m : result.Modules) {
+			functions += m.Unreferenced.size();
+			modules += m.UnreferencedModules.size();
+		}
+
+		std::wstring text = std::format(L"Modules with unreferenced imports: {}, unreferenced functions: {}, unreferenced modules: {}\n",
+			result.Modules.size(), functions, modules);
+		for (auto& m : result.Modules) {
+			text += std::format(L"\n{}\n  {} of {} imports unreferenced\n", m.Path, m.Unreferenced.size(), m.Imports);
+			for (auto& name : m.UnreferencedModules)
+				text += std::format(L"  module: {}\n", name);
+			for (auto& name : m.Unreferenced)
+				text += std::format(L"    {}\n", name);
+		}
+		return text;
+	}
+
+	//
+	// modules that look packed, with the signs that gave them away
+	//
+	struct PackedModules {
+		struct Module {
+			std::wstring Path;
+			std::wstring Packer;
+			std::wstring Reasons;
+		};
+
+		void Merge(PackedModules const& other) {
+			Modules.insert(Modules.end(), other.Modules.begin(), other.Modules.end());
+			Scanned += other.Scanned;
+		}
+
+		std::vector<Module> Modules;
+		size_t Scanned{ 0 };
+	};
+
+	std::wstring PackingReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const&) {
+		auto result = scanner.Scan<PackedModules>(files, [](PackedModules& state, PEFile const& pe) {
+			state.Scanned++;
+			auto packing = ModulePacking::FromPE(pe);
+			if (packing.LikelyPacked)
+				state.Modules.push_back({ pe.GetPath(), packing.Packer, packing.GetReasons() });
+			});
+
+		std::ranges::sort(result.Modules, [](auto& m1, auto& m2) { return SimdScan::CompareNoCase(m1.Path, m2.Path) < 0; });
+		std::map<std::wstring, size_t> packers;
+		for (auto& m : result.Modules)
+			packers[m.Packer.empty() ? L"(unknown)" : m.Packer]++;
+
+		std::wstring text = std::format(L"Likely packed: {} of {} modules\n", result.Modules.size(), result.Scanned);
+		for (auto& [packer, count] : packers)
+			text += std::format(L"  {:<20} {:>8}\n", packer, count);
+		text += L"\n";
+		for (auto& m : result.Modules)
+			text += std::format(L"{}\n  {}\n", m.Path, m.Reasons);
+		return text;
+	}
+
+	//
+	// ELF programs and libraries loaded with their closures the way ld.so would, under /sysroot or the
+	// root guessed from the scanned path: libraries, symbols and versions that don't resolve.
+	// Libraries are loaded on their own, so symbols a plugin expects from its host show up as missing.
+	// One loader serves the whole scan, every library is parsed once.
+	//
+	std::wstring ElfReport(BatchScanner&, std::vector<std::wstring> const& files, Arguments const& args) {
+		ElfLoader::Options options;
+		options.SysRoot = args.SysRoot.empty() ? ElfLoader::GuessSysRoot(args.Path) : args.SysRoot;
+		ElfLoader loader(options);
+
+		size_t loaded = 0, failing = 0, problems = 0;
+		std::wstring details;
+		for (auto& file : files) {
+			if (!ElfFile::IsElf(file) || !loader.Load(file))
+				continue;
+			loaded++;
+			if (loader.GetProblems().empty())
+				continue;
+
+			failing++;
+			auto& modules = loader.GetModules();
+			details += std::format(L"\n{}\n  {} modules, {} problem(s)\n", file, modules.size(), loader.GetProblems().size());
+			for (auto& p : loader.GetProblems()) {
+				std::wstring name = (PCWSTR)CA2W(p.Name.c_str(), CP_UTF8);
+				if (!p.Version.empty())
+					name += L"@" + std::wstring(CA2W(p.Version.c_str(), CP_UTF8));
+				details += std::format(L"  {:<16} {} ({})\n", ElfLoader::ProblemKindToString(p.Kind), name, (PCWSTR)CA2W(modules[p.Module].Name.c_str(), CP_UTF8));
+				problems++;
+			}
+		}
+
+		return std::format(L"System root: {}\nELF files: {}, with problems: {}, problems: {}, files parsed: {}\n",
+			options.SysRoot, loaded, failing, problems, loader.GetParsedCount()) + details;
+	}
+
+	//
+	// modules, edges, imports and exports of the whole scan into the SQLite database given with /db
+	//
+	std::wstring SqliteReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const& args) {
+		if (args.Database.empty())
+			return L"No database given (/db)\n";
+
+		ScanDatabase db;
+		if (!db.Create(args.Database))
+			return std::format(L"{}: {}\n", args.Database, db.GetError());
+
+		//
+		// workers write their modules straight away, the state only counts the failures
+		//
+		struct Failures {
+			void Merge(Failures const& other) {
+				Count += other.Count;
+			}
+
+			size_t Count{ 0 };
+		};
+		auto start = ::GetTickCount64();
+		auto failures = scanner.Scan<Failures>(files, [&](Failures& state, PEFile const& pe) {
+			if (!db.Add(pe))
+				state.Count++;
+			});
+		auto loaded = ::GetTickCount64() - start;
+
+		SYSTEMTIME now;
+		::GetLocalTime(&now);
+		db.SetMetadata("scan_path", args.Path);
+		db.SetMetadata("scan_time", std::format(L"{:04}-{:02}-{:02} {:02}:{:02}:{:02}", now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond));
+		db.SetMetadata("files", std::to_wstring(files.size()));
+		db.SetMetadata("not_loaded", std::to_wstring(scanner.GetFailedCount()));
+		db.SetMetadata("over_budget", std::to_wstring(scanner.GetOverBudget().size()));
+		start = ::GetTickCount64();
+		if (!db.Finish() || failures.Count)
+			return std::format(L"{}: {}\n", args.Database, db.GetError());
+
+		return std::format(L"Database: {}\nModules: {}, rows: {}, load: {} msec, indexes: {} msec\n",
+			args.Database, db.GetModuleCount(), db.GetRowCount(), loaded, ::GetTickCount64() - start);
+	}
+
+	//
+	// modules of the scan and the modules they import
+	//
+	struct ImportGraph {
+		struct Module {
+			std::wstring Name;
+			std::vector<std::wstring> Imports;
+		};
+
+		void Merge(ImportGraph const& other) {
+			Modules.insert(Modules.end(), other.Modules.begin(), other.Modules.end());
+		}
+
+		static ImportGraph Scan(BatchScanner& scanner, std::vector<std::wstring> const& files) {
+			return scanner.Scan<ImportGraph>(files, [](ImportGraph& state, PEFile const& pe) {
+				auto& path = pe.GetPath();
+				auto slash = path.find_last_of(L"\\/|");
+				Module m{ slash == std::wstring::npos ? path : path.substr(slash + 1) };
+				if (auto imports = pe->GetImport(); imports)
+					for (auto& lib : *imports)
+						m.Imports.emplace_back((PCWSTR)CString(lib.ModuleName.c_str()));
+				state.Modules.push_back(std::move(m));
+				});
+		}
+
+		std::vector<Module> Modules;
+	};
+
+	//
+	// the import graph of the scan as DOT or GEXF (/graph file). Modules that weren't scanned but are in
+	// the system directory are grouped as "System", api sets as "API sets".
+	//
+	std::wstring GraphReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const& args) {
+		if (args.Graph.empty())
+			return L"No graph file given (/graph)\n";
+
+		auto result = ImportGraph::Scan(scanner, files);
+
+		GraphExport graph;
+		std::vector<uint32_t> nodes;
+		nodes.reserve(result.Modules.size());
+		for (auto& m : result.Modules)
+			nodes.push_back(graph.AddNode(m.Name));
+
+		WCHAR systemDir[MAX_PATH];
+		::GetSystemDirectory(systemDir, _countof(systemDir));
+		std::unordered_map<std::wstring, uint32_t, SimdScan::NameHash, SimdScan::NameEquals> imported;
+		for (size_t i = 0; i < result.Modules.size(); i++) {
+			for (auto& name : result.Modules[i].Imports) {
+				auto it = imported.find(name);
+				if (it == imported.end()) {
+					auto group = SimdScan::IsApiSetName(name) ? L"API sets"
+						: ::GetFileAttributes(std::format(L"{}\\{}", systemDir, name).c_str()) != INVALID_FILE_ATTRIBUTES ? L"System" : L"";
+					it = imported.insert({ name, graph.AddNode(name, group) }).first;
+				}
+				graph.AddEdge(nodes[i], it->second);
+			}
+		}
+
+		auto options = args.GraphOptions;
+		options.Type = GraphExport::FormatFromPath(args.Graph);
+		auto start = ::GetTickCount64();
+		if (!graph.Write(options, args.Graph))
+			return std::format(L"Failed to write {}\n", args.Graph);
+
+		return std::format(L"Graph: {}\nNodes: {}, edges: {}, written in {} msec\n",
+			args.Graph, graph.GetNodeCount(), graph.GetEdgeCount(), ::GetTickCount64() - start);
+	}
+
+	//
+	// import chains from /root to /module over the modules of the scan, matched by file name
+	//
+	std::wstring WhyReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const& args) {
+		if (args.Root.empty() || args.Module.empty())
+			return L"No root (/root) or module (/module) given\n";
+
+		auto result = ImportGraph::Scan(scanner, files);
+
+		//
+		// scanned modules by name, the first one found wins; imported names that weren't scanned are leaves
+		//
+		std::unordered_map<std::wstring_view, uint32_t, SimdScan::NameHash, SimdScan::NameEquals> index;
+		std::vector<std::wstring_view> names;
+		auto getIndex = [&](std::wstring_view name) {
+			auto [it, inserted] = index.insert({ name, (uint32_t)names.size() });
+			if (inserted)
+				names.push_back(name);
+			return it->second;
+		};
+		std::vector<ImportGraph::Module const*> scanned;
+		for (auto& m : result.Modules)
+			if (getIndex(m.Name) == scanned.size())
+				scanned.push_back(&m);
+
+		auto root = index.find(args.Root);
+		if (root == index.end())
+			return std::format(L"{} not found in the scan\n", args.Root);
+
+		std::vector<std::vector<uint32_t>> edges(scanned.size());
+		for (size_t i = 0; i < scanned.size(); i++)
+			for (auto& name : scanned[i]->Imports)
+				edges[i].push_back(getIndex(name));
+		auto target = getIndex(args.Module);
+		edges.resize(names.size());
+
+		PathQuery query(std::move(edges), root->second);
+		return Reports::WhyLoaded(query, names, target, (std::max)(args.MaxPaths, 1u));
+	}
+
+	//
+	// the exported names of the scan in a front coded index: its size against the plain names and the lookup
+	// time. /index saves it and the lookups then run on the copy read back; /function lists the modules
+	// exporting names that start with the prefix.
+	//
+	std::wstring ExportsReport(BatchScanner& scanner, std::vector<std::wstring> const& files, Arguments const& args) {
+		auto builder = scanner.Scan<ExportIndex::Builder>(files, [](ExportIndex::Builder& b, PEFile const& pe) {
+			if (auto exports = pe->GetExport(); exports)
+				b.Add(pe.GetPath(), *exports);
+			});
+		auto index = builder.Build();
+		if (index.GetNameCount() == 0)
+			return L"No exported names\n";
+
+		std::wstring text;
+		if (!args.Index.empty()) {
+			if (!index.Save(args.Index) || !index.Load(args.Index))
+				return std::format(L"Failed to write {}\n", args.Index);
+			text = std::format(L"Index: {}\n", args.Index);
+		}
+
+		std::vector<std::string> names;
+		uint64_t distinctBytes = 0;
+		index.ForEachPrefix("", [&](auto name, auto) {
+			distinctBytes += name.size();
+			if (names.size() < 100000)
+				names.emplace_back(name);
+			return true;
+			});
+
+		using Clock = std::chrono::steady_clock;
+		size_t found = 0;
+		auto start = Clock::now();
+		for (auto& name : names)
+			found += !index.Find(name).empty();
+		auto lookup = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / names.size();
+
+		text += std::format(L"Modules with exports: {}, exported names: {}, distinct: {}\n"
+			L"Name bytes: {} in all, {} distinct; index: {} bytes ({:.1f}x smaller than all names)\n"
+			L"Lookup: {:.0f} ns per name ({} of {} found)\n",
+			index.GetModuleCount(), index.GetExportCount(), index.GetNameCount(),
+			builder.NameBytes, distinctBytes, index.GetSize(), (double)builder.NameBytes / index.GetSize(),
+			lookup, found, names.size());
+
+		if (!args.Function.empty()) {
+			auto prefix = CW2A(args.Function.c_str(), CP_UTF8);
+			size_t count = 0;
+			text += std::format(L"\nNames starting with {}:\n", args.Function);
+			index.ForEachPrefix((PCSTR)prefix, [&](auto name, auto modules) {
+				text += std::format(L"  {}\n", (PCWSTR)CA2W(std::string(name).c_str(), CP_UTF8));
+				for (auto m : modules)
+					text += std::format(L"    {}\n", index.GetModule(m));
+				return ++count < 100;
+				});
+			if (count == 0)
+				text += L"  none\n";
+		}
+		return text;
+	}
+
+	const struct {
+		PCWSTR Name;
+		ReportFunction Function;
+		bool NeedsImports;
+		bool NeedsExports;
+		bool NeedsUsage;
+		bool AnyExtension;		// the files aren't PE, every file under the path is handed over
+	} Reports[] = {
+		{ L"toolchain", ToolchainReport, false, false, false, false },
+		{ L"names", NamesReport, true, false, false, false },
+		{ L"packages", PackagesReport, true, false, false, false },
+		{ L"implib", ImportLibraryReport, false, true, false, false },
+		{ L"usage", UsageReport, true, false, true, false },
+		{ L"packing", PackingReport, true, false, false, false },
+		{ L"elf", ElfReport, false, false, false, true },
+		{ L"sqlite", SqliteReport, true, true, false, false },
+		{ L"graph", GraphReport, true, false, false, false },
+		{ L"why", WhyReport, true, false, false, false },
+		{ L"exports", ExportsReport, false, true, false, false },
+	};
+
+	std::vector<std::wstring> GetArgs(PCWSTR cmdLine) {
+		int count = 0;
+		auto argv = ::CommandLineToArgvW(cmdLine, &count);
+		if (argv == nullptr)
+			return {};
+
+		std::vector<std::wstring> args(argv + 1, argv + count);
+		::LocalFree(argv);
+		return args;
+	}
+
+	bool IsSwitch(std::wstring const& arg, PCWSTR name) {
+		return arg.size() > 1 && (arg[0] == L'/' || arg[0] == L'-') && _wcsicmp(arg.c_str() + 1, name) == 0;
+	}
+
+	bool ParseArguments(std::vector<std::wstring> const& args, Arguments& result, std::wstring& error) {
+		for (size_t i = 0; i < args.size(); i++) {
+			auto& arg = args[i];
+			auto value = [&]() -> std::wstring const* {
+				return i + 1 < args.size() ? &args[++i] : nullptr;
+			};
+
+			std::wstring const* v = nullptr;
+			if (IsSwitch(arg, L"norecurse"))
+				result.Options.Recurse = false;
+			else if (IsSwitch(arg, L"nopackages"))
+				result.Options.Packages = false;
+			else if (IsSwitch(arg, L"nocondense"))
+				result.GraphOptions.CondenseCycles = false;
+			else if (IsSwitch(arg, L"nogroups"))
+				result.GraphOptions.CollapseGroups = false;
+			else if (IsSwitch(arg, L"scan") || IsSwitch(arg, L"report") || IsSwitch(arg, L"out") || IsSwitch(arg, L"threads") || IsSwitch(arg, L"libs") || IsSwitch(arg, L"sysroot") || IsSwitch(arg, L"db")
+				|| IsSwitch(arg, L"graph") || IsSwitch(arg, L"depth") || IsSwitch(arg, L"fanin")
+				|| IsSwitch(arg, L"root") || IsSwitch(arg, L"module") || IsSwitch(arg, L"paths") || IsSwitch(arg, L"index") || IsSwitch(arg, L"function")
+				|| IsSwitch(arg, L"cputime") || IsSwitch(arg, L"maxalloc")) {
+				if ((v = value()) == nullptr) {
+					error = std::format(L"Missing value for {}", arg);
+					return false;
+				}
+				if (IsSwitch(arg, L"scan"))
+					result.Path = *v;
+				else if (IsSwitch(arg, L"report"))
+					result.Report = *v;
+				else if (IsSwitch(arg, L"out"))
+					result.Output = *v;
+				else if (IsSwitch(arg, L"libs"))
+					result.Libraries = *v;
+				else if (IsSwitch(arg, L"sysroot"))
+					result.SysRoot = *v;
+				else if (IsSwitch(arg, L"db"))
+					result.Database = *v;
+				else if (IsSwitch(arg, L"graph"))
+					result.Graph = *v;
+				else if (IsSwitch(arg, L"depth"))
+					result.GraphOptions.MaxDepth = (uint32_t)_wtoi(v->c_str());
+				else if (IsSwitch(arg, L"fanin"))
+					result.GraphOptions.MinFanIn = (uint32_t)_wtoi(v->c_str());
+				else if (IsSwitch(arg, L"root"))
+					result.Root = *v;
+				else if (IsSwitch(arg, L"module"))
+					result.Module = *v;
+				else if (IsSwitch(arg, L"paths"))
+					result.MaxPaths = (uint32_t)_wtoi(v->c_str());
+				else if (IsSwitch(arg, L"index"))
+					result.Index = *v;
+				else if (IsSwitch(arg, L"function"))
+					result.Function = *v;
+				else if (IsSwitch(arg, L"cputime"))
+					result.Options.MaxFileCpuTime = (uint32_t)_wtoi(v->c_str());
+				else if (IsSwitch(arg, L"maxalloc"))
+					result.Options.ParseOptions.ullMaxAlloc = (ULONGLONG)_wtoi(v->c_str()) << 20;
+				else
+					result.Options.Threads = (uint32_t)_wtoi(v->c_str());
+			}
+			else {
+				error = std::format(L"Unknown argument: {}", arg);
+				return false;
+			}
+		}
+		if (result.Path.empty()) {
+			error = L"Nothing to scan";
+			return false;
+		}
+		return true;
+	}
+
+	bool WriteOutput(std::wstring const& path, std::wstring const& text) {
+		auto count = ::WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), nullptr, 0, nullptr, nullptr);
+		std::string utf8(count, '\0');
+		::WideCharToMultiByte(CP_UTF8, 0, text.c_str(), (int)text.size(), utf8.data(), count, nullptr, nullptr);
+
+		DWORD written;
+		if (!path.empty()) {
+			auto hFile = ::CreateFile(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, 0, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE)
+				return false;
+			auto ok = ::WriteFile(hFile, utf8.data(), (DWORD)utf8.size(), &written, nullptr);
+			::CloseHandle(hFile);
+			return ok;
+		}
+
+		//
+		// GUI subsystem: borrow the console of the shell we were started from, or its redirected stdout
+		//
+		::AttachConsole(ATTACH_PARENT_PROCESS);
+		auto hOut = ::GetStdHandle(STD_OUTPUT_HANDLE);
+		if (hOut == nullptr || hOut == INVALID_HANDLE_VALUE)
+			return false;
+
+		DWORD mode;
+		if (::GetConsoleMode(hOut, &mode))
+			return ::WriteConsole(hOut, text.c_str(), (DWORD)text.size(), &written, nullptr);
+		return ::WriteFile(hOut, utf8.data(), (DWORD)utf8.size(), &written, nullptr);
+	}
+}
+
+bool BatchMode::IsBatchCommandLine(PCWSTR cmdLine) {
+	for (auto& arg : GetArgs(cmdLine))
+		if (IsSwitch(arg, L"scan"))
+			return true;
+	return false;
+}
+
+int BatchMode::Run(PCWSTR cmdLine) {
+	Arguments args;
+	std::wstring error;
+	if (!ParseArguments(GetArgs(cmdLine), args, error)) {
+		WriteOutput(L"", error + L"\nUsage: DepWalk.exe /scan <dir|file> [/report toolchain|names|packages|implib|usage|packing|elf|sqlite|graph|why|exports] [/libs <dir|file>] [/sysroot <dir>] [/db file] [/graph file [/depth n] [/fanin n] [/nocondense] [/nogroups]] [/root name /module name [/paths n]] [/index file] [/function prefix] [/threads n] [/cputime msec] [/maxalloc mb] [/norecurse] [/nopackages] [/out file]\n");
+		return 1;
+	}
+
+	auto report = std::ranges::find_if(Reports, [&](auto& r) { return _wcsicmp(r.Name, args.Report.c_str()) == 0; });
+	if (report == std::end(Reports)) {
+		WriteOutput(L"", std::format(L"Unknown report: {}\n", args.Report));
+		return 1;
+	}
+
+	//
+	// corpus reports keep only the tables they look at
+	//
+	args.Options.ParseOptions.fStoreImports = report->NeedsImports;
+	args.Options.ParseOptions.fStoreExports = report->NeedsExports;
+	args.Options.ParseOptions.fScanImportUsage = report->NeedsUsage;
+	args.Options.ParseOptions.dwUsageThreads = 1;		// the files are spread over the threads already
+	args.Options.ParseOptions.fScanEmbedded = false;
+
+	BatchScanner scanner(args.Options);
+	auto files = report->AnyExtension ? scanner.EnumerateFiles(args.Path, [](auto) { return true; }) : scanner.EnumerateFiles(args.Path);
+	auto start = ::GetTickCount64();
+	auto text = report->Function(scanner, files, args);
+	auto elapsed = ::GetTickCount64() - start;
+
+	//
+	// files cut short are part of the report with what was parsed, they're named so their rows can be told apart
+	//
+	auto overBudget = scanner.GetOverBudget();
+	if (!overBudget.empty()) {
+		text += std::format(L"\nBudget exceeded, partial results ({}):\n", overBudget.size());
+		for (auto& path : overBudget)
+			text += std::format(L"  {}\n", path);
+	}
+	text = std::format(L"{}: {} files, {} not loaded, {} over budget, {} msec\n\n", args.Path, files.size(), scanner.GetFailedCount(), overBudget.size(), elapsed) + text;
+	return WriteOutput(args.Output, text) ? 0 : 2;
+}
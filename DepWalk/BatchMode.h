@@ -0,0 +1,20 @@
+#pragma once
+
+//
+// command line corpus scans, no UI:
+// DepWalk.exe /scan <dir|file> [/report toolchain|names|packages|implib|usage|packing|elf|sqlite|graph|why|exports] [/libs <dir|file>] [/sysroot <dir>] [/db file] [/graph file [/depth n] [/fanin n] [/nocondense] [/nogroups]] [/root name /module name [/paths n]] [/index file] [/function prefix] [/threads n] [/cputime msec] [/maxalloc mb] [/norecurse] [/nopackages] [/out file]
+// packages (.zip, .nupkg, .vsix, .appx, .msix) are scanned in memory unless /nopackages is given
+// the implib report checks the DLLs found against the import libraries (.lib) under /libs
+// the elf report loads the ELF closures of the files found against the Linux file system copy under /sysroot
+// the sqlite report writes modules, edges, imports and exports into a SQLite database (/db) for SQL queries
+// the graph report writes the import graph as DOT, or GEXF for .gexf files; cycles are condensed and system DLLs collapsed unless /nocondense, /nogroups
+// the why report lists the import chains from the /root module to /module among the scanned modules, shortest first
+// the exports report indexes the exported names of the scan, saves the index to /index and lists the exporters of /function names
+// a file gets /cputime msec of CPU time (10000) and /maxalloc MB for its tables (512), 0 for no limit; past either it's
+// reported with what was parsed so far and listed as over budget
+// cmdLine is the full command line (GetCommandLine), program name included
+//
+namespace BatchMode {
+	bool IsBatchCommandLine(PCWSTR cmdLine);
+	int Run(PCWSTR cmdLine);
+}
@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "resource.h"
 #include "MainFrm.h"
+#include "BatchMode.h"
 #include <ThemeHelper.h>
 
 CAppModule _Module;
@@ -31,6 +32,12 @@ int WINAPI _tWinMain(HINSTANCE hInstance, HINSTANCE /*hPrevInstance*/, LPTSTR lp
 	HRESULT hRes = ::CoInitialize(NULL);
 	ATLASSERT(SUCCEEDED(hRes));
 
+	if (BatchMode::IsBatchCommandLine(::GetCommandLine())) {
+		int nRet = BatchMode::Run(::GetCommandLine());
+		::CoUninitialize();
+		return nRet;
+	}
+
 	AtlInitCommonControls(ICC_COOL_CLASSES | ICC_BAR_CLASSES | ICC_LISTVIEW_CLASSES);
 
 	hRes = _Module.Init(NULL, hInstance);
@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "DependencyGraph.h"
+#include "resource.h"
+#include "View.h"
+#include <GraphExport.h>
+#include <PathQuery.h>
+#include <unordered_set>
+
+std::vector<ModuleInfo const*> DependencyGraph::InitOrder(ModuleInfo const* root) {
+	std::vector<ModuleInfo const*> order;
+	if (root == nullptr)
+		return order;
+
+	//
+	// iterative post-order DFS; a module is emitted once all of its imports are
+	//
+	std::unordered_set<ModuleInfo const*> visited{ root };
+	std::vector<std::pair<ModuleInfo const*, size_t>> stack{ { root, 0 } };
+	while (!stack.empty()) {
+		auto& [m, next] = stack.back();
+		if (next < m->Dependencies.size()) {
+			auto dep = m->Dependencies[next++];
+			if (visited.insert(dep).second)
+				stack.push_back({ dep, 0 });
+			continue;
+		}
+		if (!m->IsApiSet && m->PE && m->PE->IsLoaded())
+			order.push_back(m);
+		stack.pop_back();
+	}
+	return order;
+}
+
+void DependencyGraph::Export(ModuleInfo const* root, GraphExport& graph) {
+	if (root == nullptr)
+		return;
+
+	WCHAR windowsDir[MAX_PATH];
+	auto chars = ::GetWindowsDirectory(windowsDir, _countof(windowsDir));
+	std::wstring_view windows(windowsDir, chars);
+	auto addNode = [&](ModuleInfo const* m) {
+		auto inWindows = chars && m->FullPath.size() > windows.size() && m->FullPath[windows.size()] == L'\\'
+			&& SimdScan::EqualsNoCase(std::wstring_view(m->FullPath).substr(0, windows.size()), windows);
+		return graph.AddNode(m->Name, m->IsApiSet ? L"API sets" : inWindows ? L"System" : L"", m == root);
+	};
+
+	std::unordered_set<ModuleInfo const*> visited{ root };
+	std::vector<ModuleInfo const*> stack{ root };
+	while (!stack.empty()) {
+		auto m = stack.back();
+		stack.pop_back();
+		auto from = addNode(m);
+		for (auto dep : m->Dependencies) {
+			graph.AddEdge(from, addNode(dep));
+			if (visited.insert(dep).second)
+				stack.push_back(dep);
+		}
+	}
+}
+
+PathQuery DependencyGraph::BuildPathQuery(ModuleInfo const* root, std::vector<ModuleInfo const*>& modules) {
+	modules.clear();
+	std::vector<std::vector<uint32_t>> edges;
+	if (root == nullptr)
+		return PathQuery(std::move(edges), 0);
+
+	//
+	// numbered in breadth first order; edges keep the import table order
+	//
+	std::unordered_map<ModuleInfo const*, uint32_t> index{ { root, 0 } };
+	modules.push_back(root);
+	for (size_t i = 0; i < modules.size(); i++) {
+		std::vector<uint32_t> targets;
+		targets.reserve(modules[i]->Dependencies.size());
+		for (auto dep : modules[i]->Dependencies) {
+			auto [it, inserted] = index.insert({ dep, (uint32_t)modules.size() });
+			if (inserted)
+				modules.push_back(dep);
+			targets.push_back(it->second);
+		}
+		edges.push_back(std::move(targets));
+	}
+	return PathQuery(std::move(edges), 0);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+struct ModuleInfo;
+class GraphExport;
+class PathQuery;
+
+//
+// queries over the import graph built by CView::ParsePE (ModuleInfo::Dependencies)
+//
+namespace DependencyGraph {
+	//
+	// modules in the order the loader initializes them: dependencies before their importers,
+	// the root last. Api sets and modules that could not be resolved are skipped.
+	//
+	std::vector<ModuleInfo const*> InitOrder(ModuleInfo const* root);
+
+	//
+	// the closure of root as nodes and import edges; Windows directory modules are grouped as "System", api sets as "API sets"
+	//
+	void Export(ModuleInfo const* root, GraphExport& graph);
+
+	//
+	// the closure of root numbered for path queries: modules[i] is node i, the root node 0
+	//
+	PathQuery BuildPathQuery(ModuleInfo const* root, std::vector<ModuleInfo const*>& modules);
+}
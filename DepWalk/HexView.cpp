@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "resource.h"
+#include "HexView.h"
+
+bool CHexView::Open(std::wstring const& path) {
+	if (!m_PE.Open(path))
+		return false;
+
+	m_Map = StructureMap::Build(m_PE);
+	return true;
+}
+
+CString CHexView::GetColumnText(HWND h, int row, int col) const {
+	auto offset = (uint32_t)row * BytesPerRow;
+	auto bytes = GetRow(row);
+	CString text;
+	switch (GetColumnManager(h)->GetColumnTag<ColumnType>(col)) {
+		case ColumnType::Offset:
+			text.Format(L"%08X", offset);
+			break;
+
+		case ColumnType::Hex:
+			for (size_t i = 0; i < bytes.size(); i++)
+				text.AppendFormat(i == BytesPerRow / 2 ? L"  %02X" : i ? L" %02X" : L"%02X", (BYTE)bytes[i]);
+			break;
+
+		case ColumnType::Text:
+			for (auto b : bytes)
+				text += (BYTE)b >= 0x20 && (BYTE)b < 0x7f ? (WCHAR)b : L'.';
+			break;
+
+		case ColumnType::Structure:
+		{
+			//
+			// what the row starts in, and the first structure starting inside it
+			//
+			auto range = m_Map.Find(offset);
+			text = m_Map.GetPath(range).c_str();
+			if (auto next = m_Map.FindStart(offset, offset + (uint32_t)bytes.size()); next != StructureMap::NoRange)
+				text.AppendFormat(L"%s+%X: %s", text.IsEmpty() ? L"" : L"; ", m_Map.GetRanges()[next].Offset - offset,
+					m_Map.GetRanges()[next].Name.c_str());
+			break;
+		}
+	}
+	return text;
+}
+
+bool CHexView::IsSortable(HWND, int) const {
+	return false;
+}
+
+BOOL CHexView::PreTranslateMessage(MSG* pMsg) {
+	pMsg;
+	return FALSE;
+}
+
+std::span<const std::byte> CHexView::GetRow(int row) const {
+	auto offset = (uint32_t)row * BytesPerRow;
+	auto size = m_PE.GetFileSize();
+	return offset < size ? m_PE.GetSpan(offset, (std::min)(BytesPerRow, size - offset)) : std::span<const std::byte>();
+}
+
+LRESULT CHexView::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/) {
+	m_hWndClient = m_List.Create(m_hWnd, rcDefault, nullptr, WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS |
+		LVS_OWNERDATA | LVS_REPORT | LVS_SHOWSELALWAYS);
+	m_List.SetExtendedListViewStyle(LVS_EX_DOUBLEBUFFER | LVS_EX_INFOTIP | LVS_EX_FULLROWSELECT);
+	m_Font.CreatePointFont(100, L"Consolas");
+	m_List.SetFont(m_Font);
+
+	auto cm = GetColumnManager(m_List);
+	cm->AddColumn(L"Offset", LVCFMT_RIGHT, 80, ColumnType::Offset);
+	cm->AddColumn(L"Hex", LVCFMT_LEFT, 400, ColumnType::Hex);
+	cm->AddColumn(L"Text", LVCFMT_LEFT, 140, ColumnType::Text);
+	cm->AddColumn(L"Structure", LVCFMT_LEFT, 450, ColumnType::Structure);
+
+	m_List.SetItemCount((m_PE.GetFileSize() + BytesPerRow - 1) / BytesPerRow);
+
+	return 0;
+}
+
+LRESULT CHexView::OnSetFocus(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/) {
+	m_List.SetFocus();
+	return 0;
+}
+
+LRESULT CHexView::OnEditCopy(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	//
+	// the selected rows as they're shown
+	//
+	CString text;
+	for (int row = m_List.GetNextItem(-1, LVNI_SELECTED); row >= 0; row = m_List.GetNextItem(row, LVNI_SELECTED)) {
+		for (int col = 0; col < 4; col++)
+			text += GetColumnText(m_List, row, col) + (col < 3 ? L"  " : L"\r\n");
+	}
+	if (text.IsEmpty() || !::OpenClipboard(m_hWnd))
+		return 0;
+
+	::EmptyClipboard();
+	auto size = (text.GetLength() + 1) * sizeof(WCHAR);
+	if (auto hData = ::GlobalAlloc(GMEM_MOVEABLE, size); hData) {
+		memcpy(::GlobalLock(hData), text.GetString(), size);
+		::GlobalUnlock(hData);
+		if (!::SetClipboardData(CF_UNICODETEXT, hData))
+			::GlobalFree(hData);
+	}
+	::CloseClipboard();
+	return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Interfaces.h"
+#include <FrameView.h>
+#include <VirtualListView.h>
+#include <PEFile.h>
+#include <StructureMap.h>
+
+//
+// raw bytes of an image file, 16 to a row, each row named by the structures it falls in. The list is
+// virtual and the file stays mapped, so only the rows on screen are read and formatted; scrolling
+// costs the same anywhere in a file of any size.
+//
+class CHexView :
+	public CFrameView<CHexView, IMainFrame>,
+	public CVirtualListView<CHexView> {
+public:
+	using CFrameView::CFrameView;
+
+	//
+	// the view opens the file on its own, it doesn't depend on the module tree staying loaded
+	//
+	bool Open(std::wstring const& path);
+
+	CString GetColumnText(HWND h, int row, int col) const;
+	bool IsSortable(HWND h, int col) const;
+
+	BOOL PreTranslateMessage(MSG* pMsg);
+
+protected:
+	BEGIN_MSG_MAP(CHexView)
+		MESSAGE_HANDLER(WM_CREATE, OnCreate)
+		MESSAGE_HANDLER(WM_SETFOCUS, OnSetFocus)
+		COMMAND_ID_HANDLER(ID_EDIT_COPY, OnEditCopy)
+		CHAIN_MSG_MAP(BaseFrame)
+		CHAIN_MSG_MAP(CVirtualListView<CHexView>)
+	END_MSG_MAP()
+
+private:
+	enum class ColumnType {
+		Offset, Hex, Text, Structure,
+	};
+
+	static constexpr uint32_t BytesPerRow = 16;
+
+	LRESULT OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnSetFocus(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnEditCopy(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+
+	std::span<const std::byte> GetRow(int row) const;
+
+	CListViewCtrl m_List;
+	CFont m_Font;
+	PEFile m_PE;
+	StructureMap m_Map;
+};
@@ -1,4 +1,9 @@
 #pragma once
 
 struct IMainFrame abstract {
+	virtual void ShowReport(PCWSTR title, std::wstring text) = 0;
+	//
+	// raw bytes of an image file; false if it can't be opened as one
+	//
+	virtual bool ShowBytes(PCWSTR title, std::wstring const& path) = 0;
 };
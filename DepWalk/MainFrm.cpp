@@ -2,11 +2,13 @@
 #include "resource.h"
 #include "AboutDlg.h"
 #include "View.h"
+#include "ReportView.h"
+#include "HexView.h"
 #include "MainFrm.h"
 #include <ToolbarHelper.h>
 #include <thread>
 
-const int WINDOW_MENU_POSITION = 5;
+const int WINDOW_MENU_POSITION = 6;
 
 BOOL CMainFrame::PreTranslateMessage(MSG* pMsg) {
 	if (CFrameWindowImpl<CMainFrame>::PreTranslateMessage(pMsg))
@@ -104,7 +106,7 @@ LRESULT CMainFrame::OnFileExit(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCt
 
 LRESULT CMainFrame::OnFileOpen(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
 	CSimpleFileDialog dlg(TRUE, nullptr, nullptr, OFN_EXPLORER | OFN_ENABLESIZING,
-		L"PE Files\0*.exe;*.dll;*.ocx;*.efi\0All Files\0*.*\0", m_hWnd);
+		L"PE Files\0*.exe;*.dll;*.ocx;*.efi\0ELF Shared Objects\0*.so;*.so.*\0All Files\0*.*\0", m_hWnd);
 	ThemeHelper::Suspend();
 	auto ok = dlg.DoModal() == IDOK;
 	ThemeHelper::Resume();
@@ -176,3 +178,29 @@ LRESULT CMainFrame::OnWindowActivate(WORD /*wNotifyCode*/, WORD wID, HWND /*hWnd
 
 	return 0;
 }
+
+LRESULT CMainFrame::OnForwardToActivePage(WORD wNotifyCode, WORD wID, HWND hWndCtl, BOOL& /*bHandled*/) {
+	int page = m_view.GetActivePage();
+	if (page >= 0)
+		::SendMessage(m_view.GetPageHWND(page), WM_COMMAND, MAKEWPARAM(wID, wNotifyCode), (LPARAM)hWndCtl);
+
+	return 0;
+}
+
+void CMainFrame::ShowReport(PCWSTR title, std::wstring text) {
+	auto pView = new CReportView(this);
+	pView->Create(m_view, rcDefault, NULL, WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN, 0);
+	pView->SetText(std::move(text));
+	m_view.AddPage(pView->m_hWnd, title, -1, pView);
+}
+
+bool CMainFrame::ShowBytes(PCWSTR title, std::wstring const& path) {
+	auto pView = new CHexView(this);
+	if (!pView->Open(path)) {
+		delete pView;
+		return false;
+	}
+	pView->Create(m_view, rcDefault, NULL, WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN, 0);
+	m_view.AddPage(pView->m_hWnd, title, -1, pView);
+	return true;
+}
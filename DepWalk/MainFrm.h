@@ -21,6 +21,10 @@ public:
 	virtual BOOL PreTranslateMessage(MSG* pMsg);
 	virtual BOOL OnIdle();
 
+	// IMainFrame
+	void ShowReport(PCWSTR title, std::wstring text) override;
+	bool ShowBytes(PCWSTR title, std::wstring const& path) override;
+
 	BEGIN_MSG_MAP(CMainFrame)
 		COMMAND_ID_HANDLER(ID_APP_EXIT, OnFileExit)
 		COMMAND_ID_HANDLER(ID_FILE_OPEN, OnFileOpen)
@@ -31,6 +35,18 @@ public:
 		COMMAND_ID_HANDLER(ID_WINDOW_CLOSE, OnWindowClose)
 		COMMAND_ID_HANDLER(ID_WINDOW_CLOSE_ALL, OnWindowCloseAll)
 		COMMAND_RANGE_HANDLER(ID_WINDOW_TABFIRST, ID_WINDOW_TABLAST, OnWindowActivate)
+		COMMAND_ID_HANDLER(ID_EDIT_COPY, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_MITIGATIONS, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_SIGNATURES, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_TOOLCHAIN, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_STARTUP, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_BOUNDIMPORTS, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_EXPORTGRAPH, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_REPORTS_WHYLOADED, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_WHATIF_ADD, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_WHATIF_REMOVE, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_WHATIF_CLEAR, OnForwardToActivePage)
+		COMMAND_ID_HANDLER(ID_VIEW_RAWBYTES, OnForwardToActivePage)
 		MESSAGE_HANDLER(WM_CREATE, OnCreate)
 		MESSAGE_HANDLER(WM_DESTROY, OnDestroy)
 		CHAIN_MSG_MAP(CAutoUpdateUI<CMainFrame>)
@@ -57,6 +73,7 @@ private:
 	LRESULT OnWindowClose(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnWindowCloseAll(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 	LRESULT OnWindowActivate(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnForwardToActivePage(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 
 	CCustomTabView m_view;
 };
@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "resource.h"
+#include "ReportView.h"
+
+void CReportView::SetText(std::wstring text) {
+	//
+	// edit controls want CR/LF line breaks
+	//
+	std::wstring crlf;
+	crlf.reserve(text.size() + text.size() / 32);
+	for (auto ch : text) {
+		if (ch == L'\n')
+			crlf += L'\r';
+		crlf += ch;
+	}
+	m_Edit.SetWindowText(crlf.c_str());
+}
+
+BOOL CReportView::PreTranslateMessage(MSG* pMsg) {
+	pMsg;
+	return FALSE;
+}
+
+LRESULT CReportView::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/) {
+	m_hWndClient = m_Edit.Create(m_hWnd, rcDefault, nullptr, WS_CHILD | WS_VISIBLE | WS_VSCROLL | WS_HSCROLL |
+		ES_MULTILINE | ES_READONLY | ES_AUTOVSCROLL | ES_AUTOHSCROLL | ES_NOHIDESEL);
+	m_Edit.SetLimitText(0);
+	m_Font.CreatePointFont(100, L"Consolas");
+	m_Edit.SetFont(m_Font);
+
+	return 0;
+}
+
+LRESULT CReportView::OnSetFocus(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/) {
+	m_Edit.SetFocus();
+	return 0;
+}
+
+LRESULT CReportView::OnEditCopy(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	int start, end;
+	m_Edit.GetSel(start, end);
+	if (start == end)
+		m_Edit.SetSelAll();
+	m_Edit.Copy();
+	return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Interfaces.h"
+#include <FrameView.h>
+
+//
+// read-only text page hosting a generated report
+//
+class CReportView : public CFrameView<CReportView, IMainFrame> {
+public:
+	using CFrameView::CFrameView;
+
+	void SetText(std::wstring text);
+
+	BOOL PreTranslateMessage(MSG* pMsg);
+
+protected:
+	BEGIN_MSG_MAP(CReportView)
+		MESSAGE_HANDLER(WM_CREATE, OnCreate)
+		MESSAGE_HANDLER(WM_SETFOCUS, OnSetFocus)
+		COMMAND_ID_HANDLER(ID_EDIT_COPY, OnEditCopy)
+		CHAIN_MSG_MAP(BaseFrame)
+	END_MSG_MAP()
+
+private:
+	LRESULT OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnSetFocus(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnEditCopy(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+
+	CEdit m_Edit;
+	CFont m_Font;
+};
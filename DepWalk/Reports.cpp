@@ -0,0 +1,261 @@
+#include "pch.h"
+#include "resource.h"
+#include "Reports.h"
+#include "View.h"
+#include <PathQuery.h>
+#include "WhatIf.h"
+
+namespace {
+	std::vector<ModuleInfo const*> LoadedModules(std::vector<std::unique_ptr<ModuleInfo>> const& modules) {
+		std::vector<ModuleInfo const*> loaded;
+		loaded.reserve(modules.size());
+		for (auto& m : modules)
+			if (!m->IsApiSet && m->PE && m->PE->IsLoaded())
+				loaded.push_back(m.get());
+		std::ranges::sort(loaded, [](auto m1, auto m2) { return SimdScan::CompareNoCase(m1->Name, m2->Name) < 0; });
+		return loaded;
+	}
+
+	std::wstring Percent(size_t count, size_t total) {
+		return std::format(L"{}/{} ({:.1f}%)", count, total, total ? count * 100.0 / total : 0.0);
+	}
+}
+
+std::wstring Reports::Mitigations(std::vector<std::unique_ptr<ModuleInfo>> const& modules) {
+	auto loaded = LoadedModules(modules);
+
+	std::wstring text = std::format(L"{:<40} {:<5} {:<5} {:<5} {:<6} {:>10} {:>10} {:>10} {:>8}\n",
+		L"Module", L"CFG", L"XFG", L"CET", L"EHCont", L"CF Funcs", L"XFG Funcs", L"IAT Taken", L"DynRel");
+
+	size_t cfg = 0, xfg = 0, cet = 0, ehcont = 0;
+	uint64_t cfFuncs = 0, xfgFuncs = 0;
+	auto yesNo = [](bool b) { return b ? L"Yes" : L"-"; };
+	for (auto m : loaded) {
+		auto& mit = m->GetMitigations();
+		text += std::format(L"{:<40} {:<5} {:<5} {:<5} {:<6} {:>10} {:>10} {:>10} {:>8}\n",
+			m->Name, yesNo(mit.CFG), yesNo(mit.XFG), yesNo(mit.CET), yesNo(mit.EHCont),
+			mit.CFFunctions, mit.XFGFunctions, mit.AddressTakenIATEntries, mit.DynamicRelocations);
+		cfg += mit.CFG;
+		xfg += mit.XFG;
+		cet += mit.CET;
+		ehcont += mit.EHCont;
+		cfFuncs += mit.CFFunctions;
+		xfgFuncs += mit.XFGFunctions;
+	}
+
+	text += std::format(L"\nClosure coverage ({} modules)\n", loaded.size());
+	text += std::format(L"  CFG:    {}\n", Percent(cfg, loaded.size()));
+	text += std::format(L"  XFG:    {}\n", Percent(xfg, loaded.size()));
+	text += std::format(L"  CET:    {}\n", Percent(cet, loaded.size()));
+	text += std::format(L"  EHCont: {}\n", Percent(ehcont, loaded.size()));
+	text += std::format(L"  CF valid call targets: {}, XFG tagged: {}\n", cfFuncs, xfgFuncs);
+
+	return text;
+}
+
+std::wstring Reports::Signatures(std::vector<std::unique_ptr<ModuleInfo>> const& modules) {
+	auto loaded = LoadedModules(modules);
+
+	//
+	// unsigned modules first, they are the ones to look at
+	//
+	std::ranges::stable_partition(loaded, [](auto m) { return m->GetSigner() == nullptr; });
+
+	std::wstring text = std::format(L"{:<40} {:<8} {:<50} {}\n", L"Module", L"Digest", L"Signer", L"Issuer");
+	size_t notSigned = 0;
+	std::map<std::wstring, size_t> signers;
+	for (auto m : loaded) {
+		auto signer = m->GetSigner();
+		if (signer == nullptr) {
+			text += std::format(L"{:<40} {:<8} {:<50} {}\n", m->Name, L"-", L"(not signed)", m->FullPath);
+			notSigned++;
+			continue;
+		}
+		text += std::format(L"{:<40} {:<8} {:<50} {}\n", m->Name,
+			std::wstring(signer->DigestAlgorithm.begin(), signer->DigestAlgorithm.end()), signer->Subject, signer->Issuer);
+		signers[signer->Subject]++;
+	}
+
+	text += std::format(L"\nEmbedded signatures ({} modules)\n", loaded.size());
+	text += std::format(L"  Not signed: {}\n", Percent(notSigned, loaded.size()));
+	for (auto& [subject, count] : signers)
+		text += std::format(L"  {}: {}\n", subject.empty() ? L"(unknown signer)" : subject, count);
+	text += L"\nModules signed through a catalog show as not signed.\n";
+
+	return text;
+}
+
+std::wstring Reports::Toolchain(std::vector<std::unique_ptr<ModuleInfo>> const& modules) {
+	auto loaded = LoadedModules(modules);
+
+	auto release = [](WORD id, WORD build) -> std::wstring {
+		if (id == 0)
+			return L"-";
+		auto& rel = Toolchain::GetRelease(id, build);
+		return std::format(L"{} {}.{}", rel.VisualStudio, rel.Toolset, build);
+	};
+
+	std::wstring text = std::format(L"{:<40} {:<30} {:<30} {:>8} {:<5}\n", L"Module", L"Linker", L"Compiler", L"Objects", L"Mixed");
+	ToolchainHistogram histogram;
+	for (auto m : loaded) {
+		auto& tc = m->GetToolchain();
+		if (!tc.HasRichHeader)
+			text += std::format(L"{:<40} (no Rich header)\n", m->Name);
+		else
+			text += std::format(L"{:<40} {:<30} {:<30} {:>8} {:<5}\n", m->Name, release(tc.LinkerId, tc.LinkerBuild),
+				release(tc.CompilerId, tc.CompilerBuild), tc.Objects, tc.MixedCompilers ? L"Yes" : L"-");
+		histogram.Add(m->PE->GetRichHeader());
+	}
+
+	text += L"\nClosure toolchain\n";
+	text += histogram.ToString();
+	return text;
+}
+
+std::wstring Reports::Startup(std::vector<ModuleInfo const*> const& initOrder) {
+	std::wstring text = std::format(L"{:>4} {:<40} {:<4} {:>12} {:>6} {:>9} {:>9}\n",
+		L"#", L"Module", L"Type", L"Entry RVA", L"TLS", L"C++ Init", L"C Init");
+
+	size_t entries = 0, tls = 0, initializers = 0, unknown = 0, idle = 0;
+	int index = 0;
+	for (auto m : initOrder) {
+		index++;
+		auto& s = m->GetStartup();
+		if (!s.HasWork()) {
+			idle++;
+			continue;
+		}
+		auto count = [&](uint32_t n) { return s.InitializersKnown ? std::to_wstring(n) : std::wstring(L"?"); };
+		text += std::format(L"{:>4} {:<40} {:<4} {:>12} {:>6} {:>9} {:>9}\n", index, m->Name, s.IsDll ? L"DLL" : L"EXE",
+			s.EntryPoint ? std::format(L"0x{:X}", s.EntryPoint) : L"-", s.TLSCallbacks, count(s.CppInitializers), count(s.CInitializers));
+		entries += s.EntryPoint != 0;
+		tls += s.TLSCallbacks != 0;
+		initializers += s.CppInitializers + s.CInitializers;
+		unknown += !s.InitializersKnown;
+	}
+
+	text += std::format(L"\nLoad order: {} modules, {} without startup code\n", initOrder.size(), idle);
+	text += std::format(L"  Entry points (DllMain): {}\n", entries);
+	text += std::format(L"  Modules with TLS callbacks: {}\n", tls);
+	text += std::format(L"  CRT static initializers: {}\n", initializers);
+	if (unknown)
+		text += std::format(L"  {} modules have no POGO debug entry, their initializers are not visible (?)\n", unknown);
+
+	return text;
+}
+
+std::wstring Reports::BoundImports(std::vector<std::unique_ptr<ModuleInfo>> const& modules) {
+	auto loaded = LoadedModules(modules);
+
+	//
+	// bindings name the DLL by file name; the closure has each one loaded once
+	//
+	std::unordered_map<std::wstring_view, ModuleInfo const*, SimdScan::NameHash, SimdScan::NameEquals> byName;
+	for (auto m : loaded) {
+		std::wstring_view name = m->FullPath.empty() ? std::wstring_view(m->Name) : std::wstring_view(m->FullPath);
+		if (auto slash = name.find_last_of(L'\\'); slash != std::wstring_view::npos)
+			name = name.substr(slash + 1);
+		byName.insert({ name, m });
+	}
+
+	std::wstring text = std::format(L"{:<40} {:<40} {:>10} {:>10} {}\n", L"Module", L"Bound To", L"Bound", L"Actual", L"Status");
+
+	size_t bound = 0, bindings = 0, stale = 0, missing = 0;
+	auto check = [&](ModuleInfo const* m, std::string const& target, DWORD timeStamp, PCWSTR prefix) {
+		std::wstring name = (PCWSTR)CString(target.c_str());
+		PCWSTR status = L"OK";
+		std::wstring actual = L"-";
+		bindings++;
+		if (auto it = byName.find(name); it == byName.end()) {
+			status = L"Not loaded";
+			missing++;
+		}
+		else {
+			auto actualStamp = it->second->PE->GetNTHeader()->NTHdr32.FileHeader.TimeDateStamp;
+			actual = std::format(L"{:08X}", actualStamp);
+			if (actualStamp != timeStamp) {
+				status = L"Stale";
+				stale++;
+			}
+		}
+		text += std::format(L"{:<40} {:<40} {:>10} {:>10} {}\n", m->Name, prefix + name, std::format(L"{:08X}", timeStamp), actual, status);
+	};
+
+	for (auto m : loaded) {
+		auto imports = m->PE->GetBoundImport();
+		if (imports == nullptr || imports->empty())
+			continue;
+
+		bound++;
+		for (auto& imp : *imports) {
+			check(m, imp.BoundName, imp.BoundImpDesc.TimeDateStamp, L"");
+			for (auto& fwd : imp.BoundForwarder)
+				check(m, fwd.BoundForwarderName, fwd.BoundForwarder.TimeDateStamp, L"  -> ");
+		}
+	}
+
+	text += std::format(L"\nModules with bound imports: {}\n", Percent(bound, loaded.size()));
+	text += std::format(L"  Bindings: {}, stale: {}, target not loaded: {}\n", bindings, stale, missing);
+	if (stale)
+		text += L"  Stale bindings are redone by the loader at load time, binding again or dropping the bound import table saves that work\n";
+
+	return text;
+}
+
+std::wstring Reports::WhyLoaded(PathQuery const& query, std::vector<std::wstring_view> const& names, uint32_t target, size_t maxPaths) {
+	auto chain = [&](PathQuery::Path const& path) {
+		std::wstring text;
+		for (auto n : path)
+			text.append(text.empty() ? L"" : L" -> ").append(names[n]);
+		return text;
+	};
+
+	std::wstring text = std::format(L"Why is {} loaded?\n\n", names[target]);
+	auto shortest = query.ShortestPath(target);
+	if (shortest.empty())
+		return text + L"It isn't imported, directly or indirectly, by the root module\n";
+
+	text += std::format(L"Shortest chain ({} imports):\n  {}\n", shortest.size() - 1, chain(shortest));
+
+	//
+	// a few imports longer than the shortest is where the alternative routes are
+	//
+	constexpr uint32_t ExtraLength = 3;
+	auto paths = query.Paths(target, ExtraLength, maxPaths);
+	text += std::format(L"\nChains up to {} imports, shortest first ({}{}):\n",
+		shortest.size() - 1 + ExtraLength, paths.size(), paths.size() == maxPaths ? L", more not shown" : L"");
+	for (size_t i = 0; i < paths.size(); i++)
+		text += std::format(L"{:>4}. [{}] {}\n", i + 1, paths[i].size() - 1, chain(paths[i]));
+	return text;
+}
+
+std::wstring Reports::WhatIfClosure(WhatIf const& whatIf) {
+	std::wstring text = L"What if:\n";
+	for (auto& change : whatIf.GetChanges())
+		text += std::format(L"  {}\n", change);
+
+	auto result = whatIf.Evaluate();
+	text += std::format(L"\nModules in the closure: {} (now {})\n", result.ModuleCount, result.CurrentModuleCount);
+	auto list = [&](PCWSTR title, auto const& items, auto&& describe) {
+		if (items.empty())
+			return;
+		text += std::format(L"\n{} ({}):\n", title, items.size());
+		for (auto& item : items)
+			text += L"  " + describe(item) + L"\n";
+	};
+	auto path = [](ModuleInfo const* m) {
+		return m->FullPath.empty() ? m->Name : m->FullPath;
+	};
+
+	list(L"Replaced", result.Replaced, [&](auto& r) { return std::format(L"{} -> {}", path(r.first), path(r.second)); });
+	list(L"Added", result.Added, path);
+	list(L"No longer loaded", result.Dropped, path);
+	list(L"Imports left without a module", result.MissingModules, [](auto& m) { return std::format(L"{} imports {}", m.Importer->Name, m.Name); });
+	list(L"Imported functions the new DLLs don't export", result.MissingFunctions, [](auto& f) {
+		return std::format(L"{} imports {}!{}", f.Importer->Name, f.Module->Name, (PCWSTR)CString(f.Function.c_str()));
+		});
+	list(L"Imports of the new DLLs outside the closure (not followed)", result.Unresolved, [](auto& m) { return std::format(L"{} imports {}", m.Importer->Name, m.Name); });
+	if (result.Replaced.empty() && result.Added.empty() && result.Dropped.empty() && result.MissingModules.empty() && result.MissingFunctions.empty())
+		text += L"\nNo change to the closure\n";
+	return text;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+struct ModuleInfo;
+class PathQuery;
+class WhatIf;
+
+//
+// plain text reports over the modules of a dependency closure
+//
+namespace Reports {
+	std::wstring Mitigations(std::vector<std::unique_ptr<ModuleInfo>> const& modules);
+	std::wstring Signatures(std::vector<std::unique_ptr<ModuleInfo>> const& modules);
+	std::wstring Toolchain(std::vector<std::unique_ptr<ModuleInfo>> const& modules);
+	std::wstring Startup(std::vector<ModuleInfo const*> const& initOrder);
+	std::wstring BoundImports(std::vector<std::unique_ptr<ModuleInfo>> const& modules);
+	//
+	// import chains from the root to target; names[i] names node i of the query
+	//
+	std::wstring WhyLoaded(PathQuery const& query, std::vector<std::wstring_view> const& names, uint32_t target, size_t maxPaths = 20);
+	std::wstring WhatIfClosure(WhatIf const& whatIf);
+}
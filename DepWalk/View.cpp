@@ -5,7 +5,12 @@
 #include "pch.h"
 #include "resource.h"
 #include "View.h"
+#include "Reports.h"
+#include "DependencyGraph.h"
 #include <SortHelper.h>
+#include <ThemeHelper.h>
+#include <GraphExport.h>
+#include <OrdinalNames.h>
 #include <DbgHelp.h>
 
 #pragma comment(lib, "dbghelp")
@@ -21,6 +26,9 @@ LRESULT CView::OnSetFocus(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, B
 }
 
 bool CView::ParseModules(PCWSTR path) {
+	if (ElfFile::IsElf(path))
+		return ParseElfModules(path);
+
 	auto mi = std::make_unique<ModuleInfo>();
 	auto& pe = mi->PE;
 	if (!pe.Open(path))
@@ -37,6 +45,7 @@ bool CView::ParseModules(PCWSTR path) {
 	if (hIcon)
 		image = m_Tree.GetImageList(TVSIL_NORMAL).AddIcon(hIcon);
 	auto [hItem, m] = ParsePE(path, TVI_ROOT, image);
+	m_Root = m;
 	auto tmi = std::make_unique<ModuleTreeInfo>();
 	tmi->Module = m;
 	m_TreeItems.insert({ hItem, std::move(tmi) });
@@ -50,6 +59,92 @@ bool CView::ParseModules(PCWSTR path) {
 	return true;
 }
 
+bool CView::ParseElfModules(PCWSTR path) {
+	//
+	// the whole closure is resolved up front against the file system the program sits in; the program's
+	// own directory is searched last, so libraries copied next to it resolve as well
+	//
+	ElfLoader::Options options;
+	options.SysRoot = ElfLoader::GuessSysRoot(path);
+	options.ExtraDirs.push_back(std::filesystem::path(path).parent_path().wstring());
+	ElfLoader loader(options);
+	if (!loader.Load(path))
+		return false;
+
+	m_Modules.reserve(64);
+	m_Tree.DeleteAllItems();
+	m_Tree.SetRedraw(FALSE);
+
+	auto& modules = loader.GetModules();
+	std::vector<ModuleInfo*> infos;
+	for (auto& em : modules) {
+		auto mi = std::make_unique<ModuleInfo>();
+		mi->Name = CA2W(em.Name.c_str(), CP_UTF8);
+		mi->FullPath = em.Path;
+		mi->Elf = em.File;
+		mi->IsApiSet = false;
+		mi->Icon = em.File ? 0 : 2;
+		if (em.File)
+			BuildExports(mi.get(), *em.File);
+		infos.push_back(mi.get());
+		m_Modules.push_back(std::move(mi));
+	}
+	for (size_t i = 0; i < modules.size(); i++)
+		for (auto needed : modules[i].Needed)
+			if (std::ranges::find(infos[i]->Dependencies, infos[needed]) == infos[i]->Dependencies.end())
+				infos[i]->Dependencies.push_back(infos[needed]);
+
+	WCHAR fullpath[MAX_PATH];
+	wcscpy_s(fullpath, path);
+	WORD icon = 0;
+	auto hIcon = ::ExtractAssociatedIcon(_Module.GetModuleInstance(), fullpath, &icon);
+	if (hIcon)
+		infos[0]->Icon = m_Tree.GetImageList(TVSIL_NORMAL).AddIcon(hIcon);
+
+	std::vector<bool> expanded(modules.size());
+	auto hItem = InsertElfModule(loader, infos, 0, TVI_ROOT, expanded);
+	m_Root = infos[0];
+	auto tmi = std::make_unique<ModuleTreeInfo>();
+	tmi->Module = m_Root;
+	m_TreeItems.insert({ hItem, std::move(tmi) });
+	m_Tree.Expand(m_Tree.GetRootItem(), TVE_EXPAND);
+	m_Tree.SelectItem(hItem);
+
+	m_Tree.SetRedraw(TRUE);
+
+	m_ModuleList.SetItemCount((int)m_Modules.size());
+
+	return true;
+}
+
+HTREEITEM CView::InsertElfModule(ElfLoader const& loader, std::vector<ModuleInfo*> const& modules, size_t index, HTREEITEM hParent, std::vector<bool>& expanded) {
+	auto m = modules[index];
+	auto hItem = m_Tree.InsertItem(m->Name.c_str(), m->Icon, m->Icon, hParent, TVI_LAST);
+	if (expanded[index])
+		return hItem;
+
+	//
+	// like PE modules, a library's dependencies show under its first occurrence only. The imports of
+	// each node are the importer's undefined symbols the loader bound to that library.
+	//
+	expanded[index] = true;
+	auto& importer = loader.GetModules()[index];
+	for (auto needed : importer.Needed) {
+		auto hSubItem = InsertElfModule(loader, modules, needed, hItem, expanded);
+		auto node = std::make_unique<ModuleTreeInfo>();
+		node->Module = modules[needed];
+		for (auto& symbol : importer.File->GetSymbols()) {
+			if (importer.Bindings[symbol.Index] != needed)
+				continue;
+			libpe::PEImportFunction func{};
+			func.FuncName = symbol.Version.empty() ? std::string(symbol.Name) : std::format("{}@{}", symbol.Name, symbol.Version);
+			node->Imports.push_back(std::move(func));
+		}
+		m_TreeItems.insert({ hSubItem, std::move(node) });
+	}
+	return hItem;
+}
+
 HICON CView::GetMainIcon() const {
 	return m_Tree.GetImageList().GetIcon(m_Tree.GetImageList().GetImageCount() - 1);
 }
@@ -98,9 +193,9 @@ CString CView::GetColumnText(HWND h, int row, int col) const {
 			case ColumnType::Name: return mi->Name.c_str();
 			case ColumnType::Path: return mi->FullPath.c_str();
 			case ColumnType::FileSize:
-				if (!mi->IsApiSet && mi->PE->IsLoaded()) {
+				if (!mi->IsApiSet && (mi->PE->IsLoaded() || mi->Elf)) {
 					WCHAR text[64];
-					::StrFormatByteSize(mi->PE.GetFileSize(), text, _countof(text));
+					::StrFormatByteSize(mi->GetFileSize(), text, _countof(text));
 					return text;
 				}
 				break;
@@ -109,7 +204,14 @@ CString CView::GetColumnText(HWND h, int row, int col) const {
 			case ColumnType::ImageBase: return mi->GetImageBase() == 0 ? L"" : std::format(L"0x{:X}", mi->GetImageBase()).c_str();
 			case ColumnType::Arch: return MachineTypeToString(mi->GetArch());
 			case ColumnType::Subsystem: return SubsystemToString(mi->GetSubsystem());
-
+			case ColumnType::Mitigations: return mi->GetMitigations().ToString().c_str();
+			case ColumnType::Signer:
+				if (auto signer = mi->GetSigner(); signer)
+					return signer->Subject.c_str();
+				break;
+			case ColumnType::Toolchain: return mi->GetToolchain().ToString().c_str();
+			case ColumnType::Startup: return mi->GetStartup().ToString().c_str();
+			case ColumnType::Packing: return mi->GetPacking().ToString().c_str();
 		}
 	}
 	else if (h == m_ExportsList) {
@@ -132,8 +234,9 @@ CString CView::GetColumnText(HWND h, int row, int col) const {
 		switch (tag) {
 			case ColumnType::Name: return func.FuncName.c_str();
 			case ColumnType::Hint: return std::to_wstring(func.ImpByName.Hint).c_str();
-			case ColumnType::Ordinal: return func.ImpByName.Name[0] == 0 ? std::to_wstring(func.unThunk.Thunk32.u1.Ordinal).c_str() : L"0";
+			case ColumnType::Ordinal: return func.ByOrdinal ? std::to_wstring(IMAGE_ORDINAL32(func.unThunk.Thunk32.u1.Ordinal)).c_str() : L"0";
 			case ColumnType::UndecoratedName: return func.FuncName.empty() ? L"" : (PCWSTR)UndecorateName(func.FuncName.c_str());
+			case ColumnType::References: return mod->ReferencesKnown ? std::to_wstring(func.References).c_str() : L"";
 		}
 	}
 
@@ -160,6 +263,7 @@ int CView::GetRowImage(HWND h, int row, int col) const {
 void CView::OnTreeSelChanged(HWND tree, HTREEITEM hOld, HTREEITEM hNew) {
 	ATLASSERT(m_Tree.GetSelectedItem() == hNew);
 	if (auto it = m_TreeItems.find(hNew); it != m_TreeItems.end()) {
+		LoadReferences(it->second.get());
 		m_ImportsList.SetItemCount((int)it->second->Imports.size());
 		auto mi = it->second->Module;
 		m_ExportsList.SetItemCount(mi ? (int)mi->Exports.size() : 0);
@@ -182,10 +286,15 @@ void CView::DoSort(SortInfo const* si) {
 				case ColumnType::Name: return SortHelper::Sort(m1->Name, m2->Name, asc);
 				case ColumnType::Path: return SortHelper::Sort(m1->FullPath, m2->FullPath, asc);
 				case ColumnType::FileTime: return SortHelper::Sort(m1->FileTime, m2->FileTime, asc);
-				case ColumnType::FileSize: return SortHelper::Sort(m1->PE.GetFileSize(), m2->PE.GetFileSize(), asc);
+				case ColumnType::FileSize: return SortHelper::Sort(m1->GetFileSize(), m2->GetFileSize(), asc);
 				case ColumnType::ImageBase: return SortHelper::Sort(m1->GetImageBase(), m2->GetImageBase(), asc);
 				case ColumnType::Arch: return SortHelper::Sort(m1->GetArch(), m2->GetArch(), asc);
 				case ColumnType::Subsystem: return SortHelper::Sort(m1->GetSubsystem(), m2->GetSubsystem(), asc);
+				case ColumnType::Mitigations: return SortHelper::Sort(m1->GetMitigations().ToString(), m2->GetMitigations().ToString(), asc);
+				case ColumnType::Signer: return SortHelper::Sort(m1->GetSigner() ? m1->GetSigner()->Subject : L"", m2->GetSigner() ? m2->GetSigner()->Subject : L"", asc);
+				case ColumnType::Toolchain: return SortHelper::Sort(m1->GetToolchain().ToString(), m2->GetToolchain().ToString(), asc);
+				case ColumnType::Startup: return SortHelper::Sort(m1->GetStartup().ToString(), m2->GetStartup().ToString(), asc);
+				case ColumnType::Packing: return SortHelper::Sort(m1->GetPacking().ToString(), m2->GetPacking().ToString(), asc);
 			}
 			return false;
 		};
@@ -198,7 +307,8 @@ void CView::DoSort(SortInfo const* si) {
 			switch (tag) {
 				case ColumnType::Name: return SortHelper::Sort(f1.FuncName, f2.FuncName, asc);
 				case ColumnType::Hint: return SortHelper::Sort(f1.ImpByName.Hint, f2.ImpByName.Hint, asc);
-				case ColumnType::Ordinal: return SortHelper::Sort(f1.ImpByName.Name[0] ? 0 : f1.unThunk.Thunk32.u1.Ordinal, f2.ImpByName.Name[0] ? 0 : f2.unThunk.Thunk32.u1.Ordinal, asc);
+				case ColumnType::Ordinal: return SortHelper::Sort(f1.ByOrdinal ? IMAGE_ORDINAL32(f1.unThunk.Thunk32.u1.Ordinal) : 0, f2.ByOrdinal ? IMAGE_ORDINAL32(f2.unThunk.Thunk32.u1.Ordinal) : 0, asc);
+				case ColumnType::References: return SortHelper::Sort(f1.References, f2.References, asc);
 			}
 			return false;
 		};
@@ -222,7 +332,7 @@ void CView::DoSort(SortInfo const* si) {
 }
 
 std::pair<HTREEITEM, ModuleInfo*> CView::ParsePE(PCWSTR name, HTREEITEM hParent, int icon) {
-	auto apiSet = _wcsnicmp(name, L"api-ms-", 7) == 0 || _wcsnicmp(name, L"ext-ms-", 7) == 0;
+	auto apiSet = SimdScan::IsApiSetName(name);
 	auto fullpath = apiSet ? false : wcschr(name, L'\\') != nullptr;
 	auto mi = std::make_unique<ModuleInfo>();
 	auto m = mi.get();
@@ -238,7 +348,8 @@ std::pair<HTREEITEM, ModuleInfo*> CView::ParsePE(PCWSTR name, HTREEITEM hParent,
 
 	auto hLib = apiSet || fullpath ? nullptr : ::LoadLibraryEx(name, nullptr, DONT_RESOLVE_DLL_REFERENCES);
 	auto ext = wcsrchr(name, L'.');
-	if (!apiSet && !fullpath && hLib == nullptr && _wcsicmp(ext, L".sys") == 0) {
+	auto sys = ext && SimdScan::EqualsNoCase(ext, L".sys");
+	if (!apiSet && !fullpath && hLib == nullptr && sys) {
 		//
 		// try in drivers directory for sys files
 		//
@@ -260,7 +371,7 @@ std::pair<HTREEITEM, ModuleInfo*> CView::ParsePE(PCWSTR name, HTREEITEM hParent,
 		//
 		icon = apiSet ? 1 : 0;
 		if (icon == 0) {
-			if (_wcsicmp(ext, L".sys") == 0)
+			if (sys)
 				icon = 3;
 		}
 	}
@@ -297,17 +408,8 @@ std::pair<HTREEITEM, ModuleInfo*> CView::ParsePE(PCWSTR name, HTREEITEM hParent,
 			m->Name = wcsrchr(name, L'\\') + 1;
 		hItem = m_Tree.InsertItem(m->Name.c_str(), icon, icon, hParent, TVI_LAST);
 		if ((chars && !m->PE->IsLoaded() && m->PE.Open(name))) {
-			auto imports = m->PE->GetImport();
-			if (imports) {
-				for (auto& lib : *imports) {
-					std::wstring libname = (PCWSTR)CString(lib.ModuleName.c_str());
-					auto [hSubItem, m2] = ParsePE(libname.c_str(), hItem);
-					auto nodeImports = std::make_unique<ModuleTreeInfo>();
-					nodeImports->Imports = lib.ImportFunc;
-					nodeImports->Module = m2;
-					m_TreeItems.insert({ hSubItem, std::move(nodeImports) });
-				}
-			}
+			ParseImports(m, hItem);
+			ParseEmbedded(m, hItem);
 		}
 	}
 	else {
@@ -331,10 +433,242 @@ std::pair<HTREEITEM, ModuleInfo*> CView::ParsePE(PCWSTR name, HTREEITEM hParent,
 	return { hItem, m };
 }
 
+void CView::ParseImports(ModuleInfo* m, HTREEITEM hItem) {
+	auto imports = m->PE->GetImport();
+	if (imports == nullptr)
+		return;
+
+	for (size_t i = 0; i < imports->size(); i++) {
+		auto& lib = (*imports)[i];
+		std::wstring libname = (PCWSTR)CString(lib.ModuleName.c_str());
+		auto [hSubItem, m2] = ParsePE(libname.c_str(), hItem);
+		if (std::ranges::find(m->Dependencies, m2) == m->Dependencies.end())
+			m->Dependencies.push_back(m2);
+		auto nodeImports = std::make_unique<ModuleTreeInfo>();
+		nodeImports->Imports = lib.ImportFunc;
+		nodeImports->Module = m2;
+		nodeImports->Importer = m;
+		nodeImports->ImportIndex = i;
+		ResolveOrdinals(nodeImports->Imports, m2, lib.ModuleName);
+		nodeImports->ReferencesKnown = m->PE->GetFileInfo()->HasImportUsage;
+		m_TreeItems.insert({ hSubItem, std::move(nodeImports) });
+	}
+}
+
+void CView::LoadReferences(ModuleTreeInfo* node) {
+	//
+	// the importer's code is scanned the first time one of its import lists is shown
+	//
+	if (node->ReferencesKnown || node->Importer == nullptr || !node->Importer->PE->ScanImportUsage())
+		return;
+
+	auto imports = node->Importer->PE->GetImport();
+	if (imports == nullptr || node->ImportIndex >= imports->size())
+		return;
+	auto& funcs = (*imports)[node->ImportIndex].ImportFunc;
+	for (size_t i = 0; i < node->Imports.size() && i < funcs.size(); i++)
+		node->Imports[i].References = funcs[i].References;
+	node->ReferencesKnown = true;
+}
+
+void CView::ResolveOrdinals(std::vector<libpe::PEImportFunction>& imports, ModuleInfo const* target, std::string_view dll) {
+	//
+	// imports by ordinal carry no name; take it from the target's exports or the bundled table,
+	// so they can be searched and sorted by name. ByOrdinal stays set, the list still shows the ordinal.
+	//
+	auto exports = target && target->PE ? target->PE->GetExport() : nullptr;
+	for (auto& func : imports) {
+		if (func.ByOrdinal && func.FuncName.empty())
+			func.FuncName = OrdinalNames::Resolve(exports, dll, (uint16_t)IMAGE_ORDINAL32(func.unThunk.Thunk32.u1.Ordinal));
+	}
+}
+
+void CView::ParseEmbedded(ModuleInfo* host, HTREEITEM hItem, uint32_t depth) {
+	//
+	// images nest, a hostile file can nest them (or itself) without end
+	//
+	constexpr uint32_t MaxDepth = 4;
+	auto embedded = depth < MaxDepth ? host->PE->GetEmbedded() : nullptr;
+	if (embedded == nullptr)
+		return;
+
+	//
+	// images carried in resources or the overlay are parsed from the host's copy of them,
+	// they show up as children of the host but are not loader dependencies
+	//
+	for (auto& image : *embedded) {
+		auto mi = std::make_unique<ModuleInfo>();
+		auto m = mi.get();
+		m->Name = std::format(L"{} [{}]", host->Name, image.Source);
+		m->FullPath = std::format(L"{}|{}", host->FullPath, image.Source);
+		m->IsApiSet = false;
+		m->Icon = m->PE.Open(image.Data, m->FullPath) ? 0 : 2;
+		auto hSubItem = m_Tree.InsertItem(m->Name.c_str(), m->Icon, m->Icon, hItem, TVI_LAST);
+		if (m->PE) {
+			ParseImports(m, hSubItem);
+			ParseEmbedded(m, hSubItem, depth + 1);
+			if (auto exports = m->PE->GetExport(); exports)
+				BuildExports(m, exports);
+		}
+		host->Embedded.push_back(m);
+
+		auto node = std::make_unique<ModuleTreeInfo>();
+		node->Module = m;
+		m_TreeItems.insert({ hSubItem, std::move(node) });
+		m_Modules.push_back(std::move(mi));
+	}
+}
+
 void CView::BuildExports(ModuleInfo* mi, libpe::PEExport* exports) const {
 	mi->Exports = exports->Funcs;
 }
 
+void CView::BuildExports(ModuleInfo* mi, ElfFile const& elf) const {
+	//
+	// defined dynamic symbols, with the .dynsym index as the ordinal and name@@VER / name@VER as nm shows them
+	//
+	for (auto& symbol : elf.GetSymbols()) {
+		if (!symbol.Defined || !symbol.IsGlobal() || symbol.Name.empty())
+			continue;
+		libpe::PEExportFunction func{};
+		func.FuncRVA = (DWORD)symbol.Value;
+		func.Ordinal = symbol.Index;
+		func.FuncName = symbol.Version.empty() ? std::string(symbol.Name)
+			: std::format("{}{}{}", symbol.Name, symbol.HiddenVersion ? "@" : "@@", symbol.Version);
+		mi->Exports.push_back(std::move(func));
+	}
+}
+
+LRESULT CView::OnReportMitigations(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CWaitCursor wait;
+	GetFrame()->ShowReport(L"Mitigations", Reports::Mitigations(m_Modules));
+	return 0;
+}
+
+LRESULT CView::OnReportSignatures(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CWaitCursor wait;
+	GetFrame()->ShowReport(L"Signatures", Reports::Signatures(m_Modules));
+	return 0;
+}
+
+LRESULT CView::OnReportToolchain(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CWaitCursor wait;
+	GetFrame()->ShowReport(L"Toolchain", Reports::Toolchain(m_Modules));
+	return 0;
+}
+
+LRESULT CView::OnReportStartup(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CWaitCursor wait;
+	GetFrame()->ShowReport(L"Startup", Reports::Startup(DependencyGraph::InitOrder(m_Root)));
+	return 0;
+}
+
+LRESULT CView::OnReportBoundImports(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CWaitCursor wait;
+	GetFrame()->ShowReport(L"Bound Imports", Reports::BoundImports(m_Modules));
+	return 0;
+}
+
+LRESULT CView::OnExportGraph(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CSimpleFileDialog dlg(FALSE, L"dot", nullptr, OFN_EXPLORER | OFN_ENABLESIZING | OFN_OVERWRITEPROMPT,
+		L"GraphViz Files\0*.dot;*.gv\0GEXF Files\0*.gexf\0", m_hWnd);
+	ThemeHelper::Suspend();
+	auto ok = dlg.DoModal() == IDOK;
+	ThemeHelper::Resume();
+	if (!ok)
+		return 0;
+
+	CWaitCursor wait;
+	GraphExport graph;
+	DependencyGraph::Export(m_Root, graph);
+	GraphExport::Options options;
+	options.Type = GraphExport::FormatFromPath(dlg.m_szFileName);
+	if (!graph.Write(options, std::wstring(dlg.m_szFileName)))
+		AtlMessageBox(m_hWnd, L"Failed to write the graph file", IDR_MAINFRAME, MB_ICONERROR);
+	return 0;
+}
+
+LRESULT CView::OnReportWhyLoaded(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	auto hItem = m_Tree.GetSelectedItem();
+	auto it = hItem ? m_TreeItems.find(hItem) : m_TreeItems.end();
+	if (it == m_TreeItems.end() || it->second->Module == nullptr) {
+		AtlMessageBox(m_hWnd, L"Select a module in the tree first", IDR_MAINFRAME, MB_ICONINFORMATION);
+		return 0;
+	}
+
+	if (!m_PathQuery)
+		m_PathQuery = std::make_unique<PathQuery>(DependencyGraph::BuildPathQuery(m_Root, m_PathModules));
+
+	auto target = std::ranges::find(m_PathModules, it->second->Module);
+	std::vector<std::wstring_view> names;
+	names.reserve(m_PathModules.size() + 1);
+	for (auto m : m_PathModules)
+		names.push_back(m->Name);
+	if (target == m_PathModules.end())
+		names.push_back(it->second->Module->Name);
+
+	GetFrame()->ShowReport(L"Why Loaded", Reports::WhyLoaded(*m_PathQuery, names, (uint32_t)(target - m_PathModules.begin())));
+	return 0;
+}
+
+LRESULT CView::OnWhatIfAdd(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	CSimpleFileDialog dlg(TRUE, nullptr, nullptr, OFN_EXPLORER | OFN_ENABLESIZING | OFN_FILEMUSTEXIST,
+		L"DLL Files\0*.dll\0All Files\0*.*\0", m_hWnd);
+	ThemeHelper::Suspend();
+	auto ok = dlg.DoModal() == IDOK;
+	ThemeHelper::Resume();
+	if (!ok)
+		return 0;
+
+	CWaitCursor wait;
+	if (!m_WhatIf)
+		m_WhatIf = std::make_unique<WhatIf>(m_Root);
+	if (!m_WhatIf->Add(dlg.m_szFileName)) {
+		AtlMessageBox(m_hWnd, L"Not a PE image", IDR_MAINFRAME, MB_ICONERROR);
+		return 0;
+	}
+	GetFrame()->ShowReport(L"What If", Reports::WhatIfClosure(*m_WhatIf));
+	return 0;
+}
+
+LRESULT CView::OnWhatIfRemove(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	auto hItem = m_Tree.GetSelectedItem();
+	auto it = hItem ? m_TreeItems.find(hItem) : m_TreeItems.end();
+	if (it == m_TreeItems.end() || it->second->Module == nullptr || it->second->Module == m_Root) {
+		AtlMessageBox(m_hWnd, L"Select an imported module in the tree first", IDR_MAINFRAME, MB_ICONINFORMATION);
+		return 0;
+	}
+
+	CWaitCursor wait;
+	if (!m_WhatIf)
+		m_WhatIf = std::make_unique<WhatIf>(m_Root);
+	m_WhatIf->Remove(it->second->Module->Name);
+	GetFrame()->ShowReport(L"What If", Reports::WhatIfClosure(*m_WhatIf));
+	return 0;
+}
+
+LRESULT CView::OnWhatIfClear(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	m_WhatIf.reset();
+	return 0;
+}
+
+LRESULT CView::OnViewRawBytes(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/) {
+	auto hItem = m_Tree.GetSelectedItem();
+	auto it = hItem ? m_TreeItems.find(hItem) : m_TreeItems.end();
+	if (it == m_TreeItems.end() || it->second->Module == nullptr) {
+		AtlMessageBox(m_hWnd, L"Select a module in the tree first", IDR_MAINFRAME, MB_ICONINFORMATION);
+		return 0;
+	}
+
+	//
+	// embedded images have no file of their own, ELF modules no PE structure to show
+	//
+	auto m = it->second->Module;
+	if (m->Elf || m->FullPath.find(L'|') != std::wstring::npos || !GetFrame()->ShowBytes(m->Name.c_str(), m->FullPath))
+		AtlMessageBox(m_hWnd, L"Raw bytes are shown for PE files on disk only", IDR_MAINFRAME, MB_ICONINFORMATION);
+	return 0;
+}
+
 LRESULT CView::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/) {
 	m_hWndClient = m_MainSplitter.Create(m_hWnd, rcDefault, nullptr, WS_CHILD | WS_VISIBLE | WS_CLIPCHILDREN);
 	m_VSplitter.Create(m_MainSplitter, rcDefault, nullptr, WS_CHILD | WS_VISIBLE | WS_CLIPCHILDREN);
@@ -396,12 +730,18 @@ LRESULT CView::OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOO
 	cm->AddColumn(L"Arch", LVCFMT_LEFT, 60, ColumnType::Arch);
 	cm->AddColumn(L"Image Base", LVCFMT_RIGHT, 100, ColumnType::ImageBase);
 	cm->AddColumn(L"Subsystem", LVCFMT_LEFT, 70, ColumnType::Subsystem);
+	cm->AddColumn(L"Mitigations", LVCFMT_LEFT, 120, ColumnType::Mitigations);
+	cm->AddColumn(L"Signer", LVCFMT_LEFT, 200, ColumnType::Signer);
+	cm->AddColumn(L"Toolchain", LVCFMT_LEFT, 180, ColumnType::Toolchain);
+	cm->AddColumn(L"Startup", LVCFMT_LEFT, 120, ColumnType::Startup);
+	cm->AddColumn(L"Packing", LVCFMT_LEFT, 120, ColumnType::Packing);
 
 	cm = GetColumnManager(m_ImportsList);
 	cm->AddColumn(L"Name", LVCFMT_LEFT, 250, ColumnType::Name);
 	cm->AddColumn(L"Ordinal", LVCFMT_RIGHT, 70, ColumnType::Ordinal);
 	cm->AddColumn(L"Hint", LVCFMT_RIGHT, 70, ColumnType::Hint);
 	cm->AddColumn(L"Undecorated Name", LVCFMT_LEFT, 250, ColumnType::UndecoratedName);
+	cm->AddColumn(L"References", LVCFMT_RIGHT, 80, ColumnType::References);
 
 	cm = GetColumnManager(m_ExportsList);
 	cm->AddColumn(L"Name", LVCFMT_LEFT, 250, ColumnType::Name);
@@ -430,7 +770,13 @@ CString const& ModuleInfo::GetFileTime() const {
 	return m_FileTimeAsString;
 }
 
+uint64_t ModuleInfo::GetFileSize() const {
+	return Elf ? Elf->GetFileSize() : PE.GetFileSize();
+}
+
 ULONG64 ModuleInfo::GetImageBase() const {
+	if (m_ImageBase == 0 && Elf)
+		m_ImageBase = Elf->GetImageBase();
 	if (m_ImageBase == 0 && PE) {
 		m_ImageBase = PE->GetFileInfo()->IsPE64 ? PE->GetNTHeader()->NTHdr64.OptionalHeader.ImageBase : PE->GetNTHeader()->NTHdr32.OptionalHeader.ImageBase;
 	}
@@ -438,6 +784,14 @@ ULONG64 ModuleInfo::GetImageBase() const {
 }
 
 WORD ModuleInfo::GetArch() const {
+	if (m_Arch == 0 && Elf) {
+		switch (Elf->GetMachine()) {
+			case ElfFile::MachineX86: m_Arch = IMAGE_FILE_MACHINE_I386; break;
+			case ElfFile::MachineX64: m_Arch = IMAGE_FILE_MACHINE_AMD64; break;
+			case ElfFile::MachineArm: m_Arch = IMAGE_FILE_MACHINE_ARMNT; break;
+			case ElfFile::MachineArm64: m_Arch = IMAGE_FILE_MACHINE_ARM64; break;
+		}
+	}
 	if (m_Arch == 0 && PE) {
 		m_Arch = PE->GetNTHeader()->NTHdr64.FileHeader.Machine;
 	}
@@ -453,3 +807,39 @@ WORD ModuleInfo::GetSubsystem() const {
 	}
 	return m_Subsystem;
 }
+
+ModuleMitigations const& ModuleInfo::GetMitigations() const {
+	if (!m_Mitigations)
+		m_Mitigations = std::make_unique<ModuleMitigations>(ModuleMitigations::FromPE(PE));
+	return *m_Mitigations;
+}
+
+ModuleToolchain const& ModuleInfo::GetToolchain() const {
+	if (!m_Toolchain)
+		m_Toolchain = std::make_unique<ModuleToolchain>(ModuleToolchain::FromPE(PE));
+	return *m_Toolchain;
+}
+
+ModuleStartup const& ModuleInfo::GetStartup() const {
+	if (!m_Startup)
+		m_Startup = std::make_unique<ModuleStartup>(ModuleStartup::FromPE(PE));
+	return *m_Startup;
+}
+
+ModulePacking const& ModuleInfo::GetPacking() const {
+	if (!m_Packing)
+		m_Packing = std::make_unique<ModulePacking>(ModulePacking::FromPE(PE));
+	return *m_Packing;
+}
+
+libpe::PESigner const* ModuleInfo::GetSigner() const {
+	if (!PE || !PE->IsLoaded())
+		return nullptr;
+
+	if (auto security = PE->GetSecurity(); security) {
+		for (auto& sec : *security)
+			if (sec.Signer)
+				return sec.Signer.get();
+	}
+	return nullptr;
+}
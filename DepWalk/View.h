@@ -6,22 +6,43 @@
 #include <TreeViewHelper.h>
 #include <CustomSplitterWindow.h>
 #include <PEFile.h>
+#include <ElfLoader.h>
+#include <Mitigations.h>
+#include <Toolchain.h>
+#include <Startup.h>
+#include <Packing.h>
+#include <SimdScan.h>
+#include <PathQuery.h>
+#include "WhatIf.h"
 
 struct ModuleInfo {
 	PEFile PE;
+	std::shared_ptr<const ElfFile> Elf;		// ELF modules, PE is not opened for them
 	std::wstring FullPath;
 	std::wstring Name;
 	std::vector<libpe::PEExportFunction> Exports;
+	std::vector<ModuleInfo*> Dependencies;		// static imports, in import table order
+	std::vector<ModuleInfo*> Embedded;			// images found in resources and the overlay
 	int Icon;
 	bool IsApiSet;
 	mutable ULONG64 FileTime{ 0 };
 	CString const& GetFileTime() const;
+	uint64_t GetFileSize() const;
 	ULONG64 GetImageBase() const;
 	WORD GetArch() const;
 	WORD GetSubsystem() const;
+	ModuleMitigations const& GetMitigations() const;
+	libpe::PESigner const* GetSigner() const;
+	ModuleToolchain const& GetToolchain() const;
+	ModuleStartup const& GetStartup() const;
+	ModulePacking const& GetPacking() const;
 
 private:
 	mutable CString m_FileTimeAsString;
+	mutable std::unique_ptr<ModuleMitigations> m_Mitigations;
+	mutable std::unique_ptr<ModuleToolchain> m_Toolchain;
+	mutable std::unique_ptr<ModuleStartup> m_Startup;
+	mutable std::unique_ptr<ModulePacking> m_Packing;
 	mutable ULONG64 m_ImageBase{ 0 };
 	mutable WORD m_Arch{ 0 };
 	mutable WORD m_Subsystem{ 0 };
@@ -30,6 +51,9 @@ private:
 struct ModuleTreeInfo {
 	std::vector<libpe::PEImportFunction> Imports;
 	ModuleInfo* Module{ nullptr };
+	ModuleInfo* Importer{ nullptr };	// whose import descriptor Imports came from
+	size_t ImportIndex{ 0 };
+	bool ReferencesKnown{ false };		// the importer's code was scanned for calls through the IAT
 };
 
 class CView : 
@@ -55,6 +79,17 @@ protected:
 	BEGIN_MSG_MAP(CView)
 		MESSAGE_HANDLER(WM_SETFOCUS, OnSetFocus)
 		MESSAGE_HANDLER(WM_CREATE, OnCreate)
+		COMMAND_ID_HANDLER(ID_REPORTS_MITIGATIONS, OnReportMitigations)
+		COMMAND_ID_HANDLER(ID_REPORTS_SIGNATURES, OnReportSignatures)
+		COMMAND_ID_HANDLER(ID_REPORTS_TOOLCHAIN, OnReportToolchain)
+		COMMAND_ID_HANDLER(ID_REPORTS_STARTUP, OnReportStartup)
+		COMMAND_ID_HANDLER(ID_REPORTS_BOUNDIMPORTS, OnReportBoundImports)
+		COMMAND_ID_HANDLER(ID_REPORTS_EXPORTGRAPH, OnExportGraph)
+		COMMAND_ID_HANDLER(ID_REPORTS_WHYLOADED, OnReportWhyLoaded)
+		COMMAND_ID_HANDLER(ID_WHATIF_ADD, OnWhatIfAdd)
+		COMMAND_ID_HANDLER(ID_WHATIF_REMOVE, OnWhatIfRemove)
+		COMMAND_ID_HANDLER(ID_WHATIF_CLEAR, OnWhatIfClear)
+		COMMAND_ID_HANDLER(ID_VIEW_RAWBYTES, OnViewRawBytes)
 		CHAIN_MSG_MAP(BaseFrame)
 		CHAIN_MSG_MAP(CVirtualListView<CView>)
 		CHAIN_MSG_MAP(CTreeViewHelper<CView>)
@@ -68,27 +103,44 @@ protected:
 private:
 	enum class ColumnType {
 		Name, Path, FileTime, LinkTime, FileSize, LinkChecksum, Arch, Subsystem, ImageBase, OSVersion,
-		Hint, Ordinal, UndecoratedName, ForwardedName, RVA, NameRVA,
+		Hint, Ordinal, UndecoratedName, ForwardedName, RVA, NameRVA, Mitigations, Signer, Toolchain, Startup,
+		References, Packing,
 	};
 
+	bool ParseElfModules(PCWSTR path);
+	HTREEITEM InsertElfModule(ElfLoader const& loader, std::vector<ModuleInfo*> const& modules, size_t index, HTREEITEM hParent, std::vector<bool>& expanded);
 	std::pair<HTREEITEM, ModuleInfo*> ParsePE(PCWSTR name, HTREEITEM hParent, int icon = -1);
+	void ParseImports(ModuleInfo* m, HTREEITEM hItem);
+	void ParseEmbedded(ModuleInfo* host, HTREEITEM hItem, uint32_t depth = 0);
+	static void LoadReferences(ModuleTreeInfo* node);
+	static void ResolveOrdinals(std::vector<libpe::PEImportFunction>& imports, ModuleInfo const* target, std::string_view dll);
 	void BuildExports(ModuleInfo* mi, libpe::PEExport* exports) const;
+	void BuildExports(ModuleInfo* mi, ElfFile const& elf) const;
 
 	LRESULT OnCreate(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
 	LRESULT OnSetFocus(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& /*bHandled*/);
+	LRESULT OnReportMitigations(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnReportSignatures(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnReportToolchain(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnReportStartup(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnReportBoundImports(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnExportGraph(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnReportWhyLoaded(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnWhatIfAdd(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnWhatIfRemove(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnWhatIfClear(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
+	LRESULT OnViewRawBytes(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
 
 	CListViewCtrl m_ModuleList, m_ImportsList, m_ExportsList;
 	CTreeViewCtrl m_Tree;
 	CCustomHorSplitterWindow m_HSplitter, m_MainSplitter;
 	CCustomSplitterWindow m_VSplitter;
 
-	struct Compare {
-		bool operator()(std::wstring const& s1, std::wstring const& s2) const {
-			return _wcsicmp(s1.c_str(), s2.c_str()) < 0;
-		}
-	};
-
-	std::map<std::wstring, ModuleInfo*, Compare> m_ModulesMap;
+	std::unordered_map<std::wstring, ModuleInfo*, SimdScan::NameHash, SimdScan::NameEquals> m_ModulesMap;
 	std::vector<std::unique_ptr<ModuleInfo>> m_Modules;
+	ModuleInfo* m_Root{ nullptr };
+	std::unique_ptr<PathQuery> m_PathQuery;				// built on the first "why loaded" query, the closure doesn't change
+	std::vector<ModuleInfo const*> m_PathModules;
+	std::unique_ptr<WhatIf> m_WhatIf;					// changes simulated so far, on top of the loaded closure
 	std::unordered_map<HTREEITEM, std::unique_ptr<ModuleTreeInfo>> m_TreeItems;
 };
@@ -0,0 +1,179 @@
+#include "pch.h"
+#include "WhatIf.h"
+#include "resource.h"
+#include "View.h"
+
+WhatIf::WhatIf(ModuleInfo const* root) : m_Root(root) {
+	//
+	// the current resolution of every import name in the closure
+	//
+	if (root) {
+		std::unordered_set<ModuleInfo const*> visited{ root };
+		m_Closure.push_back(root);
+		for (size_t i = 0; i < m_Closure.size(); i++)
+			for (auto dep : m_Closure[i]->Dependencies) {
+				m_Base.insert({ dep->Name, dep });
+				if (visited.insert(dep).second)
+					m_Closure.push_back(dep);
+			}
+	}
+
+	CRegKey key;
+	if (key.Open(HKEY_LOCAL_MACHINE, L"System\\CurrentControlSet\\Control\\Session Manager\\KnownDLLs", KEY_READ) == ERROR_SUCCESS) {
+		WCHAR name[64], value[MAX_PATH];
+		for (DWORD i = 0; ; i++) {
+			DWORD nameSize = _countof(name), size = sizeof(value), type;
+			if (::RegEnumValue(key, i, name, &nameSize, nullptr, &type, (BYTE*)value, &size) != ERROR_SUCCESS)
+				break;
+			if (type != REG_SZ)
+				continue;
+			std::wstring dll(value, size / sizeof(WCHAR));
+			dll.erase(dll.find_last_not_of(L'\0') + 1);
+			m_KnownDlls.insert(std::move(dll));
+		}
+	}
+}
+
+WhatIf::~WhatIf() = default;
+
+bool WhatIf::Add(std::wstring const& path) {
+	auto m = std::make_unique<ModuleInfo>();
+	if (!m->PE.Open(path))
+		return false;
+
+	auto slash = path.find_last_of(L'\\');
+	m->FullPath = path;
+	m->Name = slash == std::wstring::npos ? path : path.substr(slash + 1);
+	m->Icon = 0;
+	m->IsApiSet = false;
+
+	Overlay overlay;
+	if (auto exports = m->PE->GetExport(); exports) {
+		for (auto& func : exports->Funcs) {
+			if (!func.FuncName.empty())
+				overlay.Exports.push_back(func.FuncName);
+			overlay.Ordinals.push_back(exports->ExportDesc.Base + func.Ordinal);
+		}
+		std::ranges::sort(overlay.Exports);
+	}
+	overlay.KnownDll = m_KnownDlls.contains(m->Name);
+	auto name = m->Name;
+	overlay.Module = std::move(m);
+	Set(name, std::move(overlay));
+	return true;
+}
+
+void WhatIf::Remove(std::wstring_view name) {
+	Set(std::wstring(name), Overlay());
+}
+
+bool WhatIf::IsEmpty() const {
+	return m_Overlay.empty();
+}
+
+std::vector<std::wstring> WhatIf::GetChanges() const {
+	std::vector<std::wstring> changes;
+	for (auto& name : m_Order) {
+		auto& overlay = m_Overlay.find(name)->second;
+		if (overlay.Module == nullptr)
+			changes.push_back(std::format(L"remove {}", name));
+		else
+			changes.push_back(std::format(L"{} {}{}", m_Base.contains(name) ? L"replace with" : L"add", overlay.Module->FullPath,
+				overlay.KnownDll ? L" (a known DLL, the loader ignores it)" : L""));
+	}
+	return changes;
+}
+
+WhatIf::Result WhatIf::Evaluate() const {
+	Result result;
+	if (m_Root == nullptr)
+		return result;
+
+	//
+	// current modules bring their resolved dependencies along; only names in the overlay resolve anew.
+	// Overlay DLLs weren't part of the walk, their imports are looked up among the names the closure knows.
+	//
+	std::unordered_set<ModuleInfo const*> visited{ m_Root };
+	std::vector<ModuleInfo const*> queue{ m_Root };
+	auto edge = [&](ModuleInfo const* importer, std::wstring const& name, ModuleInfo const* target) {
+		if (auto it = m_Overlay.find(name); it != m_Overlay.end() && !it->second.KnownDll) {
+			target = it->second.Module.get();
+			if (target == nullptr) {
+				result.MissingModules.push_back({ importer, name });
+				return;
+			}
+			CheckFunctions(importer, name, it->second, result);
+		}
+		else if (target == nullptr) {
+			result.Unresolved.push_back({ importer, name });
+			return;
+		}
+		if (visited.insert(target).second)
+			queue.push_back(target);
+	};
+
+	for (size_t i = 0; i < queue.size(); i++) {
+		auto m = queue[i];
+		if (!IsOverlay(m)) {
+			for (auto dep : m->Dependencies)
+				edge(m, dep->Name, dep);
+		}
+		else if (auto imports = m->PE->GetImport(); imports) {
+			for (auto& lib : *imports) {
+				std::wstring name = (PCWSTR)CString(lib.ModuleName.c_str());
+				auto it = m_Base.find(name);
+				edge(m, name, it == m_Base.end() ? nullptr : it->second);
+			}
+		}
+	}
+
+	result.ModuleCount = queue.size();
+	result.CurrentModuleCount = m_Closure.size();
+	std::unordered_set<ModuleInfo const*> current(m_Closure.begin(), m_Closure.end());
+	for (auto m : queue)
+		if (!current.contains(m))
+			result.Added.push_back(m);
+	for (auto m : m_Closure)
+		if (!visited.contains(m))
+			result.Dropped.push_back(m);
+	for (auto& name : m_Order) {
+		auto& overlay = m_Overlay.find(name)->second;
+		if (auto it = m_Base.find(name); it != m_Base.end() && overlay.Module && !overlay.KnownDll)
+			result.Replaced.push_back({ it->second, overlay.Module.get() });
+	}
+	return result;
+}
+
+void WhatIf::Set(std::wstring const& name, Overlay overlay) {
+	if (auto it = std::ranges::find_if(m_Order, [&](auto& n) { return SimdScan::EqualsNoCase(n, name); }); it != m_Order.end())
+		m_Order.erase(it);
+	m_Order.push_back(name);
+	m_Overlay.insert_or_assign(name, std::move(overlay));
+}
+
+bool WhatIf::IsOverlay(ModuleInfo const* m) const {
+	auto it = m_Overlay.find(m->Name);
+	return it != m_Overlay.end() && it->second.Module.get() == m;
+}
+
+void WhatIf::CheckFunctions(ModuleInfo const* importer, std::wstring const& name, Overlay const& overlay, Result& result) const {
+	if (!importer->PE || !importer->PE->IsLoaded())
+		return;
+	auto imports = importer->PE->GetImport();
+	if (imports == nullptr)
+		return;
+
+	for (auto& lib : *imports) {
+		if (!SimdScan::EqualsNoCase((PCWSTR)CString(lib.ModuleName.c_str()), name))
+			continue;
+		for (auto& func : lib.ImportFunc) {
+			if (func.ByOrdinal) {
+				auto ordinal = (uint32_t)IMAGE_ORDINAL32(func.unThunk.Thunk32.u1.Ordinal);
+				if (!std::ranges::binary_search(overlay.Ordinals, ordinal))
+					result.MissingFunctions.push_back({ importer, overlay.Module.get(), std::format("#{}", ordinal) });
+			}
+			else if (!std::ranges::binary_search(overlay.Exports, std::string_view(func.FuncName)))
+				result.MissingFunctions.push_back({ importer, overlay.Module.get(), func.FuncName });
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <unordered_set>
+#include <SimdScan.h>
+
+struct ModuleInfo;
+
+//
+// "what if" module resolution: DLLs added, replaced or removed on paper, laid over the resolved closure
+// (ModuleInfo::Dependencies). Only imports of the names the overlay touches are resolved again; every other
+// module keeps its parse and its resolved dependencies, so a what-if costs one walk over the closure.
+// A DLL named like a known DLL changes nothing, the loader maps those from the system directory.
+//
+class WhatIf {
+public:
+	struct MissingModule {
+		ModuleInfo const* Importer;
+		std::wstring Name;
+	};
+
+	struct MissingFunction {
+		ModuleInfo const* Importer;
+		ModuleInfo const* Module;		// the overlay DLL
+		std::string Function;			// "#n" for an ordinal
+	};
+
+	struct Result {
+		size_t ModuleCount{ 0 };						// in the new closure
+		size_t CurrentModuleCount{ 0 };
+		std::vector<ModuleInfo const*> Added;			// in the new closure only
+		std::vector<ModuleInfo const*> Dropped;			// in the current closure only
+		std::vector<std::pair<ModuleInfo const*, ModuleInfo const*>> Replaced;	// current module, overlay DLL
+		std::vector<MissingModule> MissingModules;		// imports in the new closure the overlay removed
+		std::vector<MissingFunction> MissingFunctions;	// imported from an overlay DLL that doesn't export them
+		std::vector<MissingModule> Unresolved;			// imports of overlay DLLs nothing in the closure answers
+	};
+
+	explicit WhatIf(ModuleInfo const* root);
+	~WhatIf();
+
+	//
+	// the DLL answers imports of its file name from now on; false if it isn't a PE image
+	//
+	bool Add(std::wstring const& path);
+	void Remove(std::wstring_view name);
+
+	bool IsEmpty() const;
+	std::vector<std::wstring> GetChanges() const;		// one line per overlay entry, in the order given
+	Result Evaluate() const;
+
+private:
+	struct Overlay {
+		std::unique_ptr<ModuleInfo> Module;				// null - removed
+		std::vector<std::string_view> Exports;			// sorted names
+		std::vector<uint32_t> Ordinals;					// sorted, base included
+		bool KnownDll{ false };
+	};
+
+	void Set(std::wstring const& name, Overlay overlay);
+	bool IsOverlay(ModuleInfo const* m) const;
+	void CheckFunctions(ModuleInfo const* importer, std::wstring const& name, Overlay const& overlay, Result& result) const;
+
+	ModuleInfo const* m_Root;
+	std::unordered_map<std::wstring, ModuleInfo const*, SimdScan::NameHash, SimdScan::NameEquals> m_Base;	// import name to the current resolution
+	std::vector<ModuleInfo const*> m_Closure;
+	std::unordered_map<std::wstring, Overlay, SimdScan::NameHash, SimdScan::NameEquals> m_Overlay;
+	std::vector<std::wstring> m_Order;					// overlay names, oldest first
+	std::unordered_set<std::wstring, SimdScan::NameHash, SimdScan::NameEquals> m_KnownDlls;
+};
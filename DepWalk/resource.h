@@ -28,13 +28,24 @@
 #define ID_OPTIONS_ALWAYSONTOP          32776
 #define ID_TOOLS_SYSTEMINFORMATION      32777
 #define ID_HELP_ABOUTWINDOWS            32778
+#define ID_REPORTS_MITIGATIONS          32779
+#define ID_REPORTS_SIGNATURES           32780
+#define ID_REPORTS_TOOLCHAIN            32781
+#define ID_REPORTS_STARTUP              32782
+#define ID_REPORTS_BOUNDIMPORTS         32783
+#define ID_REPORTS_EXPORTGRAPH          32784
+#define ID_REPORTS_WHYLOADED            32785
+#define ID_WHATIF_ADD                   32786
+#define ID_WHATIF_REMOVE                32787
+#define ID_WHATIF_CLEAR                 32788
+#define ID_VIEW_RAWBYTES                32789
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        215
-#define _APS_NEXT_COMMAND_VALUE         32779
+#define _APS_NEXT_COMMAND_VALUE         32790
 #define _APS_NEXT_CONTROL_VALUE         1003
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "AsyncFile.h"
+#include <algorithm>
+
+AsyncFile::~AsyncFile() {
+	Close();
+}
+
+bool AsyncFile::Open(std::wstring const& path) {
+	Close();
+
+	m_hFile = ::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	m_Io = ::GetFileSizeEx(m_hFile, &size) ? ::CreateThreadpoolIo(m_hFile, OnIoComplete, nullptr, nullptr) : nullptr;
+	if (m_Io == nullptr) {
+		Close();
+		return false;
+	}
+	m_Size = size.QuadPart;
+	return true;
+}
+
+void AsyncFile::Close() {
+	//
+	// no read may be in flight; a callback still running after its coroutine closed the file only touches its locals
+	//
+	if (m_Io)
+		::CloseThreadpoolIo(m_Io);
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		::CloseHandle(m_hFile);
+	m_Io = nullptr;
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_Size = 0;
+}
+
+uint64_t AsyncFile::GetSize() const {
+	return m_Size;
+}
+
+AsyncFile::ReadAwaiter AsyncFile::Read(uint64_t offset, std::span<std::byte> buffer, Executor executor) const {
+	return ReadAwaiter(*this, offset, buffer, std::move(executor));
+}
+
+AsyncFile::ReadAwaiter::ReadAwaiter(AsyncFile const& file, uint64_t offset, std::span<std::byte> buffer, Executor executor) : m_File(file), m_Buffer(buffer) {
+	m_Request.Offset = static_cast<DWORD>(offset);
+	m_Request.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	m_Request.Resume = std::move(executor);
+}
+
+bool AsyncFile::ReadAwaiter::await_ready() const noexcept {
+	return m_Buffer.empty();
+}
+
+bool AsyncFile::ReadAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+	m_Request.Handle = handle;
+	::StartThreadpoolIo(m_File.m_Io);
+
+	//
+	// once the read is queued the completion may resume the coroutine (and free this awaiter) at any moment.
+	// Synchronous completions are queued to the pool as well.
+	//
+	auto size = static_cast<DWORD>((std::min)(m_Buffer.size(), size_t(UINT32_MAX)));
+	if (::ReadFile(m_File.m_hFile, m_Buffer.data(), size, nullptr, &m_Request) || ::GetLastError() == ERROR_IO_PENDING)
+		return true;
+
+	m_Request.Error = ::GetLastError();
+	::CancelThreadpoolIo(m_File.m_Io);
+	return false;
+}
+
+DWORD AsyncFile::ReadAwaiter::await_resume() const noexcept {
+	return m_Request.Error ? 0 : m_Request.Bytes;
+}
+
+void CALLBACK AsyncFile::OnIoComplete(PTP_CALLBACK_INSTANCE, PVOID, PVOID overlapped, ULONG result, ULONG_PTR bytes, PTP_IO) {
+	auto request = static_cast<Request*>(static_cast<OVERLAPPED*>(overlapped));
+	request->Error = result;
+	request->Bytes = static_cast<DWORD>(bytes);
+
+	//
+	// the request lives in the coroutine frame, which may be gone as soon as the coroutine runs
+	//
+	auto resume = std::move(request->Resume);
+	auto handle = request->Handle;
+	if (resume)
+		resume(handle);
+	else
+		handle.resume();
+}
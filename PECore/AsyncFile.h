@@ -0,0 +1,61 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+//
+// file read with overlapped I/O on the thread pool. A read suspends the awaiting coroutine until
+// the I/O completes; the executor then gets the coroutine to resume, on a thread of its choosing.
+// Without an executor the coroutine resumes on the I/O completion thread.
+//
+class AsyncFile {
+public:
+	using Executor = std::function<void(std::coroutine_handle<>)>;
+
+	AsyncFile() = default;
+	~AsyncFile();
+
+	AsyncFile(AsyncFile const&) = delete;
+	AsyncFile& operator=(AsyncFile const&) = delete;
+
+	bool Open(std::wstring const& path);
+	void Close();
+
+	uint64_t GetSize() const;
+
+	struct Request : OVERLAPPED {
+		std::coroutine_handle<> Handle;
+		Executor Resume;
+		DWORD Error;
+		DWORD Bytes;
+	};
+
+	class ReadAwaiter {
+	public:
+		ReadAwaiter(AsyncFile const& file, uint64_t offset, std::span<std::byte> buffer, Executor executor);
+
+		bool await_ready() const noexcept;
+		bool await_suspend(std::coroutine_handle<> handle) noexcept;
+		//
+		// bytes read, 0 on failure or at the end of the file
+		//
+		DWORD await_resume() const noexcept;
+
+	private:
+		AsyncFile const& m_File;
+		std::span<std::byte> m_Buffer;
+		Request m_Request{};
+	};
+
+	ReadAwaiter Read(uint64_t offset, std::span<std::byte> buffer, Executor executor = {}) const;
+
+private:
+	static void CALLBACK OnIoComplete(PTP_CALLBACK_INSTANCE, PVOID, PVOID overlapped, ULONG result, ULONG_PTR bytes, PTP_IO);
+
+	HANDLE m_hFile{ INVALID_HANDLE_VALUE };
+	PTP_IO m_Io{ nullptr };
+	uint64_t m_Size{ 0 };
+};
@@ -0,0 +1,358 @@
+#include "pch.h"
+#include "Authenticode.h"
+#include <SoftPub.h>
+#include <algorithm>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#pragma comment(lib, "wintrust")
+
+namespace {
+	using Bytes = std::span<const uint8_t>;
+
+	struct Der {
+		uint8_t Tag{ 0 };
+		Bytes Value;		// contents only
+		Bytes Encoded;		// tag + length + contents
+	};
+
+	enum DerTag : uint8_t {
+		Integer = 0x02, Oid = 0x06, Utf8String = 0x0C, PrintableString = 0x13, T61String = 0x14,
+		IA5String = 0x16, BmpString = 0x1E, Sequence = 0x30, Set = 0x31, ContextCons0 = 0xA0,
+	};
+
+	// 1.2.840.113549.1.7.2
+	constexpr uint8_t OidSignedData[] = { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02 };
+
+	//
+	// reads one DER TLV from the front of data and advances past it
+	//
+	bool ReadDer(Bytes& data, Der& der) {
+		if (data.size() < 2)
+			return false;
+
+		uint8_t tag = data[0];
+		if ((tag & 0x1F) == 0x1F)
+			return false;		// high tag numbers are not used by PKCS#7
+
+		size_t len = data[1], header = 2;
+		if (len & 0x80) {
+			auto n = len & 0x7F;
+			if (n == 0 || n > 4 || data.size() < 2 + n)
+				return false;	// indefinite lengths are not DER
+			len = 0;
+			for (size_t i = 0; i < n; i++)
+				len = (len << 8) | data[2 + i];
+			header += n;
+		}
+		if (len > data.size() - header)
+			return false;
+
+		der.Tag = tag;
+		der.Value = data.subspan(header, len);
+		der.Encoded = data.first(header + len);
+		data = data.subspan(header + len);
+		return true;
+	}
+
+	bool ReadDer(Bytes& data, uint8_t tag, Der& der) {
+		return ReadDer(data, der) && der.Tag == tag;
+	}
+
+	bool Equal(Bytes b1, Bytes b2) {
+		return b1.size() == b2.size() && memcmp(b1.data(), b2.data(), b1.size()) == 0;
+	}
+
+	uint64_t Hash(Bytes data, uint64_t hash = 0xcbf29ce484222325ULL) {
+		// FNV-1a, continued from hash
+		for (auto b : data)
+			hash = (hash ^ b) * 0x100000001b3ULL;
+		return hash;
+	}
+
+	std::string OidToString(Bytes oid) {
+		static const struct {
+			uint8_t Oid[9];
+			uint8_t Length;
+			const char* Name;
+		} known[] = {
+			{ { 0x2B, 0x0E, 0x03, 0x02, 0x1A }, 5, "SHA1" },
+			{ { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01 }, 9, "SHA256" },
+			{ { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x02 }, 9, "SHA384" },
+			{ { 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x03 }, 9, "SHA512" },
+			{ { 0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x02, 0x05 }, 8, "MD5" },
+		};
+		for (auto& k : known)
+			if (Equal(oid, Bytes(k.Oid, k.Length)))
+				return k.Name;
+
+		if (oid.empty())
+			return "";
+
+		std::string text = std::to_string(oid[0] / 40) + "." + std::to_string(oid[0] % 40);
+		uint64_t value = 0;
+		for (size_t i = 1; i < oid.size(); i++) {
+			value = (value << 7) | (oid[i] & 0x7F);
+			if ((oid[i] & 0x80) == 0) {
+				text += "." + std::to_string(value);
+				value = 0;
+			}
+		}
+		return text;
+	}
+
+	std::wstring DecodeString(Der const& value) {
+		std::wstring text;
+		switch (value.Tag) {
+			case Utf8String:
+			{
+				auto count = ::MultiByteToWideChar(CP_UTF8, 0, (PCSTR)value.Value.data(), (int)value.Value.size(), nullptr, 0);
+				text.resize(count);
+				::MultiByteToWideChar(CP_UTF8, 0, (PCSTR)value.Value.data(), (int)value.Value.size(), text.data(), count);
+				break;
+			}
+			case BmpString:
+				for (size_t i = 0; i + 1 < value.Value.size(); i += 2)
+					text += (wchar_t)((value.Value[i] << 8) | value.Value[i + 1]);
+				break;
+			case PrintableString:
+			case IA5String:
+			case T61String:
+				text.assign(value.Value.begin(), value.Value.end());
+				break;
+		}
+		return text;
+	}
+
+	//
+	// X.500 Name -> "CN=..., O=..., C=..." (most specific first, as Windows displays it)
+	//
+	std::wstring NameToString(Bytes name) {
+		static const struct {
+			uint8_t Id;			// 2.5.4.Id
+			PCWSTR Prefix;
+		} attributes[] = {
+			{ 3, L"CN" }, { 6, L"C" }, { 7, L"L" }, { 8, L"S" }, { 10, L"O" }, { 11, L"OU" },
+		};
+
+		std::wstring text;
+		Der rdn;
+		while (ReadDer(name, Set, rdn)) {
+			auto set = rdn.Value;
+			Der atv;
+			while (ReadDer(set, Sequence, atv)) {
+				auto seq = atv.Value;
+				Der type, value;
+				if (!ReadDer(seq, Oid, type) || !ReadDer(seq, value))
+					continue;
+				if (type.Value.size() != 3 || type.Value[0] != 0x55 || type.Value[1] != 0x04)
+					continue;
+				for (auto& attr : attributes) {
+					if (attr.Id == type.Value[2]) {
+						auto part = std::wstring(attr.Prefix) + L"=" + DecodeString(value);
+						text = text.empty() ? part : part + L", " + text;
+						break;
+					}
+				}
+			}
+		}
+		return text;
+	}
+
+	std::string ToHex(Bytes data) {
+		static const char digits[] = "0123456789ABCDEF";
+		std::string hex;
+		hex.reserve(data.size() * 2);
+		for (auto b : data) {
+			hex += digits[b >> 4];
+			hex += digits[b & 15];
+		}
+		return hex;
+	}
+
+	struct TbsCertificate {
+		Der Serial, Issuer, Subject;
+	};
+
+	bool ReadTbsCertificate(Bytes cert, TbsCertificate& tbs) {
+		Der tbsSeq, first, sigAlg, validity;
+		if (!ReadDer(cert, Sequence, tbsSeq))
+			return false;
+		auto t = tbsSeq.Value;
+		if (!ReadDer(t, first))
+			return false;
+		if (first.Tag == ContextCons0) {	// [0] EXPLICIT version
+			if (!ReadDer(t, Integer, tbs.Serial))
+				return false;
+		}
+		else if (first.Tag == Integer)
+			tbs.Serial = first;
+		else
+			return false;
+
+		return ReadDer(t, Sequence, sigAlg) && ReadDer(t, Sequence, tbs.Issuer)
+			&& ReadDer(t, Sequence, validity) && ReadDer(t, Sequence, tbs.Subject);
+	}
+
+	//
+	// keyed by the hash of the signer certificate (or the signer id without one) and the digest OID.
+	// An entry keeps the bytes it was built from, a hit is only taken when they match; a lookup
+	// hashes in place and allocates nothing.
+	//
+	struct CachedSigner {
+		CachedSigner(Bytes id, Bytes oid, bool found, std::shared_ptr<const libpe::PESigner> signer)
+			: Id(id.begin(), id.end()), Oid(oid.begin(), oid.end()), Found(found), Signer(std::move(signer)) {}
+
+		bool Matches(Bytes id, Bytes oid, bool found) const {
+			return Found == found && Equal(Id, id) && Equal(Oid, oid);
+		}
+
+		std::vector<uint8_t> Id;
+		std::vector<uint8_t> Oid;
+		bool Found;
+		std::shared_ptr<const libpe::PESigner> Signer;
+		mutable std::atomic<uint64_t> LastUse{ 0 };		// s_Clock at the last hit, hits only hold the shared lock
+	};
+
+	//
+	// bounded; when full the least recently used signer makes room, so the few signers most files
+	// share stay cached over a corpus of many others
+	//
+	constexpr size_t MaxCachedSigners = 1024;
+	std::shared_mutex s_CacheLock;
+	std::unordered_map<uint64_t, CachedSigner> s_Cache;
+	std::atomic<uint64_t> s_Clock;
+}
+
+std::shared_ptr<const libpe::PESigner> Authenticode::ParseSignedData(std::span<const std::byte> der) {
+	auto data = Bytes((const uint8_t*)der.data(), der.size());
+
+	//
+	// ContentInfo { contentType OID, [0] EXPLICIT SignedData }
+	//
+	Der contentInfo, contentType, content, signedData;
+	if (!ReadDer(data, Sequence, contentInfo))
+		return nullptr;
+	auto ci = contentInfo.Value;
+	if (!ReadDer(ci, Oid, contentType) || !Equal(contentType.Value, OidSignedData) || !ReadDer(ci, ContextCons0, content))
+		return nullptr;
+	auto c = content.Value;
+	if (!ReadDer(c, Sequence, signedData))
+		return nullptr;
+
+	//
+	// SignedData { version, digestAlgorithms, encapContentInfo, [0] certificates, [1] crls, signerInfos }
+	//
+	auto sd = signedData.Value;
+	Der version, digestAlgorithms, encapContent, item;
+	if (!ReadDer(sd, Integer, version) || !ReadDer(sd, Set, digestAlgorithms) || !ReadDer(sd, Sequence, encapContent))
+		return nullptr;
+
+	Bytes certificates, signerInfos;
+	while (ReadDer(sd, item)) {
+		if (item.Tag == ContextCons0)
+			certificates = item.Value;
+		else if (item.Tag == Set)
+			signerInfos = item.Value;
+	}
+
+	//
+	// first SignerInfo { version, IssuerAndSerialNumber, digestAlgorithm, ... }
+	//
+	Der signerInfo, siVersion, sid, issuer, serial, digestAlgorithm, digestOid;
+	if (!ReadDer(signerInfos, Sequence, signerInfo))
+		return nullptr;
+	auto si = signerInfo.Value;
+	if (!ReadDer(si, Integer, siVersion) || !ReadDer(si, Sequence, sid) || !ReadDer(si, Sequence, digestAlgorithm))
+		return nullptr;
+	auto ias = sid.Value;
+	if (!ReadDer(ias, Sequence, issuer) || !ReadDer(ias, Integer, serial))
+		return nullptr;
+	auto da = digestAlgorithm.Value;
+	ReadDer(da, Oid, digestOid);
+
+	//
+	// locate the signer certificate by issuer and serial number
+	//
+	Der cert;
+	TbsCertificate tbs;
+	bool found = false;
+	while (ReadDer(certificates, cert)) {
+		if (cert.Tag == Sequence && ReadTbsCertificate(cert.Value, tbs)
+			&& Equal(tbs.Serial.Value, serial.Value) && Equal(tbs.Issuer.Encoded, issuer.Encoded)) {
+			found = true;
+			break;
+		}
+	}
+
+	auto& id = found ? cert.Encoded : sid.Encoded;
+	auto certHash = Hash(id);
+	auto key = Hash(digestOid.Value, certHash);
+	{
+		std::shared_lock lock(s_CacheLock);
+		if (auto it = s_Cache.find(key); it != s_Cache.end() && it->second.Matches(id, digestOid.Value, found)) {
+			it->second.LastUse = ++s_Clock;
+			return it->second.Signer;
+		}
+	}
+
+	try {
+		auto signer = std::make_shared<libpe::PESigner>();
+		signer->Subject = found ? NameToString(tbs.Subject.Value) : L"";
+		signer->Issuer = NameToString(issuer.Value);
+		signer->Serial = ToHex(serial.Value);
+		signer->DigestAlgorithm = OidToString(digestOid.Value);
+		signer->CertHash = certHash;
+
+		std::unique_lock lock(s_CacheLock);
+		if (auto it = s_Cache.find(key); it != s_Cache.end()) {
+			//
+			// another thread got here first, or a different signer with the same hash that keeps its slot
+			//
+			if (it->second.Matches(id, digestOid.Value, found))
+				return it->second.Signer;
+			return signer;
+		}
+		if (s_Cache.size() >= MaxCachedSigners)
+			s_Cache.erase(std::ranges::min_element(s_Cache, {}, [](auto& entry) { return entry.second.LastUse.load(); }));
+		auto& entry = s_Cache.try_emplace(key, id, digestOid.Value, found, signer).first->second;
+		entry.LastUse = ++s_Clock;
+		return signer;
+	}
+	catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+
+bool Authenticode::Verify(PCWSTR path) {
+	WINTRUST_FILE_INFO fileInfo{ sizeof(fileInfo) };
+	fileInfo.pcwszFilePath = path;
+
+	WINTRUST_DATA data{ sizeof(data) };
+	data.dwUIChoice = WTD_UI_NONE;
+	data.fdwRevocationChecks = WTD_REVOKE_NONE;
+	data.dwUnionChoice = WTD_CHOICE_FILE;
+	data.pFile = &fileInfo;
+	data.dwStateAction = WTD_STATEACTION_VERIFY;
+	data.dwProvFlags = WTD_CACHE_ONLY_URL_RETRIEVAL;
+
+	GUID action = WINTRUST_ACTION_GENERIC_VERIFY_V2;
+	auto status = ::WinVerifyTrust(nullptr, &action, &data);
+
+	data.dwStateAction = WTD_STATEACTION_CLOSE;
+	::WinVerifyTrust(nullptr, &action, &data);
+
+	return status == ERROR_SUCCESS;
+}
+
+size_t Authenticode::GetCachedSignerCount() {
+	std::shared_lock lock(s_CacheLock);
+	return s_Cache.size();
+}
+
+void Authenticode::ClearCache() {
+	std::unique_lock lock(s_CacheLock);
+	s_Cache.clear();
+}
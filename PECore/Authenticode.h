@@ -0,0 +1,22 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include "libpe.h"
+
+//
+// minimal DER/PKCS#7 decoder for the Authenticode SignedData in the certificate table.
+// Decoding walks the DER in place; strings are only built the first time a signer
+// certificate is seen, afterwards the cached signer is shared by every file signed with it.
+//
+namespace Authenticode {
+	std::shared_ptr<const libpe::PESigner> ParseSignedData(std::span<const std::byte> der);
+
+	//
+	// optional cryptographic check of the embedded signature (WinVerifyTrust, no revocation checks)
+	//
+	bool Verify(PCWSTR path);
+
+	size_t GetCachedSignerCount();
+	void ClearCache();
+}
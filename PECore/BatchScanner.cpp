@@ -0,0 +1,146 @@
+#include "pch.h"
+#include "BatchScanner.h"
+#include "SimdScan.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+	bool IsPEExtension(std::wstring_view ext) {
+		static const PCWSTR extensions[] = {
+			L".exe", L".dll", L".sys", L".ocx", L".cpl", L".drv", L".efi", L".scr", L".mui", L".ax", L".tlb",
+		};
+		for (auto e : extensions)
+			if (SimdScan::EqualsNoCase(ext, e))
+				return true;
+		return false;
+	}
+}
+
+BatchScanner::BatchScanner(Options const& options) : m_Options(options) {
+}
+
+std::vector<std::wstring> BatchScanner::EnumerateFiles(std::wstring const& path) const {
+	return EnumerateFiles(path, [&](auto ext) {
+		return IsPEExtension(ext) || (m_Options.Packages && ZipArchive::IsPackageExtension(ext));
+		});
+}
+
+std::vector<std::wstring> BatchScanner::EnumerateFiles(std::wstring const& path, std::function<bool(std::wstring_view ext)> const& filter) const {
+	namespace fs = std::filesystem;
+
+	std::vector<std::wstring> files;
+	std::error_code ec;
+	if (!fs::is_directory(path, ec)) {
+		if (fs::is_regular_file(path, ec))
+			files.push_back(path);
+		return files;
+	}
+
+	auto add = [&](fs::directory_entry const& entry) {
+		if (!entry.is_regular_file(ec))
+			return;
+		if (filter(entry.path().extension().native()))
+			files.push_back(entry.path().native());
+	};
+
+	auto dirOptions = fs::directory_options::skip_permission_denied;
+	if (m_Options.Recurse) {
+		for (auto it = fs::recursive_directory_iterator(path, dirOptions, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec))
+			add(*it);
+	}
+	else {
+		for (auto it = fs::directory_iterator(path, dirOptions, ec); !ec && it != fs::directory_iterator(); it.increment(ec))
+			add(*it);
+	}
+	return files;
+}
+
+size_t BatchScanner::GetFailedCount() const {
+	return m_Failed;
+}
+
+std::vector<std::wstring> BatchScanner::GetOverBudget() const {
+	std::lock_guard lock(m_OverBudgetLock);
+	auto paths = m_OverBudget;
+	std::ranges::sort(paths);
+	return paths;
+}
+
+void BatchScanner::AddOverBudget(std::wstring const& path) {
+	std::lock_guard lock(m_OverBudgetLock);
+	m_OverBudget.push_back(path);
+}
+
+void BatchScanner::SplitPath(std::wstring_view path, std::wstring_view& package, std::wstring_view& entry) {
+	auto bar = path.find(L'|');
+	package = bar == std::wstring_view::npos ? std::wstring_view() : path.substr(0, bar);
+	entry = bar == std::wstring_view::npos ? path : path.substr(bar + 1);
+}
+
+std::vector<BatchScanner::WorkItem> BatchScanner::GetWorkItems(std::vector<std::wstring> const& files) {
+	m_Failed = 0;
+	m_OverBudget.clear();
+
+	//
+	// central directories are read in parallel, the items keep the order of the files
+	//
+	std::vector<std::vector<uint32_t>> entries(files.size());
+	std::vector<char> isPackage(files.size());
+	std::atomic<size_t> next{ 0 };
+	RunWorkers(GetThreadCount(files.size()), [&](size_t) {
+		ZipArchive archive;
+		for (auto i = next++; i < files.size(); i = next++) {
+			if (!m_Options.Packages || !ZipArchive::IsPackageExtension(std::filesystem::path(files[i]).extension().native()))
+				continue;
+
+			isPackage[i] = true;
+			if (!archive.Open(files[i])) {
+				m_Failed++;
+				continue;
+			}
+			auto& list = archive.GetEntries();
+			for (uint32_t e = 0; e < list.size(); e++) {
+				auto& entry = list[e];
+				if (entry.IsSupported() && entry.Size <= m_Options.MaxEntrySize && IsPEExtension(std::filesystem::path(entry.Name).extension().native()))
+					entries[i].push_back(e);
+			}
+		}
+	});
+
+	std::vector<WorkItem> items;
+	items.reserve(files.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		if (!isPackage[i])
+			items.push_back({ i, WorkItem::NoEntry });
+		for (auto e : entries[i])
+			items.push_back({ i, e });
+	}
+	return items;
+}
+
+bool BatchScanner::OpenEntry(PEFile& pe, PackageCursor& package, std::wstring const& path, uint32_t entry) const {
+	if (package.Path != path) {
+		package.Path.clear();
+		if (!package.Archive.Open(path))
+			return false;
+		package.Path = path;
+	}
+
+	auto& entries = package.Archive.GetEntries();
+	if (entry >= entries.size() || !package.Archive.Extract(entries[entry], package.Buffer, m_Options.MaxEntrySize))
+		return false;
+	return pe.Open(package.Buffer, path + L"|" + entries[entry].Name);
+}
+
+void BatchScanner::RunWorkers(size_t count, std::function<void(size_t worker)> const& worker) const {
+	std::vector<std::jthread> threads;
+	threads.reserve(count - 1);
+	for (size_t i = 1; i < count; i++)
+		threads.emplace_back(worker, i);
+	worker(0);
+}
+
+size_t BatchScanner::GetThreadCount(size_t items) const {
+	size_t count = m_Options.Threads ? m_Options.Threads : std::thread::hardware_concurrency();
+	return std::clamp<size_t>((std::min)(count, items), 1, 64);
+}
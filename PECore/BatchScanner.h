@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PEFile.h"
+#include "ZipArchive.h"
+#include "Watchdog.h"
+
+//
+// parses a set of files on worker threads. Every worker owns its state and its PEFile,
+// so nothing is shared while scanning; the per-worker states are merged once at the end.
+// Packages (ZIP based) are expanded to their PE entries, which are decompressed in memory
+// and spread over the workers like files.
+// A file may use up to MaxFileCpuTime of its worker's CPU time and ParseOptions.ullMaxAlloc bytes for its
+// tables; past either its parse stops, it's visited with what was parsed and listed as over budget.
+//
+class BatchScanner {
+public:
+	struct Options {
+		bool Recurse{ true };
+		bool Packages{ true };				// look inside .zip, .nupkg, .vsix, .appx, .msix
+		uint32_t Threads{ 0 };				// 0 - one per logical processor
+		uint64_t MaxEntrySize{ 256 << 20 };	// package entries above this are skipped
+		uint32_t MaxFileCpuTime{ 0 };		// msec to parse and visit a file, 0 - no limit
+		libpe::PEParseOptions ParseOptions;
+	};
+
+	BatchScanner() = default;
+	explicit BatchScanner(Options const& options);
+
+	//
+	// collects PE files and packages (by extension) under a directory, or the file itself
+	//
+	std::vector<std::wstring> EnumerateFiles(std::wstring const& path) const;
+
+	//
+	// same walk, keeping the files whose extension passes the filter
+	//
+	std::vector<std::wstring> EnumerateFiles(std::wstring const& path, std::function<bool(std::wstring_view ext)> const& filter) const;
+
+	//
+	// TState needs a Merge(TState const&) member; visit(TState&, PEFile const&) is called
+	// for every file that loads. Package entries have "package|entry" as their path.
+	//
+	template<typename TState, typename TVisit>
+	TState Scan(std::vector<std::wstring> const& files, TVisit&& visit) {
+		auto items = GetWorkItems(files);
+		auto count = GetThreadCount(items.size());
+		std::vector<TState> states(count);
+		std::atomic<size_t> next{ 0 };
+		std::unique_ptr<Watchdog> watchdog;
+		if (m_Options.MaxFileCpuTime)
+			watchdog = std::make_unique<Watchdog>(m_Options.MaxFileCpuTime, count);
+
+		RunWorkers(count, [&](size_t worker) {
+			PEFile pe;
+			auto options = m_Options.ParseOptions;
+			if (watchdog)
+				options.pfCancel = watchdog->GetCancelFlag(worker);
+			pe->SetParseOptions(options);
+			PackageCursor package;
+			for (auto i = next++; i < items.size(); i = next++) {
+				auto& item = items[i];
+				if (watchdog)
+					watchdog->Start(worker);
+				auto ok = item.Entry == WorkItem::NoEntry ? pe.Open(files[item.File]) : OpenEntry(pe, package, files[item.File], item.Entry);
+				if (ok)
+					visit(states[worker], pe);
+				auto cancelled = watchdog && watchdog->Stop(worker);
+				if (!ok) {
+					m_Failed++;
+					continue;
+				}
+				if (cancelled || pe->GetParseStatus() != libpe::PEOK)
+					AddOverBudget(pe.GetPath());
+				pe.Close();
+			}
+		});
+
+		for (size_t i = 1; i < count; i++)
+			states[0].Merge(states[i]);
+		return std::move(states[0]);
+	}
+
+	size_t GetFailedCount() const;
+	//
+	// files (package entries as "package|entry") that ran out of CPU time or memory, sorted
+	//
+	std::vector<std::wstring> GetOverBudget() const;
+
+	//
+	// splits a "package|entry" path; package is empty for plain files
+	//
+	static void SplitPath(std::wstring_view path, std::wstring_view& package, std::wstring_view& entry);
+
+private:
+	struct WorkItem {
+		static constexpr uint32_t NoEntry = UINT32_MAX;
+
+		size_t File;
+		uint32_t Entry;
+	};
+
+	//
+	// a worker's open package and the buffer its entries are inflated into, reused from entry to entry
+	//
+	struct PackageCursor {
+		std::wstring Path;
+		ZipArchive Archive;
+		std::vector<std::byte> Buffer;
+	};
+
+	std::vector<WorkItem> GetWorkItems(std::vector<std::wstring> const& files);
+	bool OpenEntry(PEFile& pe, PackageCursor& package, std::wstring const& path, uint32_t entry) const;
+	void RunWorkers(size_t count, std::function<void(size_t worker)> const& worker) const;
+	size_t GetThreadCount(size_t items) const;
+	void AddOverBudget(std::wstring const& path);
+
+	Options m_Options;
+	std::atomic<size_t> m_Failed{ 0 };
+	mutable std::mutex m_OverBudgetLock;
+	std::vector<std::wstring> m_OverBudget;
+};
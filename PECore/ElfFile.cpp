@@ -0,0 +1,537 @@
+#include "pch.h"
+#include "ElfFile.h"
+#include "SimdScan.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+	constexpr uint8_t ElfClass32 = 1;
+	constexpr uint8_t ElfClass64 = 2;
+	constexpr uint8_t ElfDataLsb = 1;
+	constexpr uint8_t ElfDataMsb = 2;
+
+	constexpr uint32_t PtLoad = 1;
+	constexpr uint32_t PtDynamic = 2;
+	constexpr uint32_t PtInterp = 3;
+	constexpr uint32_t ShtDynSym = 11;
+
+	constexpr int64_t DtNull = 0;
+	constexpr int64_t DtNeeded = 1;
+	constexpr int64_t DtHash = 4;
+	constexpr int64_t DtStrTab = 5;
+	constexpr int64_t DtSymTab = 6;
+	constexpr int64_t DtStrSz = 10;
+	constexpr int64_t DtSymEnt = 11;
+	constexpr int64_t DtSoName = 14;
+	constexpr int64_t DtRPath = 15;
+	constexpr int64_t DtRunPath = 29;
+	constexpr int64_t DtGnuHash = 0x6ffffef5;
+	constexpr int64_t DtVerSym = 0x6ffffff0;
+	constexpr int64_t DtFlags1 = 0x6ffffffb;
+	constexpr int64_t DtVerDef = 0x6ffffffc;
+	constexpr int64_t DtVerDefNum = 0x6ffffffd;
+	constexpr int64_t DtVerNeed = 0x6ffffffe;
+	constexpr int64_t DtVerNeedNum = 0x6fffffff;
+
+	constexpr uint64_t Df1NoDefLib = 0x800;
+	constexpr uint16_t VerFlagBase = 1;
+	constexpr uint16_t VerFlagWeak = 2;
+
+	constexpr uint8_t StbGlobal = 1;
+	constexpr uint8_t StbWeak = 2;
+	constexpr uint8_t StbGnuUnique = 10;
+	constexpr uint8_t SttSection = 3;
+	constexpr uint8_t SttFile = 4;
+
+	uint32_t GnuHash(std::string_view name) {
+		uint32_t h = 5381;
+		for (auto c : name)
+			h = h * 33 + static_cast<uint8_t>(c);
+		return h;
+	}
+
+	uint32_t SysvHash(std::string_view name) {
+		uint32_t h = 0;
+		for (auto c : name) {
+			h = (h << 4) + static_cast<uint8_t>(c);
+			auto g = h & 0xf0000000;
+			if (g)
+				h ^= g >> 24;
+			h &= ~g;
+		}
+		return h;
+	}
+}
+
+bool ElfFile::Symbol::IsGlobal() const {
+	return Bind == StbGlobal || Bind == StbWeak || Bind == StbGnuUnique;
+}
+
+bool ElfFile::Symbol::IsWeak() const {
+	return Bind == StbWeak;
+}
+
+bool ElfFile::IsElf(std::wstring const& path) {
+	MappedFile file;
+	if (!file.Open(path))
+		return false;
+	auto magic = file.GetData(0, 4);
+	return !magic.empty() && memcmp(magic.data(), "\x7f" "ELF", 4) == 0;
+}
+
+bool ElfFile::Open(std::wstring const& path) {
+	Close();
+	if (!m_File.Open(path) || !ParseHeader() || !ParseDynamic()) {
+		Close();
+		return false;
+	}
+	m_Path = path;
+	return true;
+}
+
+void ElfFile::Close() {
+	m_File.Close();
+	m_Path.clear();
+	m_Segments.clear();
+	m_StringTable = m_GnuHash = m_Hash = {};
+	m_Interpreter = m_SoName = m_RPath = m_RunPath = {};
+	m_Needed.clear();
+	m_Symbols.clear();
+	m_VersionNeeds.clear();
+	m_VersionDefinitions.clear();
+	m_Entry = m_PhOffset = m_ShOffset = 0;
+	m_PhCount = m_ShCount = m_PhSize = m_ShSize = 0;
+	m_Machine = m_Type = 0;
+	m_Is64 = m_Swap = m_HasVersions = m_NoDefaultLib = false;
+}
+
+bool ElfFile::IsLoaded() const {
+	return !m_Path.empty();
+}
+
+std::wstring const& ElfFile::GetPath() const {
+	return m_Path;
+}
+
+uint64_t ElfFile::GetFileSize() const {
+	return m_File.GetSize();
+}
+
+bool ElfFile::Is64() const {
+	return m_Is64;
+}
+
+uint16_t ElfFile::GetMachine() const {
+	return m_Machine;
+}
+
+uint16_t ElfFile::GetType() const {
+	return m_Type;
+}
+
+uint64_t ElfFile::GetEntryPoint() const {
+	return m_Entry;
+}
+
+uint64_t ElfFile::GetImageBase() const {
+	uint64_t base = UINT64_MAX;
+	for (auto& s : m_Segments)
+		base = (std::min)(base, s.Address);
+	return m_Segments.empty() ? 0 : base;
+}
+
+std::string_view ElfFile::GetInterpreter() const {
+	return m_Interpreter;
+}
+
+std::string_view ElfFile::GetSoName() const {
+	return m_SoName;
+}
+
+std::string_view ElfFile::GetRPath() const {
+	return m_RPath;
+}
+
+std::string_view ElfFile::GetRunPath() const {
+	return m_RunPath;
+}
+
+std::vector<std::string_view> const& ElfFile::GetNeeded() const {
+	return m_Needed;
+}
+
+bool ElfFile::IsNoDefaultLib() const {
+	return m_NoDefaultLib;
+}
+
+std::span<const ElfFile::Symbol> ElfFile::GetSymbols() const {
+	if (m_Symbols.empty())
+		return {};
+	return std::span(m_Symbols).subspan(1);
+}
+
+std::vector<ElfFile::VersionNeed> const& ElfFile::GetVersionNeeds() const {
+	return m_VersionNeeds;
+}
+
+std::vector<std::string_view> const& ElfFile::GetVersionDefinitions() const {
+	return m_VersionDefinitions;
+}
+
+template<typename T>
+T ElfFile::Get(const std::byte* p) const {
+	T value;
+	memcpy(&value, p, sizeof(T));
+	if (m_Swap) {
+		auto bytes = reinterpret_cast<std::byte*>(&value);
+		std::reverse(bytes, bytes + sizeof(T));
+	}
+	return value;
+}
+
+uint64_t ElfFile::GetAddress(const std::byte* p) const {
+	return m_Is64 ? Get<uint64_t>(p) : Get<uint32_t>(p);
+}
+
+bool ElfFile::ParseHeader() {
+	auto ident = m_File.GetData(0, 16);
+	if (ident.empty() || memcmp(ident.data(), "\x7f" "ELF", 4) != 0)
+		return false;
+
+	auto elfClass = static_cast<uint8_t>(ident[4]);
+	auto data = static_cast<uint8_t>(ident[5]);
+	if ((elfClass != ElfClass32 && elfClass != ElfClass64) || (data != ElfDataLsb && data != ElfDataMsb))
+		return false;
+
+	m_Is64 = elfClass == ElfClass64;
+	m_Swap = (data == ElfDataMsb) != (std::endian::native == std::endian::big);
+	auto header = m_File.GetData(0, m_Is64 ? 64 : 52);
+	if (header.empty())
+		return false;
+
+	auto p = header.data();
+	m_Type = Get<uint16_t>(p + 16);
+	m_Machine = Get<uint16_t>(p + 18);
+	m_Entry = GetAddress(p + 24);
+	m_PhOffset = GetAddress(p + (m_Is64 ? 32 : 28));
+	m_ShOffset = GetAddress(p + (m_Is64 ? 40 : 32));
+	auto sizes = p + (m_Is64 ? 54 : 42);
+	m_PhSize = Get<uint16_t>(sizes);
+	m_PhCount = Get<uint16_t>(sizes + 2);
+	m_ShSize = Get<uint16_t>(sizes + 4);
+	m_ShCount = Get<uint16_t>(sizes + 6);
+	return m_PhCount == 0 || m_PhSize >= (m_Is64 ? 56 : 32);
+}
+
+bool ElfFile::ParseDynamic() {
+	auto headers = m_File.GetData(m_PhOffset, uint64_t(m_PhCount) * m_PhSize);
+	if (headers.empty() && m_PhCount)
+		return false;
+
+	std::span<const std::byte> dynamic;
+	for (uint16_t i = 0; i < m_PhCount; i++) {
+		auto p = headers.data() + size_t(i) * m_PhSize;
+		auto type = Get<uint32_t>(p);
+		auto offset = GetAddress(p + (m_Is64 ? 8 : 4));
+		auto address = GetAddress(p + (m_Is64 ? 16 : 8));
+		auto fileSize = GetAddress(p + (m_Is64 ? 32 : 16));
+		if (type == PtLoad)
+			m_Segments.push_back({ address, offset, fileSize });
+		else if (type == PtDynamic)
+			dynamic = m_File.GetData(offset, fileSize);
+		else if (type == PtInterp) {
+			auto interp = m_File.GetData(offset, fileSize);
+			auto chars = reinterpret_cast<const char*>(interp.data());
+			m_Interpreter = std::string_view(chars, SimdScan::StrNLen(chars, interp.size()));
+		}
+	}
+
+	//
+	// string table entries are offsets and the table may come after them, so they are resolved at the end
+	//
+	uint64_t strTab = 0, strSize = 0, symTab = 0, symEnt = 0, hash = 0, gnuHash = 0;
+	uint64_t soName = UINT64_MAX, rpath = UINT64_MAX, runpath = UINT64_MAX;
+	uint64_t versym = 0, verneed = 0, verneedCount = 0, verdef = 0, verdefCount = 0;
+	std::vector<uint64_t> needed;
+	auto entrySize = m_Is64 ? 16 : 8;
+	for (size_t pos = 0; pos + entrySize <= dynamic.size(); pos += entrySize) {
+		auto p = dynamic.data() + pos;
+		auto tag = m_Is64 ? Get<int64_t>(p) : Get<int32_t>(p);
+		auto value = GetAddress(p + entrySize / 2);
+		if (tag == DtNull)
+			break;
+		switch (tag) {
+			case DtNeeded: needed.push_back(value); break;
+			case DtHash: hash = value; break;
+			case DtStrTab: strTab = value; break;
+			case DtSymTab: symTab = value; break;
+			case DtStrSz: strSize = value; break;
+			case DtSymEnt: symEnt = value; break;
+			case DtSoName: soName = value; break;
+			case DtRPath: rpath = value; break;
+			case DtRunPath: runpath = value; break;
+			case DtGnuHash: gnuHash = value; break;
+			case DtVerSym: versym = value; break;
+			case DtFlags1: m_NoDefaultLib = (value & Df1NoDefLib) != 0; break;
+			case DtVerDef: verdef = value; break;
+			case DtVerDefNum: verdefCount = value; break;
+			case DtVerNeed: verneed = value; break;
+			case DtVerNeedNum: verneedCount = value; break;
+		}
+	}
+
+	if (strTab == 0)
+		return true;		// static executable, or no dynamic section at all
+
+	m_StringTable = GetRange(strTab, strSize);
+	for (auto offset : needed)
+		if (auto name = GetString(offset); !name.empty())
+			m_Needed.push_back(name);
+	if (soName != UINT64_MAX)
+		m_SoName = GetString(soName);
+	if (rpath != UINT64_MAX)
+		m_RPath = GetString(rpath);
+	if (runpath != UINT64_MAX)
+		m_RunPath = GetString(runpath);
+
+	if (gnuHash)
+		m_GnuHash = GetRange(gnuHash);
+	if (hash)
+		m_Hash = GetRange(hash);
+
+	auto symbolSize = symEnt ? symEnt : (m_Is64 ? 24 : 16);
+	auto symbols = symTab ? GetRange(symTab) : std::span<const std::byte>();
+	if (symbolSize < (m_Is64 ? 24u : 16u) || symbols.empty())
+		return true;
+
+	auto count = (std::min)(uint64_t(GetSymbolCount()), symbols.size() / symbolSize);
+	m_Symbols.reserve(count);
+	for (uint32_t i = 0; i < count; i++) {
+		auto p = symbols.data() + i * symbolSize;
+		Symbol symbol{};
+		symbol.Name = GetString(Get<uint32_t>(p));
+		uint8_t info;
+		uint16_t section;
+		if (m_Is64) {
+			info = static_cast<uint8_t>(p[4]);
+			section = Get<uint16_t>(p + 6);
+			symbol.Value = Get<uint64_t>(p + 8);
+			symbol.Size = Get<uint64_t>(p + 16);
+		}
+		else {
+			symbol.Value = Get<uint32_t>(p + 4);
+			symbol.Size = Get<uint32_t>(p + 8);
+			info = static_cast<uint8_t>(p[12]);
+			section = Get<uint16_t>(p + 14);
+		}
+		symbol.Index = i;
+		symbol.Type = info & 0xf;
+		symbol.Bind = info >> 4;
+		symbol.Defined = section != 0;
+		m_Symbols.push_back(symbol);
+	}
+
+	ParseVersions(versym, verneed, verneedCount, verdef, verdefCount);
+	return true;
+}
+
+void ElfFile::ParseVersions(uint64_t versym, uint64_t verneed, uint64_t verneedCount, uint64_t verdef, uint64_t verdefCount) {
+	auto versions = versym ? GetRange(versym, m_Symbols.size() * 2) : std::span<const std::byte>();
+	if (versions.empty())
+		return;
+
+	//
+	// version indexes are shared by the definitions and the needs; 0 and 1 are local and global (unversioned)
+	//
+	std::vector<std::string_view> names;
+	auto setName = [&](uint16_t index, std::string_view name) {
+		index &= 0x7fff;
+		if (index >= names.size())
+			names.resize(index + 1);
+		names[index] = name;
+	};
+
+	if (auto data = verneed ? GetRange(verneed) : std::span<const std::byte>(); !data.empty()) {
+		size_t pos = 0;
+		for (uint64_t i = 0; i < verneedCount && pos + 16 <= data.size(); i++) {
+			auto p = data.data() + pos;
+			auto file = GetString(Get<uint32_t>(p + 4));
+			auto aux = pos + Get<uint32_t>(p + 8);
+			for (uint16_t j = 0, count = Get<uint16_t>(p + 2); j < count && aux + 16 <= data.size(); j++) {
+				auto a = data.data() + aux;
+				auto name = GetString(Get<uint32_t>(a + 8));
+				m_VersionNeeds.push_back({ file, name, (Get<uint16_t>(a + 4) & VerFlagWeak) != 0 });
+				setName(Get<uint16_t>(a + 6), name);
+				auto next = Get<uint32_t>(a + 12);
+				if (next == 0)
+					break;
+				aux += next;
+			}
+			auto next = Get<uint32_t>(p + 12);
+			if (next == 0)
+				break;
+			pos += next;
+		}
+	}
+
+	if (auto data = verdef ? GetRange(verdef) : std::span<const std::byte>(); !data.empty()) {
+		size_t pos = 0;
+		for (uint64_t i = 0; i < verdefCount && pos + 20 <= data.size(); i++) {
+			auto p = data.data() + pos;
+			auto aux = pos + Get<uint32_t>(p + 12);
+			if (Get<uint16_t>(p + 6) && aux + 8 <= data.size()) {
+				auto name = GetString(Get<uint32_t>(data.data() + aux));
+				setName(Get<uint16_t>(p + 4), name);
+				if ((Get<uint16_t>(p + 2) & VerFlagBase) == 0)
+					m_VersionDefinitions.push_back(name);
+			}
+			auto next = Get<uint32_t>(p + 16);
+			if (next == 0)
+				break;
+			pos += next;
+		}
+	}
+
+	m_HasVersions = true;
+	for (auto& symbol : m_Symbols) {
+		auto version = Get<uint16_t>(versions.data() + symbol.Index * 2);
+		auto index = version & 0x7fff;
+		if (index >= 2 && index < names.size())
+			symbol.Version = names[index];
+		symbol.HiddenVersion = symbol.Defined && (version & 0x8000) != 0;
+	}
+}
+
+std::span<const std::byte> ElfFile::GetRange(uint64_t address) const {
+	for (auto& s : m_Segments)
+		if (address >= s.Address && address - s.Address < s.FileSize)
+			return m_File.GetData(s.Offset + (address - s.Address), s.FileSize - (address - s.Address));
+	return {};
+}
+
+std::span<const std::byte> ElfFile::GetRange(uint64_t address, uint64_t size) const {
+	auto range = GetRange(address);
+	return size <= range.size() ? range.first(static_cast<size_t>(size)) : std::span<const std::byte>();
+}
+
+std::string_view ElfFile::GetString(uint64_t offset) const {
+	if (offset >= m_StringTable.size())
+		return {};
+	auto chars = reinterpret_cast<const char*>(m_StringTable.data() + offset);
+	auto maxLength = m_StringTable.size() - static_cast<size_t>(offset);
+	auto length = SimdScan::StrNLen(chars, maxLength);
+	return length == maxLength ? std::string_view() : std::string_view(chars, length);
+}
+
+uint32_t ElfFile::GetSymbolCount() const {
+	//
+	// the GNU table has no count: it is one past the last chain entry of the highest bucket
+	//
+	if (m_GnuHash.size() >= 16) {
+		auto p = m_GnuHash.data();
+		auto buckets = Get<uint32_t>(p);
+		auto offset = Get<uint32_t>(p + 4);
+		auto bucketsStart = 16 + uint64_t(Get<uint32_t>(p + 8)) * (m_Is64 ? 8 : 4);
+		auto chainStart = bucketsStart + uint64_t(buckets) * 4;
+		if (chainStart <= m_GnuHash.size()) {
+			uint32_t last = 0;
+			for (uint32_t i = 0; i < buckets; i++)
+				last = (std::max)(last, Get<uint32_t>(p + bucketsStart + i * 4));
+			if (last < offset)
+				return offset;
+			for (auto pos = chainStart + uint64_t(last - offset) * 4; pos + 4 <= m_GnuHash.size(); pos += 4, last++)
+				if (Get<uint32_t>(p + pos) & 1)
+					return last + 1;
+		}
+	}
+	if (m_Hash.size() >= 8)
+		return Get<uint32_t>(m_Hash.data() + 4);
+
+	//
+	// neither hash table: the .dynsym section header, if the section headers weren't stripped
+	//
+	auto sections = m_File.GetData(m_ShOffset, uint64_t(m_ShCount) * m_ShSize);
+	if (sections.empty() || m_ShSize < (m_Is64 ? 64 : 40))
+		return 0;
+	for (uint16_t i = 0; i < m_ShCount; i++) {
+		auto p = sections.data() + size_t(i) * m_ShSize;
+		if (Get<uint32_t>(p + 4) != ShtDynSym)
+			continue;
+		auto size = GetAddress(p + (m_Is64 ? 32 : 20));
+		auto entrySize = GetAddress(p + (m_Is64 ? 56 : 36));
+		return entrySize ? static_cast<uint32_t>((std::min)(size / entrySize, uint64_t(UINT32_MAX))) : 0;
+	}
+	return 0;
+}
+
+bool ElfFile::Matches(Symbol const& symbol, std::string_view name, std::string_view version) const {
+	if (!symbol.Defined || !symbol.IsGlobal() || symbol.Type == SttSection || symbol.Type == SttFile || symbol.Name != name)
+		return false;
+	if (version.empty())
+		return !symbol.HiddenVersion;
+	return symbol.Version.empty() || symbol.Version == version;
+}
+
+ElfFile::Symbol const* ElfFile::FindExport(std::string_view name, std::string_view version) const {
+	if (m_GnuHash.size() >= 16) {
+		auto p = m_GnuHash.data();
+		auto buckets = Get<uint32_t>(p);
+		auto offset = Get<uint32_t>(p + 4);
+		auto bloomSize = Get<uint32_t>(p + 8);
+		auto shift = Get<uint32_t>(p + 12);
+		auto wordSize = m_Is64 ? 8u : 4u;
+		auto bits = wordSize * 8;
+		auto bucketsStart = 16 + uint64_t(bloomSize) * wordSize;
+		auto chainStart = bucketsStart + uint64_t(buckets) * 4;
+		if (buckets == 0 || bloomSize == 0 || chainStart > m_GnuHash.size())
+			return nullptr;
+
+		//
+		// two bits of the hash in one bloom word reject most names without touching the buckets
+		//
+		auto h = GnuHash(name);
+		auto word = GetAddress(p + 16 + uint64_t((h / bits) % bloomSize) * wordSize);
+		auto mask = (uint64_t(1) << (h % bits)) | (uint64_t(1) << ((h >> shift) % bits));
+		if ((word & mask) != mask)
+			return nullptr;
+
+		auto index = Get<uint32_t>(p + bucketsStart + uint64_t(h % buckets) * 4);
+		if (index < offset)
+			return nullptr;
+		for (; index < m_Symbols.size(); index++) {
+			auto pos = chainStart + uint64_t(index - offset) * 4;
+			if (pos + 4 > m_GnuHash.size())
+				break;
+			auto chain = Get<uint32_t>(p + pos);
+			if ((chain | 1) == (h | 1) && Matches(m_Symbols[index], name, version))
+				return &m_Symbols[index];
+			if (chain & 1)
+				break;
+		}
+		return nullptr;
+	}
+
+	if (m_Hash.size() >= 8) {
+		auto p = m_Hash.data();
+		auto buckets = Get<uint32_t>(p);
+		auto chains = Get<uint32_t>(p + 4);
+		if (buckets == 0 || 8 + (uint64_t(buckets) + chains) * 4 > m_Hash.size())
+			return nullptr;
+
+		auto chainStart = 8 + uint64_t(buckets) * 4;
+		uint32_t steps = 0;
+		for (auto index = Get<uint32_t>(p + 8 + uint64_t(SysvHash(name) % buckets) * 4);
+			index != 0 && index < chains && index < m_Symbols.size() && steps++ < chains;
+			index = Get<uint32_t>(p + chainStart + uint64_t(index) * 4)) {
+			if (Matches(m_Symbols[index], name, version))
+				return &m_Symbols[index];
+		}
+		return nullptr;
+	}
+
+	for (auto& symbol : GetSymbols())
+		if (Matches(symbol, name, version))
+			return &symbol;
+	return nullptr;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+//
+// dynamic linking view of an ELF executable or shared object, 32 or 64 bit, either byte order:
+// the program headers, what PT_DYNAMIC tells the loader (DT_NEEDED, DT_RPATH, DT_RUNPATH, DT_SONAME)
+// and .dynsym with its symbol versions. Section headers are only a last resort for the symbol count.
+// Names point into the mapping, which stays open until Close.
+//
+class ElfFile {
+public:
+	static constexpr uint16_t MachineX86 = 3;
+	static constexpr uint16_t MachineArm = 40;
+	static constexpr uint16_t MachineX64 = 62;
+	static constexpr uint16_t MachineArm64 = 183;
+
+	struct Symbol {
+		std::string_view Name;
+		std::string_view Version;		// required version if undefined, defined version otherwise
+		uint64_t Value;
+		uint64_t Size;
+		uint32_t Index;					// in .dynsym
+		uint8_t Type;					// STT_*
+		uint8_t Bind;					// STB_*
+		bool Defined : 1;
+		bool HiddenVersion : 1;			// name@VER only, not the default name@@VER
+
+		bool IsGlobal() const;			// global, weak or unique
+		bool IsWeak() const;
+	};
+
+	struct VersionNeed {
+		std::string_view File;			// as spelled in DT_NEEDED
+		std::string_view Version;
+		bool Weak;
+	};
+
+	//
+	// checks the ELF magic only
+	//
+	static bool IsElf(std::wstring const& path);
+
+	ElfFile() = default;
+	ElfFile(ElfFile const&) = delete;
+	ElfFile& operator=(ElfFile const&) = delete;
+
+	bool Open(std::wstring const& path);
+	void Close();
+	bool IsLoaded() const;
+
+	std::wstring const& GetPath() const;
+	uint64_t GetFileSize() const;
+	bool Is64() const;
+	uint16_t GetMachine() const;
+	uint16_t GetType() const;			// ET_EXEC, ET_DYN, ...
+	uint64_t GetEntryPoint() const;
+	uint64_t GetImageBase() const;		// lowest PT_LOAD address
+
+	std::string_view GetInterpreter() const;
+	std::string_view GetSoName() const;
+	std::string_view GetRPath() const;
+	std::string_view GetRunPath() const;
+	std::vector<std::string_view> const& GetNeeded() const;
+	bool IsNoDefaultLib() const;		// DF_1_NODEFLIB: the default directories are not searched
+
+	//
+	// .dynsym without the null symbol at index 0
+	//
+	std::span<const Symbol> GetSymbols() const;
+	std::vector<VersionNeed> const& GetVersionNeeds() const;
+	std::vector<std::string_view> const& GetVersionDefinitions() const;	// the base (soname) version excluded
+
+	//
+	// a defined global symbol through the GNU hash table if there is one, the SysV one otherwise.
+	// An empty version takes the default definition; definitions without version information
+	// satisfy any version.
+	//
+	Symbol const* FindExport(std::string_view name, std::string_view version = {}) const;
+
+private:
+	template<typename T>
+	T Get(const std::byte* p) const;
+	uint64_t GetAddress(const std::byte* p) const;		// 4 or 8 bytes by class
+
+	bool ParseHeader();
+	bool ParseDynamic();
+	void ParseVersions(uint64_t versym, uint64_t verneed, uint64_t verneedCount, uint64_t verdef, uint64_t verdefCount);
+	std::span<const std::byte> GetRange(uint64_t address) const;		// to the end of the segment's file data
+	std::span<const std::byte> GetRange(uint64_t address, uint64_t size) const;
+	std::string_view GetString(uint64_t offset) const;
+	uint32_t GetSymbolCount() const;
+	bool Matches(Symbol const& symbol, std::string_view name, std::string_view version) const;
+
+	struct Segment {
+		uint64_t Address;
+		uint64_t Offset;
+		uint64_t FileSize;
+	};
+
+	MappedFile m_File;
+	std::wstring m_Path;
+	std::vector<Segment> m_Segments;
+	std::span<const std::byte> m_StringTable;
+	std::span<const std::byte> m_GnuHash;
+	std::span<const std::byte> m_Hash;
+	std::string_view m_Interpreter, m_SoName, m_RPath, m_RunPath;
+	std::vector<std::string_view> m_Needed;
+	std::vector<Symbol> m_Symbols;			// .dynsym, index 0 included
+	std::vector<VersionNeed> m_VersionNeeds;
+	std::vector<std::string_view> m_VersionDefinitions;
+	uint64_t m_Entry{ 0 };
+	uint64_t m_PhOffset{ 0 }, m_ShOffset{ 0 };
+	uint16_t m_PhCount{ 0 }, m_ShCount{ 0 }, m_PhSize{ 0 }, m_ShSize{ 0 };
+	uint16_t m_Machine{ 0 };
+	uint16_t m_Type{ 0 };
+	bool m_Is64{ false };
+	bool m_Swap{ false };
+	bool m_HasVersions{ false };
+	bool m_NoDefaultLib{ false };
+};
@@ -0,0 +1,357 @@
+#include "pch.h"
+#include "ElfLoader.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace {
+	fs::path FromUtf8(std::string_view text) {
+		return fs::path(std::u8string(reinterpret_cast<const char8_t*>(text.data()), text.size()));
+	}
+
+	std::string ToUtf8(fs::path const& path) {
+		auto text = path.u8string();
+		return std::string(reinterpret_cast<const char*>(text.data()), text.size());
+	}
+
+	std::string_view Trim(std::string_view text) {
+		auto start = text.find_first_not_of(" \t\r");
+		if (start == std::string_view::npos)
+			return {};
+		return text.substr(start, text.find_last_not_of(" \t\r") - start + 1);
+	}
+
+	//
+	// glob with '*' and '?' for ld.so.conf include lines
+	//
+	bool WildcardMatch(std::string_view pattern, std::string_view text) {
+		size_t p = 0, t = 0, star = std::string_view::npos, mark = 0;
+		while (t < text.size()) {
+			if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+				p++;
+				t++;
+			}
+			else if (p < pattern.size() && pattern[p] == '*') {
+				star = p++;
+				mark = t;
+			}
+			else if (star != std::string_view::npos) {
+				p = star + 1;
+				t = ++mark;
+			}
+			else
+				return false;
+		}
+		while (p < pattern.size() && pattern[p] == '*')
+			p++;
+		return p == pattern.size();
+	}
+
+	std::string_view GetPlatform(uint16_t machine) {
+		switch (machine) {
+			case ElfFile::MachineX86: return "i686";
+			case ElfFile::MachineX64: return "x86_64";
+			case ElfFile::MachineArm: return "v7l";
+			case ElfFile::MachineArm64: return "aarch64";
+		}
+		return "";
+	}
+}
+
+ElfLoader::ElfLoader(Options const& options) : m_Options(options) {
+}
+
+bool ElfLoader::Load(std::wstring const& path) {
+	m_Modules.clear();
+	m_Problems.clear();
+	m_ByName.clear();
+	m_ByPath.clear();
+
+	auto root = Open(path);
+	if (root == nullptr)
+		return false;
+
+	Module program;
+	program.Name = ToUtf8(fs::path(path).filename());
+	program.Path = root->GetPath();
+	program.File = root;
+	m_ByPath.insert({ program.Path, 0 });
+	if (!root->GetSoName().empty())
+		m_ByName.insert({ std::string(root->GetSoName()), 0 });
+	m_Modules.push_back(std::move(program));
+
+	//
+	// breadth first, like ld.so: a module's DT_NEEDED entries are all mapped before theirs
+	//
+	for (size_t i = 0; i < m_Modules.size(); i++) {
+		auto file = m_Modules[i].File;
+		if (file == nullptr)
+			continue;
+		for (auto name : file->GetNeeded()) {
+			auto index = Find(name, i);
+			m_Modules[i].Needed.push_back(index);
+		}
+	}
+
+	Bind();
+	return true;
+}
+
+std::vector<ElfLoader::Module> const& ElfLoader::GetModules() const {
+	return m_Modules;
+}
+
+std::vector<ElfLoader::Problem> const& ElfLoader::GetProblems() const {
+	return m_Problems;
+}
+
+size_t ElfLoader::GetParsedCount() const {
+	return std::ranges::count_if(m_Cache, [](auto& entry) { return entry.second != nullptr; });
+}
+
+std::wstring ElfLoader::GuessSysRoot(std::wstring const& path) {
+	static const std::wstring_view tops[] = { L"usr", L"lib", L"lib32", L"lib64", L"bin", L"sbin", L"opt" };
+
+	fs::path file(path);
+	auto prefix = file.root_path();
+	for (auto& part : file.relative_path()) {
+		if (std::ranges::find(tops, part.wstring()) != std::end(tops))
+			return prefix.wstring();
+		prefix /= part;
+	}
+	std::error_code ec;
+	return fs::is_directory(file, ec) ? path : file.parent_path().wstring();
+}
+
+PCWSTR ElfLoader::ProblemKindToString(ProblemKind kind) {
+	switch (kind) {
+		case ProblemKind::MissingLibrary: return L"Missing library";
+		case ProblemKind::MissingSymbol: return L"Missing symbol";
+		case ProblemKind::MissingVersion: return L"Missing version";
+	}
+	return L"";
+}
+
+std::shared_ptr<const ElfFile> ElfLoader::Open(fs::path const& path) {
+	auto key = path.lexically_normal().wstring();
+	if (auto it = m_Cache.find(key); it != m_Cache.end())
+		return it->second;
+
+	std::error_code ec;
+	std::shared_ptr<ElfFile> file;
+	if (fs::is_regular_file(path, ec)) {
+		file = std::make_shared<ElfFile>();
+		if (!file->Open(key))
+			file.reset();
+	}
+	m_Cache.insert({ key, file });
+	return file;
+}
+
+bool ElfLoader::IsCompatible(ElfFile const& file) const {
+	auto& program = *m_Modules[0].File;
+	return file.Is64() == program.Is64() && file.GetMachine() == program.GetMachine();
+}
+
+size_t ElfLoader::Find(std::string_view name, size_t requester) {
+	if (auto it = m_ByName.find(std::string(name)); it != m_ByName.end())
+		return it->second;
+
+	//
+	// a library found under another name (a symlink, or a soname differing from the file name) is loaded once
+	//
+	auto path = Search(name, requester);
+	if (!path.empty()) {
+		if (auto it = m_ByPath.find(path); it != m_ByPath.end()) {
+			m_ByName.insert({ std::string(name), it->second });
+			return it->second;
+		}
+	}
+
+	auto index = m_Modules.size();
+	Module m;
+	m.Name = name;
+	m.Path = path;
+	m.Loader = requester;
+	if (!path.empty()) {
+		m.File = Open(path);
+		m_ByPath.insert({ path, index });
+		if (auto soname = m.File->GetSoName(); !soname.empty())
+			m_ByName.insert({ std::string(soname), index });
+	}
+	else
+		m_Problems.push_back({ ProblemKind::MissingLibrary, requester, m.Name });
+	m_ByName.insert({ m.Name, index });
+	m_Modules.push_back(std::move(m));
+	return index;
+}
+
+std::wstring ElfLoader::Search(std::string_view name, size_t requester) {
+	auto& file = *m_Modules[requester].File;
+	auto candidate = [&](fs::path const& path) -> std::wstring {
+		auto elf = Open(path);
+		return elf && IsCompatible(*elf) ? elf->GetPath() : std::wstring();
+	};
+
+	if (name.find('/') != std::string_view::npos) {
+		auto path = FromUtf8(name);
+		return candidate(path.is_absolute() ? MapPath(name) : fs::path(file.GetPath()).parent_path() / path);
+	}
+
+	std::vector<fs::path> dirs;
+	if (file.GetRunPath().empty()) {
+		for (auto l = requester; l != NoModule; l = m_Modules[l].Loader)
+			AddDirs(dirs, m_Modules[l].File->GetRPath(), l);
+	}
+	for (auto& dir : m_Options.LibraryPath)
+		dirs.push_back(MapPath(dir));
+	AddDirs(dirs, file.GetRunPath(), requester);
+
+	if (!file.IsNoDefaultLib()) {
+		if (m_Options.UseLdSoConf && !m_ConfigRead) {
+			m_ConfigRead = true;
+			ReadConfig(MapPath("/etc/ld.so.conf"), 0);
+		}
+		dirs.insert(dirs.end(), m_ConfigDirs.begin(), m_ConfigDirs.end());
+
+		//
+		// the 64 bit lib directories of the RPM world, then the plain ones for everybody else
+		//
+		if (m_Modules[0].File->Is64()) {
+			dirs.push_back(MapPath("/lib64"));
+			dirs.push_back(MapPath("/usr/lib64"));
+		}
+		dirs.push_back(MapPath("/lib"));
+		dirs.push_back(MapPath("/usr/lib"));
+	}
+	for (auto& dir : m_Options.ExtraDirs)
+		dirs.push_back(dir);
+
+	auto fileName = FromUtf8(name);
+	for (auto& dir : dirs)
+		if (auto path = candidate(dir / fileName); !path.empty())
+			return path;
+	return L"";
+}
+
+void ElfLoader::AddDirs(std::vector<fs::path>& dirs, std::string_view list, size_t owner) const {
+	auto& file = *m_Modules[owner].File;
+	while (!list.empty()) {
+		auto colon = list.find(':');
+		auto dir = list.substr(0, colon);
+		list = colon == std::string_view::npos ? std::string_view() : list.substr(colon + 1);
+		if (dir.empty())
+			continue;
+
+		//
+		// $ORIGIN is the directory of the object itself, already a host path
+		//
+		std::string_view origin;
+		if (dir.starts_with("$ORIGIN"))
+			origin = "$ORIGIN";
+		else if (dir.starts_with("${ORIGIN}"))
+			origin = "${ORIGIN}";
+		if (!origin.empty()) {
+			auto rest = dir.substr(origin.size());
+			while (rest.starts_with('/'))
+				rest.remove_prefix(1);
+			dirs.push_back((fs::path(file.GetPath()).parent_path() / FromUtf8(rest)).lexically_normal());
+			continue;
+		}
+
+		std::string expanded(dir);
+		auto replace = [&](std::string_view token, std::string_view value) {
+			for (auto pos = expanded.find(token); pos != std::string::npos; pos = expanded.find(token, pos + value.size()))
+				expanded.replace(pos, token.size(), value);
+		};
+		auto lib = file.Is64() ? "lib64" : "lib";
+		replace("${LIB}", lib);
+		replace("$LIB", lib);
+		replace("${PLATFORM}", GetPlatform(file.GetMachine()));
+		replace("$PLATFORM", GetPlatform(file.GetMachine()));
+		dirs.push_back(MapPath(expanded));
+	}
+}
+
+fs::path ElfLoader::MapPath(std::string_view path) const {
+	return (fs::path(m_Options.SysRoot) / FromUtf8(path).relative_path()).lexically_normal();
+}
+
+void ElfLoader::ReadConfig(fs::path const& path, int depth) {
+	MappedFile file;
+	if (depth > 8 || !file.Open(path.wstring()))
+		return;
+
+	auto data = file.GetData();
+	std::string_view text(reinterpret_cast<const char*>(data.data()), data.size());
+	while (!text.empty()) {
+		auto eol = text.find('\n');
+		auto line = text.substr(0, eol);
+		text = eol == std::string_view::npos ? std::string_view() : text.substr(eol + 1);
+		line = Trim(line.substr(0, line.find('#')));
+		if (line.empty() || line.starts_with("hwcap "))
+			continue;
+
+		if (line.starts_with("include") && line.size() > 7 && (line[7] == ' ' || line[7] == '\t')) {
+			//
+			// relative patterns are relative to the including file, matches are read in sorted order
+			//
+			auto pattern = Trim(line.substr(8));
+			auto target = FromUtf8(pattern);
+			auto dir = target.is_absolute() ? MapPath(ToUtf8(target.parent_path())) : path.parent_path() / target.parent_path();
+			auto filePattern = ToUtf8(target.filename());
+			std::vector<fs::path> matches;
+			std::error_code ec;
+			for (auto it = fs::directory_iterator(dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec))
+				if (WildcardMatch(filePattern, ToUtf8(it->path().filename())))
+					matches.push_back(it->path());
+			std::ranges::sort(matches);
+			for (auto& match : matches)
+				ReadConfig(match, depth + 1);
+			continue;
+		}
+
+		// old syntax allows "dir=type" and commas
+		auto dir = line.substr(0, line.find_first_of("=,"));
+		if (!dir.empty() && dir[0] == '/')
+			m_ConfigDirs.push_back(MapPath(Trim(dir)));
+	}
+}
+
+void ElfLoader::Bind() {
+	//
+	// every undefined symbol binds to the first module of the global scope that defines it, the program included
+	//
+	for (size_t i = 0; i < m_Modules.size(); i++) {
+		auto& m = m_Modules[i];
+		if (m.File == nullptr)
+			continue;
+
+		auto symbols = m.File->GetSymbols();
+		m.Bindings.assign(symbols.size() + 1, NoModule);
+		for (auto& symbol : symbols) {
+			if (symbol.Defined || !symbol.IsGlobal() || symbol.Name.empty())
+				continue;
+			for (size_t s = 0; s < m_Modules.size(); s++) {
+				if (s != i && m_Modules[s].File && m_Modules[s].File->FindExport(symbol.Name, symbol.Version)) {
+					m.Bindings[symbol.Index] = s;
+					break;
+				}
+			}
+			if (m.Bindings[symbol.Index] == NoModule && !symbol.IsWeak())
+				m_Problems.push_back({ ProblemKind::MissingSymbol, i, std::string(symbol.Name), std::string(symbol.Version) });
+		}
+
+		//
+		// versions named by DT_VERNEED have to be defined by that library, or ld.so refuses to start
+		//
+		for (auto& need : m.File->GetVersionNeeds()) {
+			auto it = m_ByName.find(std::string(need.File));
+			if (need.Weak || it == m_ByName.end() || m_Modules[it->second].File == nullptr)
+				continue;
+			auto& definitions = m_Modules[it->second].File->GetVersionDefinitions();
+			if (!definitions.empty() && std::ranges::find(definitions, need.Version) == definitions.end())
+				m_Problems.push_back({ ProblemKind::MissingVersion, i, std::string(need.File), std::string(need.Version) });
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ElfFile.h"
+
+//
+// loads an ELF program's shared library closure the way ld.so does, against a copy of the target's
+// file system under SysRoot. DT_NEEDED names are searched in DT_RPATH of the object and its loaders
+// (unless the object has DT_RUNPATH), LD_LIBRARY_PATH, DT_RUNPATH, the directories listed in
+// /etc/ld.so.conf (standing in for ld.so.cache) and the default directories, skipping files of another
+// class or machine. Modules are loaded breadth first, which is also the order undefined symbols are
+// looked up in. Parsed files are cached by path across Load calls, so closures sharing libraries
+// parse them once.
+//
+class ElfLoader {
+public:
+	static constexpr size_t NoModule = SIZE_MAX;
+
+	struct Options {
+		std::wstring SysRoot;					// host directory that stands for the target's "/"
+		std::vector<std::string> LibraryPath;	// LD_LIBRARY_PATH, target paths
+		std::vector<std::wstring> ExtraDirs;	// host directories searched last, not something ld.so does
+		bool UseLdSoConf{ true };
+	};
+
+	struct Module {
+		std::string Name;						// the DT_NEEDED string, the file name for the program
+		std::wstring Path;						// empty if not found
+		std::shared_ptr<const ElfFile> File;
+		size_t Loader{ NoModule };				// the module whose DT_NEEDED brought it in
+		std::vector<size_t> Needed;				// one per DT_NEEDED entry, in order
+		std::vector<size_t> Bindings;			// by .dynsym index: module defining an undefined symbol, NoModule if none does
+	};
+
+	enum class ProblemKind {
+		MissingLibrary,
+		MissingSymbol,
+		MissingVersion,
+	};
+
+	struct Problem {
+		ProblemKind Kind;
+		size_t Module;							// the module that needs the library, symbol or version
+		std::string Name;						// library or symbol
+		std::string Version;
+	};
+
+	ElfLoader() = default;
+	explicit ElfLoader(Options const& options);
+
+	bool Load(std::wstring const& path);
+
+	std::vector<Module> const& GetModules() const;
+	std::vector<Problem> const& GetProblems() const;
+	size_t GetParsedCount() const;
+
+	//
+	// the directory above the first usr, lib, bin... component of path; otherwise path itself
+	// if it's a directory, the file's directory if not
+	//
+	static std::wstring GuessSysRoot(std::wstring const& path);
+	static PCWSTR ProblemKindToString(ProblemKind kind);
+
+private:
+	std::shared_ptr<const ElfFile> Open(std::filesystem::path const& path);
+	bool IsCompatible(ElfFile const& file) const;
+	size_t Find(std::string_view name, size_t requester);
+	std::wstring Search(std::string_view name, size_t requester);
+	void AddDirs(std::vector<std::filesystem::path>& dirs, std::string_view list, size_t owner) const;
+	std::filesystem::path MapPath(std::string_view path) const;
+	void ReadConfig(std::filesystem::path const& path, int depth);
+	void Bind();
+
+	Options m_Options;
+	std::vector<Module> m_Modules;
+	std::vector<Problem> m_Problems;
+	std::unordered_map<std::string, size_t> m_ByName;		// DT_NEEDED strings and sonames
+	std::unordered_map<std::wstring, size_t> m_ByPath;
+	std::unordered_map<std::wstring, std::shared_ptr<const ElfFile>> m_Cache;	// null for files that didn't parse
+	std::vector<std::filesystem::path> m_ConfigDirs;
+	bool m_ConfigRead{ false };
+};
@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "ExportIndex.h"
+#include <algorithm>
+#include "MappedFile.h"
+
+namespace {
+	constexpr uint32_t Signature = 0x58495744;		// "DWIX"
+	constexpr uint32_t Version = 1;
+
+	std::string ToUtf8(std::wstring_view text) {
+		std::string utf8(::WideCharToMultiByte(CP_UTF8, 0, text.data(), (int)text.size(), nullptr, 0, nullptr, nullptr), '\0');
+		::WideCharToMultiByte(CP_UTF8, 0, text.data(), (int)text.size(), utf8.data(), (int)utf8.size(), nullptr, nullptr);
+		return utf8;
+	}
+
+	void PutArray(std::vector<uint8_t>& out, std::vector<uint32_t> const& values) {
+		auto size = (uint32_t)values.size();
+		out.insert(out.end(), (uint8_t const*)&size, (uint8_t const*)(&size + 1));
+		out.insert(out.end(), (uint8_t const*)values.data(), (uint8_t const*)(values.data() + values.size()));
+	}
+
+	bool GetArray(std::span<const uint8_t>& data, std::vector<uint32_t>& values) {
+		uint32_t size;
+		if (data.size() < sizeof(size))
+			return false;
+		memcpy(&size, data.data(), sizeof(size));
+		data = data.subspan(sizeof(size));
+		if (data.size() / sizeof(uint32_t) < size)
+			return false;
+		values.resize(size);
+		memcpy(values.data(), data.data(), size * sizeof(uint32_t));
+		data = data.subspan(size * sizeof(uint32_t));
+		return true;
+	}
+}
+
+void ExportIndex::Builder::Add(std::wstring_view module, libpe::PEExport const& exports) {
+	auto index = (uint32_t)Modules.size();
+	Modules.emplace_back(module);
+	for (auto& func : exports.Funcs)
+		if (!func.FuncName.empty()) {
+			Names.push_back({ func.FuncName, index });
+			NameBytes += func.FuncName.size();
+		}
+}
+
+void ExportIndex::Builder::Merge(Builder const& other) {
+	auto base = (uint32_t)Modules.size();
+	Modules.insert(Modules.end(), other.Modules.begin(), other.Modules.end());
+	Names.reserve(Names.size() + other.Names.size());
+	for (auto& [name, module] : other.Names)
+		Names.push_back({ name, base + module });
+	NameBytes += other.NameBytes;
+}
+
+ExportIndex ExportIndex::Builder::Build() const {
+	ExportIndex index;
+
+	//
+	// modules are numbered by path order, the position of their path in the pool
+	//
+	std::vector<std::string> paths;
+	paths.reserve(Modules.size());
+	for (auto& module : Modules)
+		paths.push_back(ToUtf8(module));
+	index.m_ModulePaths = StringPool::Build({ paths.begin(), paths.end() });
+	std::vector<uint32_t> moduleNumber(paths.size());
+	for (size_t i = 0; i < paths.size(); i++)
+		moduleNumber[i] = (uint32_t)index.m_ModulePaths.Find(paths[i]);
+
+	std::vector<std::pair<std::string_view, uint32_t>> exports;
+	exports.reserve(Names.size());
+	for (auto& [name, module] : Names)
+		exports.push_back({ name, moduleNumber[module] });
+	std::ranges::sort(exports);
+	exports.erase(std::unique(exports.begin(), exports.end()), exports.end());
+
+	//
+	// sorted pairs list the distinct names in pool order, so the module lists line up with the pool
+	//
+	std::vector<std::string_view> names;
+	index.m_Modules.reserve(exports.size());
+	for (auto& [name, module] : exports) {
+		if (names.empty() || names.back() != name) {
+			names.push_back(name);
+			index.m_Start.push_back((uint32_t)index.m_Modules.size());
+		}
+		index.m_Modules.push_back(module);
+	}
+	index.m_Start.push_back((uint32_t)index.m_Modules.size());
+	index.m_Names = StringPool::Build(std::move(names));
+	return index;
+}
+
+size_t ExportIndex::GetNameCount() const {
+	return m_Names.GetCount();
+}
+
+size_t ExportIndex::GetModuleCount() const {
+	return m_ModulePaths.GetCount();
+}
+
+size_t ExportIndex::GetExportCount() const {
+	return m_Modules.size();
+}
+
+size_t ExportIndex::GetSize() const {
+	return m_Names.GetSize() + m_ModulePaths.GetSize() + (m_Start.size() + m_Modules.size()) * sizeof(uint32_t);
+}
+
+std::wstring ExportIndex::GetModule(uint32_t index) const {
+	auto path = m_ModulePaths.Get(index);
+	std::wstring text(::MultiByteToWideChar(CP_UTF8, 0, path.data(), (int)path.size(), nullptr, 0), L'\0');
+	::MultiByteToWideChar(CP_UTF8, 0, path.data(), (int)path.size(), text.data(), (int)text.size());
+	return text;
+}
+
+std::span<const uint32_t> ExportIndex::Find(std::string_view name) const {
+	auto index = m_Names.Find(name);
+	return index == StringPool::NotFound ? std::span<const uint32_t>() : GetModules(index);
+}
+
+void ExportIndex::ForEachPrefix(std::string_view prefix, std::function<bool(std::string_view name, std::span<const uint32_t> modules)> const& fn) const {
+	m_Names.ForEach(m_Names.LowerBound(prefix), [&](size_t index, std::string_view name) {
+		return name.starts_with(prefix) && fn(name, GetModules(index));
+		});
+}
+
+std::span<const uint32_t> ExportIndex::GetModules(size_t name) const {
+	return std::span(m_Modules).subspan(m_Start[name], m_Start[name + 1] - m_Start[name]);
+}
+
+bool ExportIndex::Save(std::wstring const& path) const {
+	std::vector<uint8_t> data;
+	data.reserve(GetSize() + 64);
+	PutArray(data, { Signature, Version });
+	m_Names.Save(data);
+	m_ModulePaths.Save(data);
+	PutArray(data, m_Start);
+	PutArray(data, m_Modules);
+
+	wil::unique_hfile hFile(::CreateFile(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+	DWORD written;
+	return hFile && ::WriteFile(hFile.get(), data.data(), (DWORD)data.size(), &written, nullptr) && written == data.size();
+}
+
+bool ExportIndex::Load(std::wstring const& path) {
+	MappedFile file;
+	if (!file.Open(path))
+		return false;
+
+	auto bytes = file.GetData();
+	std::span<const uint8_t> data((uint8_t const*)bytes.data(), bytes.size());
+	std::vector<uint32_t> header;
+	ExportIndex index;
+	if (!GetArray(data, header) || header.size() != 2 || header[0] != Signature || header[1] != Version
+		|| !index.m_Names.Load(data) || !index.m_ModulePaths.Load(data)
+		|| !GetArray(data, index.m_Start) || !GetArray(data, index.m_Modules))
+		return false;
+
+	//
+	// the module lists have to fit the pools, or lookups would read past them
+	//
+	auto& start = index.m_Start;
+	if (start.size() != index.m_Names.GetCount() + 1 || start.front() != 0 || start.back() != index.m_Modules.size()
+		|| !std::ranges::is_sorted(start)
+		|| std::ranges::any_of(index.m_Modules, [&](auto m) { return m >= index.m_ModulePaths.GetCount(); }))
+		return false;
+
+	*this = std::move(index);
+	return true;
+}
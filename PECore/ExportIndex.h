@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "libpe.h"
+#include "StringPool.h"
+
+//
+// exported names across a set of modules and the modules exporting each one. Names and module paths
+// (UTF-8) sit in front coded string pools and are numbered in sorted order; the modules of name i are
+// Modules[Start[i]..Start[i + 1]). The whole index saves to one flat file and loads back for reuse.
+//
+class ExportIndex {
+public:
+	//
+	// collects the exports while scanning; a BatchScanner state
+	//
+	struct Builder {
+		void Add(std::wstring_view module, libpe::PEExport const& exports);
+		void Merge(Builder const& other);
+		ExportIndex Build() const;
+
+		std::vector<std::wstring> Modules;
+		std::vector<std::pair<std::string, uint32_t>> Names;	// name, index into Modules
+		uint64_t NameBytes{ 0 };
+	};
+
+	size_t GetNameCount() const;
+	size_t GetModuleCount() const;
+	size_t GetExportCount() const;			// name and module pairs
+	size_t GetSize() const;					// bytes held by the pools and the module lists
+
+	std::wstring GetModule(uint32_t index) const;
+
+	//
+	// modules exporting name, empty if none does
+	//
+	std::span<const uint32_t> Find(std::string_view name) const;
+
+	//
+	// names starting with prefix in sorted order, until fn returns false
+	//
+	void ForEachPrefix(std::string_view prefix, std::function<bool(std::string_view name, std::span<const uint32_t> modules)> const& fn) const;
+
+	bool Save(std::wstring const& path) const;
+	bool Load(std::wstring const& path);
+
+private:
+	std::span<const uint32_t> GetModules(size_t name) const;
+
+	StringPool m_Names;
+	StringPool m_ModulePaths;
+	std::vector<uint32_t> m_Start;
+	std::vector<uint32_t> m_Modules;
+};
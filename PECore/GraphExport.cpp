@@ -0,0 +1,442 @@
+#include "pch.h"
+#include "GraphExport.h"
+#include <algorithm>
+#include <format>
+
+namespace {
+	constexpr uint32_t Dropped = UINT32_MAX;
+	constexpr size_t MaxLabelNames = 3;
+
+	//
+	// collects the text and hands it to the sink in large chunks
+	//
+	class Writer {
+	public:
+		explicit Writer(GraphExport::Sink const& sink) : m_Sink(sink) {
+			m_Buffer.reserve(BufferSize);
+		}
+
+		bool Finish() {
+			Flush();
+			return m_Ok;
+		}
+
+		Writer& operator<<(std::string_view text) {
+			m_Buffer += text;
+			if (m_Buffer.size() >= BufferSize)
+				Flush();
+			return *this;
+		}
+
+		Writer& operator<<(uint32_t value) {
+			char text[16];
+			auto end = std::format_to_n(text, sizeof(text), "{}", value).out;
+			return *this << std::string_view(text, end - text);
+		}
+
+		//
+		// UTF-8, escaped for a DOT quoted string or for XML
+		//
+		void Text(std::wstring_view text, bool xml) {
+			m_Utf8.resize(text.size() * 3);
+			auto size = ::WideCharToMultiByte(CP_UTF8, 0, text.data(), (int)text.size(), m_Utf8.data(), (int)m_Utf8.size(), nullptr, nullptr);
+			for (auto ch : std::string_view(m_Utf8.data(), size)) {
+				switch (ch) {
+					case '"': *this << (xml ? "&quot;" : "\\\""); break;
+					case '\\': *this << (xml ? "\\" : "\\\\"); break;
+					case '&': *this << (xml ? "&amp;" : "&"); break;
+					case '<': *this << (xml ? "&lt;" : "<"); break;
+					case '>': *this << (xml ? "&gt;" : ">"); break;
+					default: m_Buffer += ch; break;
+				}
+			}
+			if (m_Buffer.size() >= BufferSize)
+				Flush();
+		}
+
+	private:
+		static constexpr size_t BufferSize = 1 << 16;
+
+		void Flush() {
+			if (m_Ok && !m_Buffer.empty())
+				m_Ok = m_Sink(m_Buffer);
+			m_Buffer.clear();
+		}
+
+		GraphExport::Sink const& m_Sink;
+		std::string m_Buffer;
+		std::string m_Utf8;
+		bool m_Ok{ true };
+	};
+}
+
+uint32_t GraphExport::AddNode(std::wstring_view name, std::wstring_view group, bool root) {
+	auto [it, inserted] = m_ByName.try_emplace(std::wstring(name), (uint32_t)m_Nodes.size());
+	if (!inserted)
+		return it->second;
+
+	auto groupIndex = NoGroup;
+	if (!group.empty()) {
+		auto g = std::ranges::find_if(m_Groups, [&](auto& existing) { return SimdScan::EqualsNoCase(existing, group); });
+		groupIndex = (uint32_t)(g - m_Groups.begin());
+		if (g == m_Groups.end())
+			m_Groups.emplace_back(group);
+	}
+	m_Nodes.push_back({ std::wstring(name), groupIndex, root });
+	return it->second;
+}
+
+void GraphExport::AddEdge(uint32_t from, uint32_t to) {
+	m_Edges.push_back({ from, to });
+}
+
+size_t GraphExport::GetNodeCount() const {
+	return m_Nodes.size();
+}
+
+size_t GraphExport::GetEdgeCount() const {
+	return m_Edges.size();
+}
+
+GraphExport::Format GraphExport::FormatFromPath(std::wstring_view path) {
+	return path.size() >= 5 && SimdScan::EqualsNoCase(path.substr(path.size() - 5), L".gexf") ? Format::Gexf : Format::Dot;
+}
+
+uint32_t GraphExport::Adjacency::GetNodeCount() const {
+	return (uint32_t)Start.size() - 1;
+}
+
+GraphExport::Adjacency GraphExport::Adjacency::FromEdges(uint32_t nodes, std::vector<std::pair<uint32_t, uint32_t>> const& edges) {
+	//
+	// counting sort by source, then duplicates and self loops go
+	//
+	Adjacency adj;
+	adj.Start.assign(nodes + 1, 0);
+	for (auto& [from, to] : edges)
+		adj.Start[from + 1]++;
+	for (uint32_t n = 0; n < nodes; n++)
+		adj.Start[n + 1] += adj.Start[n];
+
+	std::vector<uint32_t> sorted(edges.size());
+	std::vector<uint32_t> next(adj.Start.begin(), adj.Start.end() - 1);
+	for (auto& [from, to] : edges)
+		sorted[next[from]++] = to;
+
+	std::vector<uint32_t> seen(nodes, Dropped);
+	adj.Targets.reserve(edges.size());
+	uint32_t begin = 0;
+	for (uint32_t n = 0; n < nodes; n++) {
+		auto end = adj.Start[n + 1];
+		adj.Start[n] = (uint32_t)adj.Targets.size();
+		for (auto i = begin; i < end; i++) {
+			auto to = sorted[i];
+			if (to != n && seen[to] != n) {
+				seen[to] = n;
+				adj.Targets.push_back(to);
+			}
+		}
+		begin = end;
+	}
+	adj.Start[nodes] = (uint32_t)adj.Targets.size();
+	return adj;
+}
+
+namespace {
+	//
+	// one pass of the pipeline: nodes of the previous stage map to a node of this one, or are dropped
+	//
+	template<typename TStage>
+	TStage Contract(TStage const& stage, std::vector<uint32_t> const& map, uint32_t count) {
+		TStage result;
+		result.Members.assign(count, 0);
+		result.Names.resize(count);
+		result.Group.assign(count, TStage::NoGroup);
+		result.Root.assign(count, false);
+		result.Collapsed.assign(count, false);
+
+		auto nodes = stage.Graph.GetNodeCount();
+		std::vector<std::pair<uint32_t, uint32_t>> edges;
+		edges.reserve(stage.Graph.Targets.size());
+		for (uint32_t n = 0; n < nodes; n++) {
+			auto to = map[n];
+			if (to == Dropped)
+				continue;
+
+			result.Group[to] = result.Members[to] == 0 || result.Group[to] == stage.Group[n] ? stage.Group[n] : TStage::NoGroup;
+			result.Members[to] += stage.Members[n];
+			result.Root[to] = result.Root[to] || stage.Root[n];
+			result.Collapsed[to] = result.Collapsed[to] || stage.Collapsed[n];
+			for (auto name : stage.Names[n])
+				if (result.Names[to].size() < MaxLabelNames)
+					result.Names[to].push_back(name);
+
+			for (auto i = stage.Graph.Start[n]; i < stage.Graph.Start[n + 1]; i++)
+				if (auto target = map[stage.Graph.Targets[i]]; target != Dropped)
+					edges.push_back({ to, target });
+		}
+		result.Graph = decltype(result.Graph)::FromEdges(count, edges);
+		return result;
+	}
+
+	//
+	// iterative Tarjan; component ids come out in reverse topological order
+	//
+	template<typename TAdjacency>
+	uint32_t StronglyConnected(TAdjacency const& graph, std::vector<uint32_t>& component) {
+		constexpr uint32_t Unvisited = UINT32_MAX;
+		auto nodes = graph.GetNodeCount();
+		std::vector<uint32_t> index(nodes, Unvisited), low(nodes);
+		std::vector<bool> onStack(nodes);
+		std::vector<uint32_t> stack;
+		std::vector<std::pair<uint32_t, uint32_t>> calls;	// node, next edge
+		component.assign(nodes, Unvisited);
+		uint32_t counter = 0, components = 0;
+
+		for (uint32_t root = 0; root < nodes; root++) {
+			if (index[root] != Unvisited)
+				continue;
+
+			calls.push_back({ root, graph.Start[root] });
+			index[root] = low[root] = counter++;
+			stack.push_back(root);
+			onStack[root] = true;
+			while (!calls.empty()) {
+				auto& [n, edge] = calls.back();
+				if (edge < graph.Start[n + 1]) {
+					auto to = graph.Targets[edge++];
+					if (index[to] == Unvisited) {
+						index[to] = low[to] = counter++;
+						stack.push_back(to);
+						onStack[to] = true;
+						calls.push_back({ to, graph.Start[to] });
+					}
+					else if (onStack[to])
+						low[n] = (std::min)(low[n], index[to]);
+					continue;
+				}
+
+				auto done = n;
+				calls.pop_back();
+				if (!calls.empty())
+					low[calls.back().first] = (std::min)(low[calls.back().first], low[done]);
+				if (low[done] == index[done]) {
+					uint32_t member;
+					do {
+						member = stack.back();
+						stack.pop_back();
+						onStack[member] = false;
+						component[member] = components;
+					} while (member != done);
+					components++;
+				}
+			}
+		}
+		return components;
+	}
+}
+
+//
+// the pipeline stages share this shape; Contract builds one from the previous
+//
+struct GraphExport::Stage {
+	static constexpr uint32_t NoGroup = GraphExport::NoGroup;
+
+	Adjacency Graph;
+	std::vector<uint32_t> Members;						// original nodes a node stands for
+	std::vector<std::vector<std::wstring_view>> Names;	// the first few, for the label
+	std::vector<uint32_t> Group;						// the group of all members, NoGroup if they don't share one
+	std::vector<bool> Root;
+	std::vector<bool> Collapsed;						// stands for a whole group
+};
+
+bool GraphExport::Write(Options const& options, Sink const& sink) const {
+	auto nodes = (uint32_t)m_Nodes.size();
+
+	Stage stage;
+	stage.Graph = Adjacency::FromEdges(nodes, m_Edges);
+	stage.Members.assign(nodes, 1);
+	stage.Names.resize(nodes);
+	stage.Group.resize(nodes);
+	stage.Root.resize(nodes);
+	stage.Collapsed.assign(nodes, false);
+	for (uint32_t n = 0; n < nodes; n++) {
+		stage.Names[n].push_back(m_Nodes[n].Name);
+		stage.Group[n] = m_Nodes[n].Group;
+		stage.Root[n] = m_Nodes[n].Root;
+	}
+
+	//
+	// groups first, so the filters see a group's fan-in as a whole
+	//
+	if (options.CollapseGroups && !m_Groups.empty()) {
+		std::vector<uint32_t> map(nodes);
+		auto count = (uint32_t)m_Groups.size();
+		for (uint32_t n = 0; n < nodes; n++)
+			map[n] = m_Nodes[n].Group == NoGroup ? count++ : m_Nodes[n].Group;
+		stage = Contract(stage, map, count);
+		for (uint32_t g = 0; g < m_Groups.size(); g++) {
+			stage.Names[g] = { m_Groups[g] };
+			stage.Collapsed[g] = true;
+		}
+	}
+
+	if (options.MaxDepth || options.MinFanIn) {
+		auto& graph = stage.Graph;
+		auto count = graph.GetNodeCount();
+		std::vector<uint32_t> fanIn(count);
+		for (auto to : graph.Targets)
+			fanIn[to]++;
+
+		//
+		// breadth first from the roots: the flagged ones, else whatever nothing imports
+		//
+		std::vector<uint32_t> depth(count, Dropped), queue;
+		for (uint32_t n = 0; n < count; n++)
+			if (stage.Root[n])
+				queue.push_back(n);
+		if (queue.empty())
+			for (uint32_t n = 0; n < count; n++)
+				if (fanIn[n] == 0)
+					queue.push_back(n);
+		for (auto n : queue)
+			depth[n] = 0;
+		for (size_t i = 0; i < queue.size(); i++) {
+			auto n = queue[i];
+			for (auto e = graph.Start[n]; e < graph.Start[n + 1]; e++)
+				if (auto to = graph.Targets[e]; depth[to] == Dropped) {
+					depth[to] = depth[n] + 1;
+					queue.push_back(to);
+				}
+		}
+
+		std::vector<uint32_t> map(count, Dropped);
+		uint32_t kept = 0;
+		for (uint32_t n = 0; n < count; n++) {
+			auto isRoot = depth[n] == 0;
+			if (options.MaxDepth && (depth[n] == Dropped || depth[n] > options.MaxDepth))
+				continue;
+			if (!isRoot && fanIn[n] < options.MinFanIn)
+				continue;
+			map[n] = kept++;
+		}
+		stage = Contract(stage, map, kept);
+	}
+
+	if (options.CondenseCycles) {
+		std::vector<uint32_t> component;
+		auto count = StronglyConnected(stage.Graph, component);
+		stage = Contract(stage, component, count);
+	}
+
+	//
+	// emit
+	//
+	auto& graph = stage.Graph;
+	auto count = graph.GetNodeCount();
+	std::vector<uint32_t> fanIn(count);
+	for (auto to : graph.Targets)
+		fanIn[to]++;
+
+	std::wstring label;
+	auto getLabel = [&](uint32_t n) -> std::wstring const& {
+		label.clear();
+		for (auto name : stage.Names[n])
+			label.append(label.empty() ? L"" : L", ").append(name);
+		if (stage.Members[n] > stage.Names[n].size())
+			label += std::format(L"{}({} modules)", stage.Names[n].size() > 1 ? L", ... " : L" ", stage.Members[n]);
+		return label;
+	};
+
+	Writer out(sink);
+	if (options.Type == Format::Dot) {
+		out << "digraph dependencies {\n\tnode [shape=box, fontname=\"Segoe UI\", fontsize=10];\n";
+
+		//
+		// nodes of a group that wasn't collapsed go into the group's cluster; counting sort by group
+		//
+		auto groups = (uint32_t)m_Groups.size();
+		std::vector<uint32_t> start(groups + 2, 0), order(count);
+		auto slot = [&](uint32_t n) {
+			return stage.Group[n] < groups && !stage.Collapsed[n] ? stage.Group[n] + 1 : 0;
+		};
+		for (uint32_t n = 0; n < count; n++)
+			start[slot(n) + 1]++;
+		for (uint32_t g = 0; g <= groups; g++)
+			start[g + 1] += start[g];
+		auto next = start;
+		for (uint32_t n = 0; n < count; n++)
+			order[next[slot(n)]++] = n;
+
+		for (uint32_t g = 0; g <= groups; g++) {
+			if (start[g] == start[g + 1])
+				continue;
+			auto indent = g ? "\t\t" : "\t";
+			if (g) {
+				out << "\tsubgraph cluster_" << g << " {\n\t\tlabel=\"";
+				out.Text(m_Groups[g - 1], false);
+				out << "\";\n\t\tstyle=filled;\n\t\tcolor=\"#eeeeee\";\n";
+			}
+			for (auto i = start[g]; i < start[g + 1]; i++) {
+				auto n = order[i];
+				out << indent << "n" << n << " [label=\"";
+				out.Text(getLabel(n), false);
+				out << "\"";
+				if (stage.Collapsed[n])
+					out << ", shape=box3d";
+				else if (stage.Members[n] > 1)
+					out << ", shape=doubleoctagon";
+				if (stage.Root[n])
+					out << ", style=bold";
+				out << "];\n";
+			}
+			if (g)
+				out << "\t}\n";
+		}
+
+		for (uint32_t n = 0; n < count; n++)
+			for (auto e = graph.Start[n]; e < graph.Start[n + 1]; e++)
+				out << "\tn" << n << " -> n" << graph.Targets[e] << ";\n";
+		out << "}\n";
+		return out.Finish();
+	}
+
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<gexf xmlns=\"http://gexf.net/1.3\" version=\"1.3\">\n"
+		"\t<graph defaultedgetype=\"directed\">\n"
+		"\t\t<attributes class=\"node\">\n"
+		"\t\t\t<attribute id=\"0\" title=\"members\" type=\"integer\"/>\n"
+		"\t\t\t<attribute id=\"1\" title=\"fanin\" type=\"integer\"/>\n"
+		"\t\t\t<attribute id=\"2\" title=\"group\" type=\"string\"/>\n"
+		"\t\t\t<attribute id=\"3\" title=\"root\" type=\"boolean\"/>\n"
+		"\t\t</attributes>\n"
+		"\t\t<nodes>\n";
+	for (uint32_t n = 0; n < count; n++) {
+		out << "\t\t\t<node id=\"" << n << "\" label=\"";
+		out.Text(getLabel(n), true);
+		out << "\"><attvalues><attvalue for=\"0\" value=\"" << stage.Members[n] << "\"/><attvalue for=\"1\" value=\"" << fanIn[n] << "\"/>";
+		if (stage.Group[n] < m_Groups.size()) {
+			out << "<attvalue for=\"2\" value=\"";
+			out.Text(m_Groups[stage.Group[n]], true);
+			out << "\"/>";
+		}
+		out << "<attvalue for=\"3\" value=\"" << (stage.Root[n] ? "true" : "false") << "\"/></attvalues></node>\n";
+	}
+	out << "\t\t</nodes>\n\t\t<edges>\n";
+	uint32_t id = 0;
+	for (uint32_t n = 0; n < count; n++)
+		for (auto e = graph.Start[n]; e < graph.Start[n + 1]; e++)
+			out << "\t\t\t<edge id=\"" << id++ << "\" source=\"" << n << "\" target=\"" << graph.Targets[e] << "\"/>\n";
+	out << "\t\t</edges>\n\t</graph>\n</gexf>\n";
+	return out.Finish();
+}
+
+bool GraphExport::Write(Options const& options, std::wstring const& path) const {
+	wil::unique_hfile hFile(::CreateFile(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+	if (!hFile)
+		return false;
+
+	return Write(options, [&](std::string_view text) {
+		DWORD written;
+		return ::WriteFile(hFile.get(), text.data(), (DWORD)text.size(), &written, nullptr) && written == text.size();
+		});
+}
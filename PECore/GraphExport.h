@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "SimdScan.h"
+
+//
+// dependency graph written out as GraphViz DOT or GEXF (Gephi) for viewing outside DepWalk.
+// Edges point from the importer to the imported module. Before anything is written, grouped nodes
+// (system DLLs, api sets) are collapsed into one node per group, the depth and fan-in filters are
+// applied and strongly connected components are condensed into single nodes. All passes are linear
+// in nodes + edges, and the text is streamed to the sink through a small buffer, node by node and
+// edge by edge.
+//
+class GraphExport {
+public:
+	enum class Format {
+		Dot,
+		Gexf,
+	};
+
+	struct Options {
+		Format Type{ Format::Dot };
+		bool CondenseCycles{ true };		// a strongly connected component becomes one node
+		bool CollapseGroups{ true };		// nodes of a group become one node named after the group
+		uint32_t MaxDepth{ 0 };				// edges away from the roots, 0 - no limit
+		uint32_t MinFanIn{ 0 };				// importers a node needs to be kept; roots are always kept
+	};
+
+	//
+	// receives the UTF-8 text in chunks; false stops the export
+	//
+	using Sink = std::function<bool(std::string_view text)>;
+
+	//
+	// nodes are merged by name (case insensitive); the first AddNode of a name sets its group and root flag
+	//
+	uint32_t AddNode(std::wstring_view name, std::wstring_view group = {}, bool root = false);
+	void AddEdge(uint32_t from, uint32_t to);
+
+	size_t GetNodeCount() const;
+	size_t GetEdgeCount() const;
+
+	bool Write(Options const& options, Sink const& sink) const;
+	bool Write(Options const& options, std::wstring const& path) const;
+
+	//
+	// GEXF for ".gexf" files, DOT for anything else
+	//
+	static Format FormatFromPath(std::wstring_view path);
+
+private:
+	struct Node {
+		std::wstring Name;
+		uint32_t Group;						// NoGroup or the index of the group name
+		bool Root;
+	};
+
+	//
+	// adjacency in compressed rows: the targets of node n are Targets[Start[n]..Start[n + 1])
+	//
+	struct Adjacency {
+		std::vector<uint32_t> Start;
+		std::vector<uint32_t> Targets;
+
+		uint32_t GetNodeCount() const;
+		static Adjacency FromEdges(uint32_t nodes, std::vector<std::pair<uint32_t, uint32_t>> const& edges);
+	};
+
+	//
+	// a step of the pipeline, see GraphExport.cpp
+	//
+	struct Stage;
+
+	static constexpr uint32_t NoGroup = UINT32_MAX;
+
+	std::vector<Node> m_Nodes;
+	std::vector<std::wstring> m_Groups;
+	std::vector<std::pair<uint32_t, uint32_t>> m_Edges;
+	std::unordered_map<std::wstring, uint32_t, SimdScan::NameHash, SimdScan::NameEquals> m_ByName;
+};
@@ -0,0 +1,257 @@
+#include "pch.h"
+#include "ImportLibrary.h"
+#include "SimdScan.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+	constexpr size_t MemberHeaderSize = sizeof(IMAGE_ARCHIVE_MEMBER_HEADER);
+
+	// newer SDKs have it as IMPORT_OBJECT_NAME_EXPORTAS: the export name follows the DLL name
+	constexpr BYTE NameTypeExportAs = 4;
+
+	template<typename T>
+	T Get(const std::byte* p) {
+		T value;
+		memcpy(&value, p, sizeof(T));
+		return value;
+	}
+
+	DWORD GetBigEndian(const std::byte* p) {
+		return _byteswap_ulong(Get<DWORD>(p));
+	}
+
+	//
+	// member sizes are decimal ASCII, space padded
+	//
+	uint64_t GetMemberSize(IMAGE_ARCHIVE_MEMBER_HEADER const& header) {
+		uint64_t size = 0;
+		for (auto c : header.Size) {
+			if (c < '0' || c > '9')
+				break;
+			size = size * 10 + (c - '0');
+		}
+		return size;
+	}
+
+	bool IsMemberName(IMAGE_ARCHIVE_MEMBER_HEADER const& header, const char* name) {
+		return memcmp(header.Name, name, sizeof(header.Name)) == 0;
+	}
+
+	std::string_view GetString(const std::byte*& p, const std::byte* end) {
+		auto s = reinterpret_cast<const char*>(p);
+		auto len = SimdScan::StrNLen(s, end - p);
+		if (len == static_cast<size_t>(end - p))
+			return {};
+		p += len + 1;
+		return { s, len };
+	}
+
+	//
+	// the name the linker puts in the import table for a symbol, as the name type says
+	//
+	std::string_view GetExportName(std::string_view symbol, BYTE nameType) {
+		switch (nameType) {
+			case IMPORT_OBJECT_ORDINAL:
+				return {};
+
+			case IMPORT_OBJECT_NAME_NO_PREFIX:
+			case IMPORT_OBJECT_NAME_UNDECORATE:
+				if (!symbol.empty() && (symbol[0] == '?' || symbol[0] == '@' || symbol[0] == '_'))
+					symbol.remove_prefix(1);
+				if (nameType == IMPORT_OBJECT_NAME_UNDECORATE)
+					symbol = symbol.substr(0, symbol.find('@'));
+				return symbol;
+		}
+		return symbol;
+	}
+}
+
+bool ImportLibrary::Import::ByOrdinal() const {
+	return NameType == IMPORT_OBJECT_ORDINAL;
+}
+
+bool ImportLibrary::Open(std::wstring const& path) {
+	Close();
+	if (!m_File.Open(path) || !ReadMembers()) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void ImportLibrary::Close() {
+	m_File.Close();
+	m_Imports.clear();
+	m_SymbolCount = m_OtherMembers = 0;
+}
+
+std::vector<ImportLibrary::Import> const& ImportLibrary::GetImports() const {
+	return m_Imports;
+}
+
+uint32_t ImportLibrary::GetSymbolCount() const {
+	return m_SymbolCount;
+}
+
+uint32_t ImportLibrary::GetOtherMemberCount() const {
+	return m_OtherMembers;
+}
+
+bool ImportLibrary::ReadMembers() {
+	auto data = m_File.GetData();
+	if (data.size() < IMAGE_ARCHIVE_START_SIZE || memcmp(data.data(), IMAGE_ARCHIVE_START, IMAGE_ARCHIVE_START_SIZE) != 0)
+		return false;
+
+	//
+	// the linker members list the object members by offset, one entry per public symbol.
+	// The second one (Microsoft) is little endian with each member once; the first one
+	// (System V, the only one GNU tools write) is big endian with an offset per symbol.
+	//
+	std::vector<DWORD> offsets;
+	uint64_t pos = IMAGE_ARCHIVE_START_SIZE;
+	for (int linker = 0; linker < 2; linker++) {
+		auto header = m_File.GetData(pos, MemberHeaderSize);
+		if (header.empty())
+			break;
+		auto& member = *reinterpret_cast<IMAGE_ARCHIVE_MEMBER_HEADER const*>(header.data());
+		if (!IsMemberName(member, IMAGE_ARCHIVE_LINKER_MEMBER))
+			break;
+
+		auto size = GetMemberSize(member);
+		auto body = m_File.GetData(pos + MemberHeaderSize, size);
+		if (body.size() < 4)
+			return false;
+
+		auto p = body.data();
+		if (linker == 0) {
+			auto count = GetBigEndian(p);
+			if (count > (body.size() - 4) / 4)
+				return false;
+			m_SymbolCount = count;
+			offsets.resize(count);
+			for (DWORD i = 0; i < count; i++)
+				offsets[i] = GetBigEndian(p + 4 + i * 4);
+		}
+		else {
+			auto count = Get<DWORD>(p);
+			if (count > (body.size() - 4) / 4)
+				return false;
+			offsets.resize(count);
+			memcpy(offsets.data(), p + 4, count * sizeof(DWORD));
+			if (auto symbols = m_File.GetData(pos + MemberHeaderSize + 4 + count * 4ull, 4); !symbols.empty())
+				m_SymbolCount = Get<DWORD>(symbols.data());
+		}
+		pos += MemberHeaderSize + size + (size & 1);
+	}
+
+	if (!offsets.empty()) {
+		std::ranges::sort(offsets);
+		offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+		m_Imports.reserve(offsets.size());
+		for (auto offset : offsets)
+			ReadMember(offset);
+		return true;
+	}
+
+	//
+	// no symbol table: walk the members one after the other
+	//
+	while (pos + MemberHeaderSize <= data.size()) {
+		auto& member = *reinterpret_cast<IMAGE_ARCHIVE_MEMBER_HEADER const*>(data.data() + pos);
+		auto size = GetMemberSize(member);
+		if (!IsMemberName(member, IMAGE_ARCHIVE_LONGNAMES_MEMBER))
+			ReadMember(pos);
+		pos += MemberHeaderSize + size + (size & 1);
+	}
+	return true;
+}
+
+void ImportLibrary::ReadMember(uint64_t offset) {
+	auto header = m_File.GetData(offset, MemberHeaderSize);
+	if (header.empty())
+		return;
+
+	auto size = GetMemberSize(*reinterpret_cast<IMAGE_ARCHIVE_MEMBER_HEADER const*>(header.data()));
+	auto body = m_File.GetData(offset + MemberHeaderSize, size);
+	if (body.size() < sizeof(IMPORT_OBJECT_HEADER)) {
+		m_OtherMembers++;
+		return;
+	}
+
+	auto object = Get<IMPORT_OBJECT_HEADER>(body.data());
+	if (object.Sig1 != IMAGE_FILE_MACHINE_UNKNOWN || object.Sig2 != IMPORT_OBJECT_HDR_SIG2
+		|| object.SizeOfData > body.size() - sizeof(IMPORT_OBJECT_HEADER)) {
+		m_OtherMembers++;
+		return;
+	}
+
+	//
+	// the header is followed by the symbol and the DLL name, and for NAME_EXPORTAS the export name
+	//
+	auto p = body.data() + sizeof(IMPORT_OBJECT_HEADER);
+	auto end = p + object.SizeOfData;
+	Import entry;
+	entry.Symbol = GetString(p, end);
+	entry.Dll = GetString(p, end);
+	if (entry.Symbol.empty() || entry.Dll.empty()) {
+		m_OtherMembers++;
+		return;
+	}
+	entry.OrdinalOrHint = object.Ordinal;
+	entry.Type = static_cast<BYTE>(object.Type);
+	entry.NameType = static_cast<BYTE>(object.NameType);
+	entry.Name = entry.NameType == NameTypeExportAs ? GetString(p, end) : GetExportName(entry.Symbol, entry.NameType);
+	m_Imports.push_back(entry);
+}
+
+std::vector<std::string_view> ImportLibrary::GetDlls() const {
+	std::vector<std::string_view> dlls;
+	for (auto& import : m_Imports)
+		if (std::ranges::find_if(dlls, [&](auto dll) { return SimdScan::EqualsNoCase(dll, import.Dll); }) == dlls.end())
+			dlls.push_back(import.Dll);
+	return dlls;
+}
+
+std::vector<ImportLibrary::Mismatch> ImportLibrary::Check(std::string_view dllName, libpe::PEExport const& exports) const {
+	//
+	// export ordinals are biased by the directory's Base; the hint is the index into the sorted name table
+	//
+	std::unordered_set<DWORD> ordinals;
+	std::vector<std::string_view> names;
+	ordinals.reserve(exports.Funcs.size());
+	names.reserve(exports.Funcs.size());
+	for (auto& func : exports.Funcs) {
+		ordinals.insert(exports.ExportDesc.Base + func.Ordinal);
+		if (!func.FuncName.empty())
+			names.push_back(func.FuncName);
+	}
+	std::ranges::sort(names);
+
+	std::vector<Mismatch> mismatches;
+	for (auto& import : m_Imports) {
+		if (!SimdScan::EqualsNoCase(import.Dll, dllName))
+			continue;
+
+		if (import.ByOrdinal()) {
+			if (!ordinals.contains(import.OrdinalOrHint))
+				mismatches.push_back({ &import, Mismatch::Kind::MissingOrdinal });
+			continue;
+		}
+		if (!std::ranges::binary_search(names, import.Name))
+			mismatches.push_back({ &import, Mismatch::Kind::MissingName });
+		else if (import.OrdinalOrHint >= names.size() || names[import.OrdinalOrHint] != import.Name)
+			mismatches.push_back({ &import, Mismatch::Kind::StaleHint });
+	}
+	return mismatches;
+}
+
+PCWSTR ImportLibrary::MismatchKindToString(Mismatch::Kind kind) {
+	switch (kind) {
+		case Mismatch::Kind::MissingName: return L"Missing name";
+		case Mismatch::Kind::MissingOrdinal: return L"Missing ordinal";
+		case Mismatch::Kind::StaleHint: return L"Stale hint";
+	}
+	return L"";
+}
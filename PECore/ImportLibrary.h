@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "libpe.h"
+#include "MappedFile.h"
+
+//
+// import library (.lib) reader: the COFF archive's linker members and the short import objects
+// the members point at, read in place from the mapping. Every import tells which name or ordinal
+// the linker expects the DLL to export, so a library can be checked against the DLL it stands for.
+//
+class ImportLibrary {
+public:
+	struct Import {
+		std::string_view Symbol;		// public symbol, "__imp_" less: "_CreateFileW@28"
+		std::string_view Dll;			// "KERNEL32.dll"
+		std::string_view Name;			// name the DLL has to export, empty if imported by ordinal
+		WORD OrdinalOrHint;
+		BYTE Type;						// IMPORT_OBJECT_CODE, _DATA or _CONST
+		BYTE NameType;					// IMPORT_OBJECT_ORDINAL, _NAME, _NAME_NO_PREFIX, ...
+
+		bool ByOrdinal() const;
+	};
+
+	struct Mismatch {
+		enum class Kind : uint8_t {
+			MissingName,
+			MissingOrdinal,
+			StaleHint,		// the name is there, just not at the hinted index; the loader falls back to a search
+		};
+
+		Import const* Entry;
+		Kind Problem;
+	};
+
+	bool Open(std::wstring const& path);
+	void Close();
+
+	std::vector<Import> const& GetImports() const;
+
+	//
+	// symbols in the archive symbol table and members that aren't short import objects
+	// (long format imports, regular object files)
+	//
+	uint32_t GetSymbolCount() const;
+	uint32_t GetOtherMemberCount() const;
+
+	//
+	// distinct DLL names the imports refer to
+	//
+	std::vector<std::string_view> GetDlls() const;
+
+	//
+	// imports from dllName checked against the DLL's export table. Names aliasing an already
+	// named function aren't kept by the export parser and show up as missing.
+	//
+	std::vector<Mismatch> Check(std::string_view dllName, libpe::PEExport const& exports) const;
+
+	static PCWSTR MismatchKindToString(Mismatch::Kind kind);
+
+private:
+	bool ReadMembers();
+	void ReadMember(uint64_t offset);
+
+	MappedFile m_File;
+	std::vector<Import> m_Imports;
+	uint32_t m_SymbolCount{ 0 };
+	uint32_t m_OtherMembers{ 0 };
+};
@@ -0,0 +1,324 @@
+#include "pch.h"
+#include "Inflate.h"
+#include <array>
+#include <cstring>
+
+namespace {
+	constexpr int MaxBits = 15;
+	constexpr int FastBits = 10;
+
+	//
+	// bits come out LSB first; reading past the end yields zeros and is caught by Overrun
+	//
+	class BitReader {
+	public:
+		explicit BitReader(std::span<const std::byte> in) : m_Data(reinterpret_cast<const uint8_t*>(in.data())), m_Size(in.size()) {
+		}
+
+		uint32_t Peek(int count) {
+			Refill();
+			return static_cast<uint32_t>(m_Bits & ((1ull << count) - 1));
+		}
+
+		void Skip(int count) {
+			m_Bits >>= count;
+			m_Count -= count;
+		}
+
+		uint32_t Read(int count) {
+			auto value = Peek(count);
+			Skip(count);
+			return value;
+		}
+
+		void AlignToByte() {
+			Skip(m_Count & 7);
+		}
+
+		bool Overrun() const {
+			return m_Count < 0;
+		}
+
+		//
+		// stored blocks are copied straight from the input
+		//
+		const uint8_t* TakeBytes(size_t count) {
+			AlignToByte();
+			if (m_Count < 0)
+				return nullptr;
+			// give back the whole bytes that were buffered ahead
+			auto buffered = static_cast<size_t>(m_Count / 8);
+			if (m_Pos - buffered + count > m_Size)
+				return nullptr;
+			auto p = m_Data + m_Pos - buffered;
+			m_Pos = m_Pos - buffered + count;
+			m_Bits = 0;
+			m_Count = 0;
+			return p;
+		}
+
+	private:
+		void Refill() {
+			while (m_Count <= 56) {
+				if (m_Pos < m_Size)
+					m_Bits |= static_cast<uint64_t>(m_Data[m_Pos]) << m_Count;
+				else if (m_Pos >= m_Size + 8)
+					break;		// well past the end, Overrun() will tell
+				m_Pos++;
+				m_Count += 8;
+			}
+		}
+
+		const uint8_t* m_Data;
+		size_t m_Size;
+		size_t m_Pos{ 0 };
+		uint64_t m_Bits{ 0 };
+		int m_Count{ 0 };		// can go negative past the end
+	};
+
+	//
+	// canonical Huffman code: a lookup table for codes up to FastBits long,
+	// the longer ones are decoded a bit at a time from the per-length counts
+	//
+	class Huffman {
+	public:
+		bool Build(const uint8_t* lengths, int count) {
+			m_Counts.fill(0);
+			for (int i = 0; i < count; i++)
+				m_Counts[lengths[i]]++;
+			m_Counts[0] = 0;
+
+			int left = 1;
+			for (int len = 1; len <= MaxBits; len++) {
+				left = (left << 1) - m_Counts[len];
+				if (left < 0)
+					return false;	// over-subscribed
+			}
+
+			std::array<uint16_t, MaxBits + 1> offsets{};
+			for (int len = 1; len < MaxBits; len++)
+				offsets[len + 1] = offsets[len] + m_Counts[len];
+			for (int i = 0; i < count; i++)
+				if (lengths[i])
+					m_Symbols[offsets[lengths[i]]++] = static_cast<uint16_t>(i);
+
+			m_Fast.fill(0);
+			uint32_t code = 0;
+			int index = 0;
+			for (int len = 1; len <= FastBits; len++) {
+				for (int i = 0; i < m_Counts[len]; i++, code++, index++) {
+					auto reversed = Reverse(code, len);
+					auto entry = static_cast<uint16_t>((len << 9) | m_Symbols[index]);
+					for (auto j = reversed; j < (1u << FastBits); j += 1u << len)
+						m_Fast[j] = entry;
+				}
+				code <<= 1;
+			}
+			return true;
+		}
+
+		int Decode(BitReader& bits) const {
+			if (auto entry = m_Fast[bits.Peek(FastBits)]; entry) {
+				bits.Skip(entry >> 9);
+				return entry & 0x1ff;
+			}
+
+			int code = 0, first = 0, index = 0;
+			for (int len = 1; len <= MaxBits; len++) {
+				code |= bits.Read(1);
+				auto count = m_Counts[len];
+				if (code - count < first)
+					return m_Symbols[index + (code - first)];
+				index += count;
+				first = (first + count) << 1;
+				code <<= 1;
+			}
+			return -1;
+		}
+
+	private:
+		static uint32_t Reverse(uint32_t code, int len) {
+			uint32_t result = 0;
+			for (int i = 0; i < len; i++, code >>= 1)
+				result = (result << 1) | (code & 1);
+			return result;
+		}
+
+		std::array<uint16_t, MaxBits + 1> m_Counts;
+		std::array<uint16_t, 288> m_Symbols;
+		std::array<uint16_t, 1 << FastBits> m_Fast;
+	};
+
+	constexpr uint16_t LengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	constexpr uint8_t LengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	constexpr uint16_t DistBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	constexpr uint8_t DistExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	class Decoder {
+	public:
+		Decoder(std::span<const std::byte> in, std::span<std::byte> out) : m_Bits(in), m_Out(reinterpret_cast<uint8_t*>(out.data())), m_Size(out.size()) {
+		}
+
+		bool Run() {
+			for (bool last = false; !last; ) {
+				last = m_Bits.Read(1) != 0;
+				bool ok;
+				switch (m_Bits.Read(2)) {
+					case 0: ok = Stored(); break;
+					case 1: ok = Fixed(); break;
+					case 2: ok = Dynamic(); break;
+					default: ok = false; break;
+				}
+				if (!ok || m_Bits.Overrun())
+					return false;
+			}
+			return m_Pos == m_Size;
+		}
+
+	private:
+		bool Stored() {
+			auto p = m_Bits.TakeBytes(4);
+			if (p == nullptr)
+				return false;
+			auto len = static_cast<uint32_t>(p[0] | (p[1] << 8));
+			auto nlen = static_cast<uint32_t>(p[2] | (p[3] << 8));
+			if (len != (~nlen & 0xffff) || len > m_Size - m_Pos)
+				return false;
+			if (p = m_Bits.TakeBytes(len); p == nullptr)
+				return false;
+			memcpy(m_Out + m_Pos, p, len);
+			m_Pos += len;
+			return true;
+		}
+
+		bool Fixed() {
+			static const auto tables = [] {
+				std::pair<Huffman, Huffman> t;
+				uint8_t lengths[288];
+				int i = 0;
+				for (; i < 144; i++) lengths[i] = 8;
+				for (; i < 256; i++) lengths[i] = 9;
+				for (; i < 280; i++) lengths[i] = 7;
+				for (; i < 288; i++) lengths[i] = 8;
+				t.first.Build(lengths, 288);
+				for (i = 0; i < 30; i++) lengths[i] = 5;
+				t.second.Build(lengths, 30);
+				return t;
+			}();
+			return Codes(tables.first, tables.second);
+		}
+
+		bool Dynamic() {
+			auto nlen = static_cast<int>(m_Bits.Read(5)) + 257;
+			auto ndist = static_cast<int>(m_Bits.Read(5)) + 1;
+			auto ncode = static_cast<int>(m_Bits.Read(4)) + 4;
+			if (nlen > 286 || ndist > 30)
+				return false;
+
+			static constexpr uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+			uint8_t lengths[286 + 30]{};
+			for (int i = 0; i < ncode; i++)
+				lengths[order[i]] = static_cast<uint8_t>(m_Bits.Read(3));
+			if (!m_LenCode.Build(lengths, 19))
+				return false;
+
+			for (int i = 0; i < nlen + ndist; ) {
+				auto symbol = m_LenCode.Decode(m_Bits);
+				if (symbol < 0 || m_Bits.Overrun())
+					return false;
+				if (symbol < 16) {
+					lengths[i++] = static_cast<uint8_t>(symbol);
+					continue;
+				}
+
+				uint8_t len = 0;
+				int repeat;
+				if (symbol == 16) {
+					if (i == 0)
+						return false;
+					len = lengths[i - 1];
+					repeat = 3 + m_Bits.Read(2);
+				}
+				else if (symbol == 17)
+					repeat = 3 + m_Bits.Read(3);
+				else
+					repeat = 11 + m_Bits.Read(7);
+				if (i + repeat > nlen + ndist)
+					return false;
+				while (repeat--)
+					lengths[i++] = len;
+			}
+			if (lengths[256] == 0)
+				return false;	// no end of block code
+
+			return m_Lit.Build(lengths, nlen) && m_Dist.Build(lengths + nlen, ndist) && Codes(m_Lit, m_Dist);
+		}
+
+		bool Codes(Huffman const& lit, Huffman const& dist) {
+			for (;;) {
+				auto symbol = lit.Decode(m_Bits);
+				if (symbol < 256) {
+					if (symbol < 0 || m_Pos == m_Size)
+						return false;
+					m_Out[m_Pos++] = static_cast<uint8_t>(symbol);
+					continue;
+				}
+				if (symbol == 256)
+					return true;
+
+				symbol -= 257;
+				if (symbol >= 29)
+					return false;
+				size_t len = LengthBase[symbol] + m_Bits.Read(LengthExtra[symbol]);
+
+				symbol = dist.Decode(m_Bits);
+				if (symbol < 0 || symbol >= 30)
+					return false;
+				size_t distance = DistBase[symbol] + m_Bits.Read(DistExtra[symbol]);
+				if (distance > m_Pos || len > m_Size - m_Pos || m_Bits.Overrun())
+					return false;
+
+				auto dst = m_Out + m_Pos;
+				auto src = dst - distance;
+				if (distance >= len)
+					memcpy(dst, src, len);
+				else {
+					// overlapping copy repeats the last distance bytes
+					for (size_t i = 0; i < len; i++)
+						dst[i] = src[i];
+				}
+				m_Pos += len;
+			}
+		}
+
+		BitReader m_Bits;
+		uint8_t* m_Out;
+		size_t m_Size;
+		size_t m_Pos{ 0 };
+		Huffman m_LenCode, m_Lit, m_Dist;
+	};
+}
+
+namespace Inflate {
+	bool Decompress(std::span<const std::byte> in, std::span<std::byte> out) {
+		return Decoder(in, out).Run();
+	}
+
+	uint32_t Crc32(std::span<const std::byte> data) {
+		static const auto table = [] {
+			std::array<uint32_t, 256> t{};
+			for (uint32_t i = 0; i < 256; i++) {
+				auto c = i;
+				for (int k = 0; k < 8; k++)
+					c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+				t[i] = c;
+			}
+			return t;
+		}();
+
+		uint32_t crc = 0xffffffff;
+		for (auto b : data)
+			crc = table[(crc ^ static_cast<uint8_t>(b)) & 0xff] ^ (crc >> 8);
+		return ~crc;
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+//
+// raw deflate (RFC 1951) decoder for archive entries, where the uncompressed size is known up front
+//
+namespace Inflate {
+	//
+	// false if the stream is corrupt or doesn't produce exactly out.size() bytes
+	//
+	bool Decompress(std::span<const std::byte> in, std::span<std::byte> out);
+
+	uint32_t Crc32(std::span<const std::byte> data);
+}
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+bool MappedFile::Open(std::wstring const& path) {
+	Close();
+
+	wil::unique_hfile hFile(::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr));
+	if (!hFile)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(hFile.get(), &size) || size.QuadPart == 0 || static_cast<uint64_t>(size.QuadPart) > SIZE_MAX)
+		return false;
+
+	wil::unique_handle hMap(::CreateFileMapping(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+	if (!hMap)
+		return false;
+
+	m_View = static_cast<const std::byte*>(::MapViewOfFile(hMap.get(), FILE_MAP_READ, 0, 0, 0));
+	if (m_View == nullptr)
+		return false;
+
+	m_Size = size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_View)
+		::UnmapViewOfFile(m_View);
+	m_View = nullptr;
+	m_Size = 0;
+}
+
+uint64_t MappedFile::GetSize() const {
+	return m_Size;
+}
+
+std::span<const std::byte> MappedFile::GetData() const {
+	return { m_View, static_cast<size_t>(m_Size) };
+}
+
+std::span<const std::byte> MappedFile::GetData(uint64_t offset, uint64_t size) const {
+	if (offset > m_Size || size > m_Size - offset)
+		return {};
+	return { m_View + offset, static_cast<size_t>(size) };
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+//
+// read-only view of a whole file
+//
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	bool Open(std::wstring const& path);
+	void Close();
+
+	uint64_t GetSize() const;
+	std::span<const std::byte> GetData() const;
+
+	//
+	// empty if the range isn't inside the file
+	//
+	std::span<const std::byte> GetData(uint64_t offset, uint64_t size) const;
+
+private:
+	const std::byte* m_View{ nullptr };
+	uint64_t m_Size{ 0 };
+};
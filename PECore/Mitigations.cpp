@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "Mitigations.h"
+
+ModuleMitigations ModuleMitigations::FromPE(PEFile const& pe) {
+	ModuleMitigations m;
+	if (!pe || !pe->IsLoaded() || pe->GetNTHeader() == nullptr)
+		return m;
+
+	auto nt = pe->GetNTHeader();
+	auto is64 = pe->GetFileInfo()->IsPE64;
+	auto dllChars = is64 ? nt->NTHdr64.OptionalHeader.DllCharacteristics : nt->NTHdr32.OptionalHeader.DllCharacteristics;
+
+	if (auto debug = pe->GetDebug(); debug) {
+		for (auto& d : *debug) {
+			if (d.DebugDir.Type == IMAGE_DEBUG_TYPE_EX_DLLCHARACTERISTICS) {
+				m.CET = (d.DebugHdrInfo.Header[0] & IMAGE_DLLCHARACTERISTICS_EX_CET_COMPAT) != 0;
+				break;
+			}
+		}
+	}
+
+	auto lcd = pe->GetLoadConfig();
+	if (lcd == nullptr)
+		return m;
+
+	auto guardFlags = lcd->Guard.GuardFlags;
+	m.CFG = (dllChars & IMAGE_DLLCHARACTERISTICS_GUARD_CF) && (guardFlags & IMAGE_GUARD_CF_INSTRUMENTED);
+	m.XFG = m.CFG && (guardFlags & IMAGE_GUARD_XFG_ENABLED);
+	m.EHCont = (guardFlags & IMAGE_GUARD_EH_CONTINUATION_TABLE_PRESENT) != 0;
+	m.ExportSuppression = (guardFlags & IMAGE_GUARD_CF_ENABLE_EXPORT_SUPPRESSION) != 0;
+	m.LongJumpTable = (guardFlags & IMAGE_GUARD_CF_LONGJUMP_TABLE_PRESENT) != 0;
+
+	auto& guard = lcd->Guard;
+	m.CFFunctions = guard.CFFunctions.Count;
+	m.XFGFunctions = guard.XFGFuncs;
+	m.SuppressedFunctions = guard.SuppressedFuncs + guard.ExpSuppressedFuncs;
+	m.AddressTakenIATEntries = guard.AddressTakenIAT.Count;
+	m.LongJumpTargets = guard.LongJumpTargets.Count;
+	m.EHContinuations = guard.EHContinuations.Count;
+	m.DynamicRelocations = guard.DynRelocCount;
+
+	return m;
+}
+
+std::wstring ModuleMitigations::ToString() const {
+	std::wstring text;
+	if (CFG)
+		text += L"CFG ";
+	if (XFG)
+		text += L"XFG ";
+	if (CET)
+		text += L"CET ";
+	if (EHCont)
+		text += L"EHCont ";
+	if (!text.empty())
+		text.pop_back();
+	return text;
+}
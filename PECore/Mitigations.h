@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include "PEFile.h"
+
+//
+// exploit mitigations a module opts into, from the optional header, the load config
+// directory and the extended DLL characteristics debug entry
+//
+struct ModuleMitigations {
+	static ModuleMitigations FromPE(PEFile const& pe);
+
+	std::wstring ToString() const;
+
+	bool CFG : 1{};				// IMAGE_DLLCHARACTERISTICS_GUARD_CF + instrumented
+	bool XFG : 1{};				// IMAGE_GUARD_XFG_ENABLED
+	bool CET : 1{};				// IMAGE_DLLCHARACTERISTICS_EX_CET_COMPAT
+	bool EHCont : 1{};			// EH continuation table present
+	bool ExportSuppression : 1{};
+	bool LongJumpTable : 1{};
+	uint32_t CFFunctions{ 0 };
+	uint32_t XFGFunctions{ 0 };
+	uint32_t SuppressedFunctions{ 0 };
+	uint32_t AddressTakenIATEntries{ 0 };
+	uint32_t LongJumpTargets{ 0 };
+	uint32_t EHContinuations{ 0 };
+	uint32_t DynamicRelocations{ 0 };
+};
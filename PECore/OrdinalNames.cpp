@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "OrdinalNames.h"
+#include <algorithm>
+#include <span>
+
+namespace {
+	struct Entry {
+		uint16_t Ordinal;
+		std::string_view Name;
+	};
+
+	//
+	// Winsock 1.1 ordinals, kept by ws2_32 and wsock32 alike
+	//
+	constexpr Entry Winsock[] = {
+		{ 1, "accept" }, { 2, "bind" }, { 3, "closesocket" }, { 4, "connect" }, { 5, "getpeername" },
+		{ 6, "getsockname" }, { 7, "getsockopt" }, { 8, "htonl" }, { 9, "htons" }, { 10, "ioctlsocket" },
+		{ 11, "inet_addr" }, { 12, "inet_ntoa" }, { 13, "listen" }, { 14, "ntohl" }, { 15, "ntohs" },
+		{ 16, "recv" }, { 17, "recvfrom" }, { 18, "select" }, { 19, "send" }, { 20, "sendto" },
+		{ 21, "setsockopt" }, { 22, "shutdown" }, { 23, "socket" },
+		{ 51, "gethostbyaddr" }, { 52, "gethostbyname" }, { 53, "getprotobyname" }, { 54, "getprotobynumber" },
+		{ 55, "getservbyname" }, { 56, "getservbyport" }, { 57, "gethostname" },
+		{ 101, "WSAAsyncSelect" }, { 102, "WSAAsyncGetHostByAddr" }, { 103, "WSAAsyncGetHostByName" },
+		{ 104, "WSAAsyncGetProtoByNumber" }, { 105, "WSAAsyncGetProtoByName" }, { 106, "WSAAsyncGetServByPort" },
+		{ 107, "WSAAsyncGetServByName" }, { 108, "WSACancelAsyncRequest" }, { 109, "WSASetBlockingHook" },
+		{ 110, "WSAUnhookBlockingHook" }, { 111, "WSAGetLastError" }, { 112, "WSASetLastError" },
+		{ 113, "WSACancelBlockingCall" }, { 114, "WSAIsBlocking" }, { 115, "WSAStartup" }, { 116, "WSACleanup" },
+		{ 151, "__WSAFDIsSet" }, { 500, "WEP" },
+	};
+
+	constexpr Entry OleAut32[] = {
+		{ 2, "SysAllocString" }, { 3, "SysReAllocString" }, { 4, "SysAllocStringLen" }, { 5, "SysReAllocStringLen" },
+		{ 6, "SysFreeString" }, { 7, "SysStringLen" }, { 8, "VariantInit" }, { 9, "VariantClear" },
+		{ 10, "VariantCopy" }, { 11, "VariantCopyInd" }, { 12, "VariantChangeType" }, { 13, "VariantTimeToDosDateTime" },
+		{ 14, "DosDateTimeToVariantTime" }, { 15, "SafeArrayCreate" }, { 16, "SafeArrayDestroy" }, { 17, "SafeArrayGetDim" },
+		{ 18, "SafeArrayGetElemsize" }, { 19, "SafeArrayGetUBound" }, { 20, "SafeArrayGetLBound" }, { 21, "SafeArrayLock" },
+		{ 22, "SafeArrayUnlock" }, { 23, "SafeArrayAccessData" }, { 24, "SafeArrayUnaccessData" }, { 25, "SafeArrayGetElement" },
+		{ 26, "SafeArrayPutElement" }, { 27, "SafeArrayCopy" }, { 28, "DispGetParam" }, { 29, "DispGetIDsOfNames" },
+		{ 30, "DispInvoke" }, { 31, "CreateDispTypeInfo" }, { 32, "CreateStdDispatch" }, { 33, "RegisterActiveObject" },
+		{ 34, "RevokeActiveObject" }, { 35, "GetActiveObject" }, { 36, "SafeArrayAllocDescriptor" }, { 37, "SafeArrayAllocData" },
+		{ 38, "SafeArrayDestroyDescriptor" }, { 39, "SafeArrayDestroyData" }, { 40, "SafeArrayRedim" },
+		{ 41, "SafeArrayAllocDescriptorEx" }, { 42, "SafeArrayCreateEx" }, { 43, "SafeArrayCreateVectorEx" },
+		{ 44, "SafeArraySetRecordInfo" }, { 45, "SafeArrayGetRecordInfo" }, { 46, "VarParseNumFromStr" },
+		{ 47, "VarNumFromParseNum" }, { 48, "VarI2FromUI1" }, { 49, "VarI2FromI4" }, { 50, "VarI2FromR4" },
+		{ 51, "VarI2FromR8" }, { 52, "VarI2FromCy" }, { 53, "VarI2FromDate" }, { 54, "VarI2FromStr" },
+		{ 55, "VarI2FromDisp" }, { 56, "VarI2FromBool" }, { 57, "SafeArraySetIID" }, { 58, "VarI4FromUI1" },
+		{ 59, "VarI4FromI2" }, { 60, "VarI4FromR4" }, { 61, "VarI4FromR8" }, { 62, "VarI4FromCy" },
+		{ 63, "VarI4FromDate" }, { 64, "VarI4FromStr" }, { 65, "VarI4FromDisp" }, { 66, "VarI4FromBool" },
+		{ 67, "SafeArrayGetIID" }, { 68, "VarR4FromUI1" }, { 69, "VarR4FromI2" }, { 70, "VarR4FromI4" },
+		{ 71, "VarR4FromR8" }, { 72, "VarR4FromCy" }, { 73, "VarR4FromDate" }, { 74, "VarR4FromStr" },
+		{ 75, "VarR4FromDisp" }, { 76, "VarR4FromBool" }, { 77, "SafeArrayGetVartype" }, { 78, "VarR8FromUI1" },
+		{ 79, "VarR8FromI2" }, { 80, "VarR8FromI4" }, { 81, "VarR8FromR4" }, { 82, "VarR8FromCy" },
+		{ 83, "VarR8FromDate" }, { 84, "VarR8FromStr" }, { 85, "VarR8FromDisp" }, { 86, "VarR8FromBool" },
+		{ 87, "VarFormat" }, { 88, "VarDateFromUI1" }, { 89, "VarDateFromI2" }, { 90, "VarDateFromI4" },
+		{ 91, "VarDateFromR4" }, { 92, "VarDateFromR8" }, { 93, "VarDateFromCy" }, { 94, "VarDateFromStr" },
+		{ 95, "VarDateFromDisp" }, { 96, "VarDateFromBool" }, { 97, "VarFormatDateTime" }, { 98, "VarCyFromUI1" },
+		{ 99, "VarCyFromI2" }, { 100, "VarCyFromI4" }, { 101, "VarCyFromR4" }, { 102, "VarCyFromR8" },
+		{ 103, "VarCyFromDate" }, { 104, "VarCyFromStr" }, { 105, "VarCyFromDisp" }, { 106, "VarCyFromBool" },
+		{ 107, "VarFormatNumber" }, { 108, "VarBstrFromUI1" }, { 109, "VarBstrFromI2" }, { 110, "VarBstrFromI4" },
+		{ 111, "VarBstrFromR4" }, { 112, "VarBstrFromR8" }, { 113, "VarBstrFromCy" }, { 114, "VarBstrFromDate" },
+		{ 115, "VarBstrFromDisp" }, { 116, "VarBstrFromBool" }, { 117, "VarFormatPercent" }, { 118, "VarBoolFromUI1" },
+		{ 119, "VarBoolFromI2" }, { 120, "VarBoolFromI4" }, { 121, "VarBoolFromR4" }, { 122, "VarBoolFromR8" },
+		{ 123, "VarBoolFromDate" }, { 124, "VarBoolFromCy" }, { 125, "VarBoolFromStr" }, { 126, "VarBoolFromDisp" },
+		{ 127, "VarFormatCurrency" }, { 128, "VarWeekdayName" }, { 129, "VarMonthName" }, { 130, "VarUI1FromI2" },
+		{ 131, "VarUI1FromI4" }, { 132, "VarUI1FromR4" }, { 133, "VarUI1FromR8" }, { 134, "VarUI1FromCy" },
+		{ 135, "VarUI1FromDate" }, { 136, "VarUI1FromStr" }, { 137, "VarUI1FromDisp" }, { 138, "VarUI1FromBool" },
+		{ 139, "VarFormatFromTokens" }, { 140, "VarTokenizeFormatString" }, { 141, "VarAdd" }, { 142, "VarAnd" },
+		{ 143, "VarDiv" }, { 146, "DispCallFunc" }, { 147, "VariantChangeTypeEx" }, { 148, "SafeArrayPtrOfIndex" },
+		{ 149, "SysStringByteLen" }, { 150, "SysAllocStringByteLen" }, { 152, "VarEqv" }, { 153, "VarIdiv" },
+		{ 154, "VarImp" }, { 155, "VarMod" }, { 156, "VarMul" }, { 157, "VarOr" }, { 158, "VarPow" }, { 159, "VarSub" },
+		{ 160, "CreateTypeLib" }, { 161, "LoadTypeLib" }, { 162, "LoadRegTypeLib" }, { 163, "RegisterTypeLib" },
+		{ 164, "QueryPathOfRegTypeLib" }, { 165, "LHashValOfNameSys" }, { 166, "LHashValOfNameSysA" }, { 167, "VarXor" },
+		{ 168, "VarAbs" }, { 169, "VarFix" }, { 170, "OaBuildVersion" }, { 171, "ClearCustData" }, { 172, "VarInt" },
+		{ 173, "VarNeg" }, { 174, "VarNot" }, { 175, "VarRound" }, { 176, "VarCmp" }, { 177, "VarDecAdd" },
+		{ 178, "VarDecDiv" }, { 179, "VarDecMul" }, { 180, "CreateTypeLib2" }, { 181, "VarDecSub" }, { 182, "VarDecAbs" },
+		{ 183, "LoadTypeLibEx" }, { 184, "SystemTimeToVariantTime" }, { 185, "VariantTimeToSystemTime" },
+		{ 186, "UnRegisterTypeLib" }, { 200, "GetErrorInfo" }, { 201, "SetErrorInfo" }, { 202, "CreateErrorInfo" },
+	};
+
+	constexpr Entry ComCtl32[] = {
+		{ 17, "InitCommonControls" }, { 410, "SetWindowSubclass" }, { 411, "GetWindowSubclass" },
+		{ 412, "RemoveWindowSubclass" }, { 413, "DefSubclassProc" },
+	};
+
+	struct Dll {
+		std::string_view Name;			// lowercase, no extension
+		std::span<const Entry> Entries;
+	};
+
+	constexpr Dll Dlls[] = {
+		{ "comctl32", ComCtl32 },
+		{ "oleaut32", OleAut32 },
+		{ "ws2_32", Winsock },
+		{ "wsock32", Winsock },
+	};
+
+	constexpr bool IsSorted(std::span<const Entry> entries) {
+		return std::ranges::adjacent_find(entries, [](auto& e1, auto& e2) { return e1.Ordinal >= e2.Ordinal; }) == entries.end();
+	}
+
+	static_assert(IsSorted(Winsock) && IsSorted(OleAut32) && IsSorted(ComCtl32), "ordinal tables must be sorted");
+
+	bool IsDll(std::string_view dll, std::string_view name) {
+		if (dll.size() == name.size() + 4 && _strnicmp(dll.data() + name.size(), ".dll", 4) == 0)
+			dll.remove_suffix(4);
+		return dll.size() == name.size() && _strnicmp(dll.data(), name.data(), name.size()) == 0;
+	}
+}
+
+std::string_view OrdinalNames::Find(std::string_view dll, uint16_t ordinal) {
+	for (auto& d : Dlls) {
+		if (!IsDll(dll, d.Name))
+			continue;
+		auto it = std::ranges::lower_bound(d.Entries, ordinal, {}, &Entry::Ordinal);
+		return it != d.Entries.end() && it->Ordinal == ordinal ? it->Name : std::string_view();
+	}
+	return {};
+}
+
+std::string_view OrdinalNames::Resolve(libpe::PEExport const* exports, std::string_view dll, uint16_t ordinal) {
+	//
+	// the export table is kept in ordinal order, with the base taken off
+	//
+	if (exports && ordinal >= exports->ExportDesc.Base) {
+		auto& funcs = exports->Funcs;
+		auto it = std::ranges::lower_bound(funcs, ordinal - exports->ExportDesc.Base, {}, &libpe::PEExportFunction::Ordinal);
+		if (it != funcs.end() && it->Ordinal == ordinal - exports->ExportDesc.Base && !it->FuncName.empty())
+			return it->FuncName;
+	}
+	return Find(dll, ordinal);
+}
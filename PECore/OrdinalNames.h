@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "libpe.h"
+
+//
+// names for imports by ordinal. The target's export table names most of them; for the well-known
+// DLLs that export functions by ordinal only (or aren't around to look at) a small table built
+// into the binary fills in. Lookups are binary searches over constant data, nothing is allocated.
+//
+namespace OrdinalNames {
+	//
+	// from the bundled table; dll with or without ".dll", any case. Empty if not known.
+	//
+	std::string_view Find(std::string_view dll, uint16_t ordinal);
+
+	//
+	// the name the target exports for the ordinal, else Find; exports may be null
+	//
+	std::string_view Resolve(libpe::PEExport const* exports, std::string_view dll, uint16_t ordinal);
+}
@@ -1,8 +1,10 @@
 #include "pch.h"
 #include "PEFile.h"
 #include "libpe.h"
+#include <algorithm>
 
 bool PEFile::Open(std::wstring_view path) {
+	m_Data = {};
 	auto ok = m_pe->LoadPe(path.data()) == libpe::PEOK;
 	if (ok) {
 		m_Path = path;
@@ -10,9 +12,47 @@ bool PEFile::Open(std::wstring_view path) {
 	return ok;
 }
 
+bool PEFile::Open(std::span<const std::byte> data, std::wstring_view name) {
+	if (data.data() != m_Data.data())
+		m_Data = {};
+	auto ok = !data.empty() && m_pe->LoadPe(data) == libpe::PEOK;
+	if (ok) {
+		m_Path = name;
+	}
+	return ok;
+}
+
+Task<bool> PEFile::OpenAsync(std::wstring path, AsyncFile::Executor executor) {
+	AsyncFile file;
+	if (!file.Open(path) || file.GetSize() > UINT32_MAX)
+		co_return false;
+
+	//
+	// one read per chunk, each a suspension point
+	//
+	constexpr size_t chunkSize = 16 << 20;
+	std::vector<std::byte> data(static_cast<size_t>(file.GetSize()));
+	for (size_t offset = 0; offset < data.size(); ) {
+		auto size = (std::min)(chunkSize, data.size() - offset);
+		auto read = co_await file.Read(offset, std::span(data).subspan(offset, size), executor);
+		if (read == 0)
+			co_return false;
+		offset += read;
+	}
+	file.Close();
+
+	m_Data = std::move(data);
+	co_return Open(std::span<const std::byte>(m_Data), path);
+}
+
+void PEFile::OpenAsync(std::wstring path, AsyncFile::Executor executor, std::function<void(bool)> completion) {
+	OpenAsync(std::move(path), std::move(executor)).Start(std::move(completion));
+}
+
 void PEFile::Close() {
 	m_pe->Clear();
 	m_Path = L"";
+	m_Data = {};
 }
 
 std::wstring const& PEFile::GetPath() const {
@@ -28,7 +68,10 @@ PEFile::operator bool() const {
 }
 
 bool PEFile::Read(uint32_t offset, uint32_t size, void* buffer) const {
-	memcpy(buffer, (PBYTE)m_pe->GetBaseAddr() + offset, size);
+	auto span = GetSpan(offset, size);
+	if (span.size() != size)
+		return false;
+	memcpy(buffer, span.data(), size);
 	return true;
 }
 
@@ -37,6 +80,9 @@ const BYTE* PEFile::GetData() const {
 }
 
 std::span<const std::byte> PEFile::GetSpan(uint32_t offset, uint32_t size) const {
+	auto total = m_pe->GetDataSize();
+	if (offset > total || size > total - offset)
+		return {};
 	return std::span((const std::byte*)GetData() + offset, size);
 }
 
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <string_view>
 #include <vector>
 #include "libpe.h"
+#include "AsyncFile.h"
+#include "Task.h"
 #include <cassert>
 
 class PEFile {
@@ -15,15 +18,32 @@ public:
 	PEFile& operator=(PEFile const&) = delete;
 
 	bool Open(std::wstring_view path);
+	//
+	// image in memory, such as an embedded one; data has to outlive the PEFile.
+	// name is what GetPath reports.
+	//
+	bool Open(std::span<const std::byte> data, std::wstring_view name);
+	//
+	// reads the file with overlapped I/O, suspending while the reads are in flight, then parses it
+	// from memory on the thread the executor resumed it on. The PEFile has to outlive the load.
+	//
+	Task<bool> OpenAsync(std::wstring path, AsyncFile::Executor executor = {});
+	//
+	// same, completion is called with the result instead of being awaited
+	//
+	void OpenAsync(std::wstring path, AsyncFile::Executor executor, std::function<void(bool)> completion);
 	void Close();
 
 	std::wstring const& GetPath() const;
 	uint32_t GetFileSize() const;
 
+	//
+	// the image stays mapped (or in memory) while open; reads outside it fail, spans come back empty
+	//
 	bool Read(uint32_t offset, uint32_t size, void* buffer) const;
 	template<typename T>
 	T Read(uint32_t offset) const {
-		T value;
+		T value{};
 		Read(offset, sizeof(T), &value);
 		return value;
 	}
@@ -38,5 +58,6 @@ public:
 private:
 	libpe::IlibpePtr m_pe{ libpe::Createlibpe() };
 	std::wstring m_Path;
+	std::vector<std::byte> m_Data;		// the image read by OpenAsync
 };
 
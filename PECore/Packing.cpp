@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "Packing.h"
+#include <format>
+
+namespace {
+	constexpr double HighEntropy = 7.2;
+
+	struct PackerSection {
+		const char* Prefix;
+		const wchar_t* Packer;
+	};
+
+	const PackerSection PackerSections[] = {
+		{ "UPX", L"UPX" },
+		{ ".aspack", L"ASPack" },
+		{ ".adata", L"ASPack" },
+		{ ".MPRESS", L"MPRESS" },
+		{ ".petite", L"Petite" },
+		{ ".nsp", L"NsPack" },
+		{ "PEC2", L"PECompact" },
+		{ "pec1", L"PECompact" },
+		{ ".themida", L"Themida" },
+		{ ".winlice", L"WinLicense" },
+		{ ".vmp", L"VMProtect" },
+		{ ".enigma", L"Enigma" },
+		{ "kkrunchy", L"kkrunchy" },
+		{ ".packed", L"Packed" },
+	};
+
+	bool IsCode(IMAGE_SECTION_HEADER const& sec) {
+		return (sec.Characteristics & (IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_CNT_CODE)) != 0;
+	}
+}
+
+ModulePacking ModulePacking::FromPE(PEFile const& pe) {
+	ModulePacking p;
+	if (!pe || !pe->IsLoaded() || pe->GetNTHeader() == nullptr)
+		return p;
+
+	auto sections = pe->GetSecHeaders();
+	if (sections == nullptr)
+		return p;
+
+	auto nt = pe->GetNTHeader();
+	auto is64 = pe->GetFileInfo()->IsPE64;
+	auto entryPoint = is64 ? nt->NTHdr64.OptionalHeader.AddressOfEntryPoint : nt->NTHdr32.OptionalHeader.AddressOfEntryPoint;
+	auto isDll = (nt->NTHdr32.FileHeader.Characteristics & IMAGE_FILE_DLL) != 0;
+	bool entryInCode = false;
+
+	for (auto& s : *sections) {
+		auto& sec = s.SecHdr;
+		if (p.Packer.empty()) {
+			for (auto& ps : PackerSections) {
+				if (s.SectionName.starts_with(ps.Prefix)) {
+					p.Packer = ps.Packer;
+					break;
+				}
+			}
+		}
+
+		if (s.Entropy >= 0) {
+			p.EntropyKnown = true;
+			if (s.Entropy > HighEntropy)
+				p.HighEntropySections++;
+		}
+
+		auto virtualSize = sec.Misc.VirtualSize ? sec.Misc.VirtualSize : sec.SizeOfRawData;
+		if (entryPoint >= sec.VirtualAddress && entryPoint - sec.VirtualAddress < virtualSize)
+			entryInCode = IsCode(sec);
+
+		if (!IsCode(sec))
+			continue;
+
+		p.MaxCodeEntropy = (std::max)(p.MaxCodeEntropy, s.Entropy);
+		p.HighEntropyCode |= s.Entropy > HighEntropy;
+		p.VirtualOnlyCode |= sec.SizeOfRawData == 0 && sec.Misc.VirtualSize != 0;
+		p.WritableCode |= (sec.Characteristics & IMAGE_SCN_MEM_WRITE) != 0;
+	}
+
+	// resource-only DLLs have no entry point and no code, that's not packing
+	p.EntryOutsideCode = entryPoint ? !entryInCode : !isDll;
+
+	if (auto imports = pe->GetImport(); imports) {
+		size_t functions = 0;
+		for (auto& lib : *imports)
+			functions += lib.ImportFunc.size();
+		p.FewImports = functions > 0 && functions <= 8;
+	}
+
+	//
+	// a packer's section name decides alone; otherwise any two of the signs have to agree,
+	// compressed resources or a self-modifying stub alone are common enough in normal modules
+	//
+	int signs = p.HighEntropyCode + p.VirtualOnlyCode + p.WritableCode + p.EntryOutsideCode + p.FewImports;
+	p.LikelyPacked = !p.Packer.empty() || signs >= 2;
+	return p;
+}
+
+std::wstring ModulePacking::ToString() const {
+	if (!LikelyPacked)
+		return L"";
+	return Packer.empty() ? L"Packed" : std::format(L"Packed ({})", Packer);
+}
+
+std::wstring ModulePacking::GetReasons() const {
+	std::wstring text;
+	if (!Packer.empty())
+		text += std::format(L"{} sections, ", Packer);
+	if (HighEntropyCode)
+		text += std::format(L"code entropy {:.2f}, ", MaxCodeEntropy);
+	if (VirtualOnlyCode)
+		text += L"code without raw data, ";
+	if (WritableCode)
+		text += L"writable code, ";
+	if (EntryOutsideCode)
+		text += L"entry point outside code, ";
+	if (FewImports)
+		text += L"few imports, ";
+	if (!text.empty())
+		text.resize(text.size() - 2);
+	return text;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include "PEFile.h"
+
+//
+// signs that a module is packed or compressed, so its import table is a stub rather than
+// what the code will load: section entropy, executable sections with no raw data or
+// writable code, an entry point outside the code, and section names packers leave behind
+//
+struct ModulePacking {
+	static ModulePacking FromPE(PEFile const& pe);
+
+	std::wstring ToString() const;
+	std::wstring GetReasons() const;
+
+	std::wstring Packer;				// from the section names, "UPX", "ASPack", ...
+	double MaxCodeEntropy{ 0 };			// highest entropy among the executable sections
+	uint32_t HighEntropySections{ 0 };	// any section above 7.2 bits per byte
+	bool LikelyPacked : 1{};
+	bool EntropyKnown : 1{};
+	bool HighEntropyCode : 1{};
+	bool VirtualOnlyCode : 1{};			// executable section with no raw data, unpacked into at run time
+	bool WritableCode : 1{};
+	bool EntryOutsideCode : 1{};		// entry point in a non-executable section or none at all
+	bool FewImports : 1{};				// a handful of imports, typically LoadLibrary and GetProcAddress
+};
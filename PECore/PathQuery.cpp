@@ -0,0 +1,105 @@
+#include "pch.h"
+#include "PathQuery.h"
+
+PathQuery::PathQuery(std::vector<std::vector<uint32_t>> edges, uint32_t root) : m_Edges(std::move(edges)), m_Root(root) {
+	auto count = m_Edges.size();
+	m_Parent.assign(count, Unreachable);
+	m_Distance.assign(count, Unreachable);
+	if (root >= count)
+		return;
+
+	std::vector<uint32_t> queue{ root };
+	queue.reserve(count);
+	m_Distance[root] = 0;
+	for (size_t i = 0; i < queue.size(); i++) {
+		auto n = queue[i];
+		for (auto to : m_Edges[n])
+			if (m_Distance[to] == Unreachable) {
+				m_Distance[to] = m_Distance[n] + 1;
+				m_Parent[to] = n;
+				queue.push_back(to);
+			}
+	}
+}
+
+uint32_t PathQuery::GetDistance(uint32_t node) const {
+	return node < m_Distance.size() ? m_Distance[node] : Unreachable;
+}
+
+PathQuery::Path PathQuery::ShortestPath(uint32_t target) const {
+	Path path;
+	if (GetDistance(target) == Unreachable)
+		return path;
+
+	path.resize(m_Distance[target] + 1);
+	for (auto n = target, i = (uint32_t)path.size(); i > 0; n = m_Parent[n])
+		path[--i] = n;
+	return path;
+}
+
+std::vector<PathQuery::Path> PathQuery::Paths(uint32_t target, uint32_t extraLength, size_t maxPaths) const {
+	std::vector<Path> paths;
+	auto shortest = GetDistance(target);
+	if (shortest == Unreachable || maxPaths == 0)
+		return paths;
+
+	//
+	// distance of every node to the target over the reversed edges, limited to the longest length asked for
+	//
+	auto count = m_Edges.size();
+	auto maxLength = shortest + extraLength;
+	std::vector<std::vector<uint32_t>> importers(count);
+	for (uint32_t n = 0; n < count; n++)
+		if (m_Distance[n] != Unreachable)
+			for (auto to : m_Edges[n])
+				importers[to].push_back(n);
+
+	std::vector<uint32_t> toTarget(count, Unreachable), queue{ target };
+	toTarget[target] = 0;
+	for (size_t i = 0; i < queue.size(); i++) {
+		auto n = queue[i];
+		if (toTarget[n] == maxLength)
+			continue;
+		for (auto from : importers[n])
+			if (toTarget[from] == Unreachable) {
+				toTarget[from] = toTarget[n] + 1;
+				queue.push_back(from);
+			}
+	}
+
+	//
+	// one bounded search per length: a node is only entered if the target can still be reached in exactly
+	// the edges left, which holds for every node on some chain of that length with repeats allowed
+	//
+	Path path;
+	std::vector<bool> onPath(count);
+	std::vector<std::pair<uint32_t, size_t>> stack;		// node, next edge
+	for (auto length = shortest; length <= maxLength && paths.size() < maxPaths; length++) {
+		path.assign(1, m_Root);
+		onPath[m_Root] = true;
+		stack.assign(1, { m_Root, 0 });
+		while (!stack.empty() && paths.size() < maxPaths) {
+			auto& [n, next] = stack.back();
+			auto depth = (uint32_t)path.size() - 1;
+			if (n == target || next == m_Edges[n].size()) {
+				if (n == target && depth == length)
+					paths.push_back(path);
+				onPath[n] = false;
+				path.pop_back();
+				stack.pop_back();
+				continue;
+			}
+
+			auto to = m_Edges[n][next++];
+			auto left = length - depth - 1;
+			if (onPath[to] || toTarget[to] == Unreachable || toTarget[to] > left)
+				continue;
+			onPath[to] = true;
+			path.push_back(to);
+			stack.push_back({ to, 0 });
+		}
+		for (auto n : path)
+			onPath[n] = false;
+	}
+	return paths;
+}
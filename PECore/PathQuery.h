@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// "why is this module loaded": chains of import edges from the root to a module.
+// The graph is given as adjacency lists in import order. A breadth first search from the root
+// leaves a parent pointer in every reachable node, so a shortest chain is a walk up the parents.
+// Longer chains come from a depth first search that only enters nodes still close enough to the
+// target (distances from a breadth first search over the reversed edges), so it never wanders.
+//
+class PathQuery {
+public:
+	static constexpr uint32_t Unreachable = UINT32_MAX;
+
+	using Path = std::vector<uint32_t>;		// root first, target last
+
+	PathQuery(std::vector<std::vector<uint32_t>> edges, uint32_t root);
+
+	uint32_t GetDistance(uint32_t node) const;	// edges from the root, Unreachable if not in the closure
+
+	//
+	// empty if the node isn't reachable; among equally short chains, the one following the earliest imports
+	//
+	Path ShortestPath(uint32_t target) const;
+
+	//
+	// chains without repeated modules, at most extraLength edges longer than the shortest one,
+	// shortest first, in import order within a length; maxPaths bounds the result
+	//
+	std::vector<Path> Paths(uint32_t target, uint32_t extraLength, size_t maxPaths) const;
+
+private:
+	std::vector<std::vector<uint32_t>> m_Edges;
+	std::vector<uint32_t> m_Parent;
+	std::vector<uint32_t> m_Distance;
+	uint32_t m_Root;
+};
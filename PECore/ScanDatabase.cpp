@@ -0,0 +1,260 @@
+#include "pch.h"
+#include "ScanDatabase.h"
+#include <winsqlite/winsqlite3.h>
+#include "BatchScanner.h"
+#include "Toolchain.h"
+#include "OrdinalNames.h"
+
+#pragma comment(lib, "winsqlite3")
+
+namespace {
+	//
+	// rows per transaction; with the journal off a commit costs little, this only bounds the dirty pages
+	//
+	constexpr uint64_t BatchRows = 1 << 20;
+
+	const char* Schema = R"(
+		CREATE TABLE modules(id INTEGER PRIMARY KEY, path TEXT NOT NULL, package TEXT, name TEXT COLLATE NOCASE NOT NULL,
+			file_size INTEGER, machine INTEGER, is64 INTEGER, subsystem INTEGER, characteristics INTEGER, dll_characteristics INTEGER,
+			timestamp INTEGER, image_base INTEGER, entry_point INTEGER, export_name TEXT COLLATE NOCASE, toolchain TEXT);
+		CREATE TABLE edges(module_id INTEGER NOT NULL, dll TEXT COLLATE NOCASE NOT NULL, delayed INTEGER NOT NULL, target_id INTEGER);
+		CREATE TABLE imports(module_id INTEGER NOT NULL, dll TEXT COLLATE NOCASE NOT NULL, function TEXT, ordinal INTEGER, hint INTEGER, delayed INTEGER NOT NULL);
+		CREATE TABLE exports(module_id INTEGER NOT NULL, name TEXT, ordinal INTEGER NOT NULL, rva INTEGER, forwarder TEXT);
+		CREATE TABLE metadata(key TEXT PRIMARY KEY, value TEXT);
+	)";
+
+	const char* Indexes = R"(
+		CREATE INDEX modules_name ON modules(name);
+		CREATE INDEX edges_module ON edges(module_id);
+		CREATE INDEX edges_dll ON edges(dll);
+		CREATE INDEX imports_module ON imports(module_id);
+		CREATE INDEX imports_function ON imports(function, dll);
+		CREATE INDEX imports_dll ON imports(dll);
+		CREATE INDEX exports_module ON exports(module_id);
+		CREATE INDEX exports_name ON exports(name);
+		UPDATE edges SET target_id = (SELECT min(id) FROM modules WHERE modules.name = edges.dll);
+		CREATE INDEX edges_target ON edges(target_id);
+		ANALYZE;
+	)";
+
+	const char* StatementText[] = {
+		"INSERT INTO modules VALUES(?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)",
+		"INSERT INTO edges VALUES(?,?,?,NULL)",
+		"INSERT INTO imports VALUES(?,?,?,?,?,?)",
+		"INSERT INTO exports VALUES(?,?,?,?,?)",
+		"INSERT OR REPLACE INTO metadata VALUES(?,?)",
+	};
+
+	void BindText(sqlite3_stmt* stmt, int index, std::string_view text) {
+		if (text.empty())
+			sqlite3_bind_null(stmt, index);
+		else
+			sqlite3_bind_text(stmt, index, text.data(), (int)text.size(), SQLITE_STATIC);
+	}
+
+	void BindText(sqlite3_stmt* stmt, int index, std::wstring_view text) {
+		if (text.empty())
+			sqlite3_bind_null(stmt, index);
+		else
+			sqlite3_bind_text16(stmt, index, text.data(), (int)(text.size() * sizeof(wchar_t)), SQLITE_STATIC);
+	}
+}
+
+ScanDatabase::~ScanDatabase() {
+	Close();
+}
+
+bool ScanDatabase::Create(std::wstring const& path) {
+	Close();
+	if (!::DeleteFile(path.c_str()) && ::GetLastError() != ERROR_FILE_NOT_FOUND) {
+		m_Error = L"Cannot replace " + path;
+		return false;
+	}
+
+	if (sqlite3_open16(path.c_str(), &m_Db) != SQLITE_OK)
+		return Fail();
+
+	//
+	// a half written database is thrown away anyway, nothing needs to survive a crash
+	//
+	if (!Execute("PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF; PRAGMA locking_mode=EXCLUSIVE; PRAGMA temp_store=MEMORY; PRAGMA cache_size=-65536;")
+		|| !Execute(Schema) || !Execute("BEGIN"))
+		return false;
+
+	for (int i = 0; i < StatementCount; i++)
+		if (sqlite3_prepare_v2(m_Db, StatementText[i], -1, &m_Statements[i], nullptr) != SQLITE_OK)
+			return Fail();
+	return true;
+}
+
+void ScanDatabase::Close() {
+	for (auto& stmt : m_Statements) {
+		sqlite3_finalize(stmt);
+		stmt = nullptr;
+	}
+	if (m_Db)
+		sqlite3_close(m_Db);
+	m_Db = nullptr;
+	m_Modules = m_Rows = m_BatchRows = 0;
+}
+
+bool ScanDatabase::Add(PEFile const& pe) {
+	std::wstring_view package, entry;
+	BatchScanner::SplitPath(pe.GetPath(), package, entry);
+	auto slash = entry.find_last_of(L"\\/");
+	auto name = slash == std::wstring_view::npos ? entry : entry.substr(slash + 1);
+	auto toolchain = ModuleToolchain::FromPE(pe).ToString();
+
+	std::lock_guard lock(m_Lock);
+	if (m_Db == nullptr)
+		return false;
+
+	auto id = (sqlite3_int64)++m_Modules;
+	auto stmt = m_Statements[InsertModule];
+	sqlite3_bind_int64(stmt, 1, id);
+	BindText(stmt, 2, pe.GetPath());
+	BindText(stmt, 3, package);
+	BindText(stmt, 4, name);
+	sqlite3_bind_int64(stmt, 5, pe.GetFileSize());
+	for (int i = 6; i <= 13; i++)
+		sqlite3_bind_null(stmt, i);
+	if (auto nt = pe->GetNTHeader(); nt) {
+		auto is64 = pe->GetFileInfo()->IsPE64;
+		auto& fh = nt->NTHdr32.FileHeader;
+		sqlite3_bind_int(stmt, 6, fh.Machine);
+		sqlite3_bind_int(stmt, 7, is64);
+		sqlite3_bind_int(stmt, 8, is64 ? nt->NTHdr64.OptionalHeader.Subsystem : nt->NTHdr32.OptionalHeader.Subsystem);
+		sqlite3_bind_int(stmt, 9, fh.Characteristics);
+		sqlite3_bind_int(stmt, 10, is64 ? nt->NTHdr64.OptionalHeader.DllCharacteristics : nt->NTHdr32.OptionalHeader.DllCharacteristics);
+		sqlite3_bind_int64(stmt, 11, fh.TimeDateStamp);
+		sqlite3_bind_int64(stmt, 12, (sqlite3_int64)(is64 ? nt->NTHdr64.OptionalHeader.ImageBase : nt->NTHdr32.OptionalHeader.ImageBase));
+		sqlite3_bind_int64(stmt, 13, is64 ? nt->NTHdr64.OptionalHeader.AddressOfEntryPoint : nt->NTHdr32.OptionalHeader.AddressOfEntryPoint);
+	}
+	auto exports = pe->GetExport();
+	if (exports)
+		BindText(stmt, 14, exports->ModuleName);
+	else
+		sqlite3_bind_null(stmt, 14);
+	BindText(stmt, 15, toolchain);
+	if (!Step(stmt))
+		return false;
+
+	auto is64 = pe->GetFileInfo()->IsPE64;
+	auto addEdge = [&](std::string const& dll, bool delayed) {
+		auto stmt = m_Statements[InsertEdge];
+		sqlite3_bind_int64(stmt, 1, id);
+		BindText(stmt, 2, dll);
+		sqlite3_bind_int(stmt, 3, delayed);
+		return Step(stmt);
+	};
+	auto addImport = [&](std::string const& dll, std::string const& function, ULONGLONG thunk, WORD hint, bool delayed) {
+		auto stmt = m_Statements[InsertImport];
+		sqlite3_bind_int64(stmt, 1, id);
+		BindText(stmt, 2, dll);
+		auto byOrdinal = is64 ? IMAGE_SNAP_BY_ORDINAL64(thunk) : IMAGE_SNAP_BY_ORDINAL32(thunk);
+		if (byOrdinal) {
+			BindText(stmt, 3, OrdinalNames::Find(dll, (uint16_t)(thunk & 0xffff)));
+			sqlite3_bind_int(stmt, 4, (int)(thunk & 0xffff));
+			sqlite3_bind_null(stmt, 5);
+		}
+		else {
+			BindText(stmt, 3, function);
+			sqlite3_bind_null(stmt, 4);
+			sqlite3_bind_int(stmt, 5, hint);
+		}
+		sqlite3_bind_int(stmt, 6, delayed);
+		return Step(stmt);
+	};
+
+	if (auto imports = pe->GetImport(); imports) {
+		for (auto& lib : *imports) {
+			if (!addEdge(lib.ModuleName, false))
+				return false;
+			for (auto& func : lib.ImportFunc)
+				if (!addImport(lib.ModuleName, func.FuncName, is64 ? func.unThunk.Thunk64.u1.Ordinal : func.unThunk.Thunk32.u1.Ordinal, func.ImpByName.Hint, false))
+					return false;
+		}
+	}
+	if (auto delayed = pe->GetDelayImport(); delayed) {
+		for (auto& lib : *delayed) {
+			if (!addEdge(lib.ModuleName, true))
+				return false;
+			for (auto& func : lib.DelayImpFunc)
+				if (!addImport(lib.ModuleName, func.FuncName, is64 ? func.unThunk.st64.ImportNameTable.u1.Ordinal : func.unThunk.st32.ImportNameTable.u1.Ordinal, func.ImpByName.Hint, true))
+					return false;
+		}
+	}
+	if (exports) {
+		auto stmt = m_Statements[InsertExport];
+		for (auto& func : exports->Funcs) {
+			sqlite3_bind_int64(stmt, 1, id);
+			BindText(stmt, 2, func.FuncName);
+			sqlite3_bind_int64(stmt, 3, exports->ExportDesc.Base + func.Ordinal);
+			sqlite3_bind_int64(stmt, 4, func.FuncRVA);
+			BindText(stmt, 5, func.ForwarderName);
+			if (!Step(stmt))
+				return false;
+		}
+	}
+	return m_BatchRows < BatchRows || CommitBatch();
+}
+
+bool ScanDatabase::SetMetadata(std::string_view key, std::wstring_view value) {
+	std::lock_guard lock(m_Lock);
+	if (m_Db == nullptr)
+		return false;
+
+	auto stmt = m_Statements[InsertMetadata];
+	sqlite3_bind_text(stmt, 1, key.data(), (int)key.size(), SQLITE_STATIC);
+	BindText(stmt, 2, value);
+	return Step(stmt);
+}
+
+bool ScanDatabase::Finish() {
+	std::lock_guard lock(m_Lock);
+	if (m_Db == nullptr)
+		return false;
+
+	return Execute("COMMIT") && Execute(Indexes);
+}
+
+uint64_t ScanDatabase::GetModuleCount() const {
+	return m_Modules;
+}
+
+uint64_t ScanDatabase::GetRowCount() const {
+	return m_Rows;
+}
+
+std::wstring ScanDatabase::GetError() const {
+	return m_Error;
+}
+
+bool ScanDatabase::Execute(const char* sql) {
+	return sqlite3_exec(m_Db, sql, nullptr, nullptr, nullptr) == SQLITE_OK || Fail();
+}
+
+bool ScanDatabase::Step(sqlite3_stmt* stmt) {
+	auto rc = sqlite3_step(stmt);
+	sqlite3_reset(stmt);
+	if (rc != SQLITE_DONE)
+		return Fail();
+
+	m_Rows++;
+	m_BatchRows++;
+	return true;
+}
+
+bool ScanDatabase::Fail() {
+	//
+	// the first error is the interesting one
+	//
+	if (m_Error.empty())
+		m_Error = m_Db ? (PCWSTR)sqlite3_errmsg16(m_Db) : L"Cannot open the database";
+	return false;
+}
+
+bool ScanDatabase::CommitBatch() {
+	m_BatchRows = 0;
+	return Execute("COMMIT") && Execute("BEGIN");
+}
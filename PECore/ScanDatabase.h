@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "PEFile.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+//
+// batch scan results in a SQLite database (the winsqlite3 that comes with Windows), for ad-hoc SQL:
+//   modules(id, path, package, name, file_size, machine, is64, subsystem, characteristics, dll_characteristics,
+//           timestamp, image_base, entry_point, export_name, toolchain)
+//   edges(module_id, dll, delayed, target_id)		one per import descriptor, target_id - module of that name, if scanned
+//   imports(module_id, dll, function, ordinal, hint, delayed)	by ordinal: function from the bundled table (OrdinalNames) or NULL
+//   exports(module_id, name, ordinal, rva, forwarder)
+//   metadata(key, value)
+// Rows go in through prepared statements inside large transactions with the journal off;
+// the indexes are built and the edges resolved once the bulk load is done.
+//
+class ScanDatabase {
+public:
+	ScanDatabase() = default;
+	~ScanDatabase();
+
+	ScanDatabase(ScanDatabase const&) = delete;
+	ScanDatabase& operator=(ScanDatabase const&) = delete;
+
+	//
+	// an existing file is replaced
+	//
+	bool Create(std::wstring const& path);
+	void Close();
+
+	//
+	// thread safe, the scan workers add their modules as they go
+	//
+	bool Add(PEFile const& pe);
+	bool SetMetadata(std::string_view key, std::wstring_view value);
+
+	//
+	// commits the load, resolves the edges and builds the indexes
+	//
+	bool Finish();
+
+	uint64_t GetModuleCount() const;
+	uint64_t GetRowCount() const;
+	std::wstring GetError() const;
+
+private:
+	enum Statements {
+		InsertModule, InsertEdge, InsertImport, InsertExport, InsertMetadata, StatementCount
+	};
+
+	bool Execute(const char* sql);
+	bool Step(sqlite3_stmt* stmt);
+	bool Fail();
+	bool CommitBatch();
+
+	sqlite3* m_Db{ nullptr };
+	sqlite3_stmt* m_Statements[StatementCount]{};
+	std::mutex m_Lock;
+	uint64_t m_Modules{ 0 }, m_Rows{ 0 }, m_BatchRows{ 0 };
+	std::wstring m_Error;
+};
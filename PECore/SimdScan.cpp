@@ -0,0 +1,391 @@
+#include "pch.h"
+#include "SimdScan.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define SIMDSCAN_SSE2
+#endif
+
+namespace {
+#ifdef SIMDSCAN_SSE2
+	//
+	// the first block is aligned down and the bytes before str are shifted out of the mask;
+	// a hit past maxLen in the last block is clamped by the caller
+	//
+	size_t StrNLenSSE2(const uint8_t* p, size_t maxLen) {
+		auto zero = _mm_setzero_si128();
+		auto shift = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p) & 15);
+		auto block = p - shift;
+		uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero)) >> shift;
+		if (mask)
+			return std::countr_zero(mask);
+
+		for (size_t len = 16 - shift; len < maxLen; len += 16) {
+			block += 16;
+			mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero));
+			if (mask)
+				return len + std::countr_zero(mask);
+		}
+		return maxLen;
+	}
+
+	size_t StrNLenAVX2(const uint8_t* p, size_t maxLen) {
+		auto zero = _mm256_setzero_si256();
+		auto shift = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p) & 31);
+		auto block = p - shift;
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), zero))) >> shift;
+		if (mask)
+			return std::countr_zero(mask);
+
+		for (size_t len = 32 - shift; len < maxLen; len += 32) {
+			block += 32;
+			mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), zero));
+			if (mask)
+				return len + std::countr_zero(mask);
+		}
+		return maxLen;
+	}
+
+	//
+	// unaligned loads at p and p + 1, both inside the range; the caller finishes the last bytes
+	//
+	size_t FindPairSSE2(const uint8_t* p, size_t size, uint8_t first, uint8_t second1, uint8_t second2) {
+		auto v1 = _mm_set1_epi8(static_cast<char>(first));
+		auto v2 = _mm_set1_epi8(static_cast<char>(second1));
+		auto v3 = _mm_set1_epi8(static_cast<char>(second2));
+		size_t i = 0;
+		for (; i + 17 <= size; i += 16) {
+			auto next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 1));
+			auto hit = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), v1),
+				_mm_or_si128(_mm_cmpeq_epi8(next, v2), _mm_cmpeq_epi8(next, v3)));
+			if (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hit)); mask)
+				return i + std::countr_zero(mask);
+		}
+		return i;
+	}
+
+	size_t FindPairAVX2(const uint8_t* p, size_t size, uint8_t first, uint8_t second1, uint8_t second2) {
+		auto v1 = _mm256_set1_epi8(static_cast<char>(first));
+		auto v2 = _mm256_set1_epi8(static_cast<char>(second1));
+		auto v3 = _mm256_set1_epi8(static_cast<char>(second2));
+		size_t i = 0;
+		for (; i + 33 <= size; i += 32) {
+			auto next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 1));
+			auto hit = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), v1),
+				_mm256_or_si256(_mm256_cmpeq_epi8(next, v2), _mm256_cmpeq_epi8(next, v3)));
+			if (auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit)); mask)
+				return i + std::countr_zero(mask);
+		}
+		return i;
+	}
+
+	//
+	// 'A'-'Z' -> 'a'-'z'; the compares are signed, so bytes/words with the top bit set never fold
+	//
+	__m128i FoldBytes(__m128i v) {
+		auto upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), v));
+		return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+	}
+
+	__m128i FoldWords(__m128i v) {
+		auto upper = _mm_and_si128(_mm_cmpgt_epi16(v, _mm_set1_epi16('A' - 1)), _mm_cmpgt_epi16(_mm_set1_epi16('Z' + 1), v));
+		return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+	}
+
+	//
+	// 16 folded bytes at a time: the narrow name as is, the wide name folded and packed down,
+	// which keeps ASCII names hashing the same in both widths
+	//
+	__m128i LoadFolded16(const char* p) {
+		return FoldBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+	}
+
+	__m128i LoadFolded16(const wchar_t* p) {
+		auto lo = FoldWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+		auto hi = FoldWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8)));
+		return _mm_packus_epi16(lo, hi);
+	}
+
+	//
+	// mask of the equal (folded) bytes in a 16-byte block of each name
+	//
+	uint32_t EqualMask(const char* p1, const char* p2) {
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(LoadFolded16(p1), LoadFolded16(p2)));
+	}
+
+	uint32_t EqualMask(const wchar_t* p1, const wchar_t* p2) {
+		auto v1 = FoldWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p1)));
+		auto v2 = FoldWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p2)));
+		return _mm_movemask_epi8(_mm_cmpeq_epi16(v1, v2));
+	}
+#endif
+
+	template<typename TChar>
+	constexpr size_t BlockChars = 16 / sizeof(TChar);
+
+	template<typename TChar>
+	auto FoldChar(TChar c) {
+		auto u = static_cast<std::make_unsigned_t<TChar>>(c);
+		return u >= 'A' && u <= 'Z' ? static_cast<decltype(u)>(u | 0x20) : u;
+	}
+
+	//
+	// the byte a folded character contributes to the hash; matches _mm_packus_epi16
+	//
+	uint8_t HashByte(char c) {
+		return static_cast<uint8_t>(FoldChar(c));
+	}
+
+	uint8_t HashByte(wchar_t c) {
+		auto u = FoldChar(c);
+		return u >= 0x8000 ? 0 : u > 0xff ? 0xff : static_cast<uint8_t>(u);
+	}
+
+	//
+	// number of leading characters that are equal ignoring case
+	//
+	template<typename TChar>
+	size_t CommonPrefixNoCase(const TChar* s1, const TChar* s2, size_t count) {
+		size_t i = 0;
+#ifdef SIMDSCAN_SSE2
+		for (; i + BlockChars<TChar> <= count; i += BlockChars<TChar>) {
+			if (auto diff = ~EqualMask(s1 + i, s2 + i) & 0xffff; diff)
+				return i + std::countr_zero(diff) / sizeof(TChar);
+		}
+#endif
+		for (; i < count; i++)
+			if (FoldChar(s1[i]) != FoldChar(s2[i]))
+				break;
+		return i;
+	}
+
+	template<typename TChar>
+	int CompareNoCase(std::basic_string_view<TChar> s1, std::basic_string_view<TChar> s2) {
+		auto count = (std::min)(s1.size(), s2.size());
+		auto i = CommonPrefixNoCase(s1.data(), s2.data(), count);
+		if (i < count)
+			return FoldChar(s1[i]) < FoldChar(s2[i]) ? -1 : 1;
+		return s1.size() < s2.size() ? -1 : s1.size() > s2.size() ? 1 : 0;
+	}
+
+	template<typename TChar>
+	bool EqualsNoCase(std::basic_string_view<TChar> s1, std::basic_string_view<TChar> s2) {
+		return s1.size() == s2.size() && CommonPrefixNoCase(s1.data(), s2.data(), s1.size()) == s1.size();
+	}
+
+	uint64_t Mix(uint64_t h, uint64_t v) {
+		h = (h ^ v) * 0x9E3779B97F4A7C15ull;
+		return h ^ (h >> 29);
+	}
+
+	template<typename TChar>
+	uint64_t HashNoCase(std::basic_string_view<TChar> name) {
+		auto h = Mix(0xCBF29CE484222325ull, name.size());
+		auto p = name.data();
+		size_t i = 0;
+		uint64_t lanes[2];
+#ifdef SIMDSCAN_SSE2
+		for (; i + 16 <= name.size(); i += 16) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), LoadFolded16(p + i));
+			h = Mix(Mix(h, lanes[0]), lanes[1]);
+		}
+#endif
+		for (; i < name.size(); i += 16) {
+			uint8_t block[16]{};
+			for (size_t j = 0; j < 16 && i + j < name.size(); j++)
+				block[j] = HashByte(p[i + j]);
+			memcpy(lanes, block, sizeof(block));
+			h = Mix(Mix(h, lanes[0]), lanes[1]);
+		}
+		return h;
+	}
+}
+
+namespace SimdScan {
+	bool HasAVX2() {
+#ifdef SIMDSCAN_SSE2
+		static const bool avx2 = [] {
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			// OSXSAVE + AVX, and the OS saves YMM state
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+				return false;
+			if ((_xgetbv(0) & 6) != 6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}();
+		return avx2;
+#else
+		return false;
+#endif
+	}
+
+	void CountStridedFlagBits(const std::byte* table, uint32_t count, uint32_t stride, uint32_t flagOffset, uint32_t counts[8]) {
+		for (int b = 0; b < 8; b++)
+			counts[b] = 0;
+		if (table == nullptr || stride <= flagOffset)
+			return;
+
+		auto p = reinterpret_cast<const uint8_t*>(table) + flagOffset;
+		uint32_t i = 0;
+#ifdef SIMDSCAN_SSE2
+		//
+		// gather 16 flag bytes, then count every bit lane with one compare + movemask
+		//
+		alignas(16) uint8_t flags[16];
+		for (; i + 16 <= count; i += 16) {
+			for (int j = 0; j < 16; j++, p += stride)
+				flags[j] = *p;
+			auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(flags));
+			for (int b = 0; b < 8; b++) {
+				auto bit = _mm_set1_epi8(static_cast<char>(1 << b));
+				auto hit = _mm_cmpeq_epi8(_mm_and_si128(v, bit), bit);
+				counts[b] += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(hit)));
+			}
+		}
+#endif
+		for (; i < count; i++, p += stride) {
+			for (int b = 0; b < 8; b++)
+				counts[b] += (*p >> b) & 1;
+		}
+	}
+
+	void ByteHistogram(const std::byte* data, size_t size, uint32_t counts[256]) {
+		if (data == nullptr)
+			return;
+
+		uint32_t sub[4][256]{};
+		auto p = reinterpret_cast<const uint8_t*>(data);
+		size_t i = 0;
+		auto count4 = [&](uint32_t v) {
+			sub[0][v & 0xff]++;
+			sub[1][(v >> 8) & 0xff]++;
+			sub[2][(v >> 16) & 0xff]++;
+			sub[3][v >> 24]++;
+		};
+#ifdef SIMDSCAN_SSE2
+		//
+		// one 16-byte load, its dwords moved out of the register instead of 16 byte loads
+		//
+		for (; i + 16 <= size; i += 16) {
+			auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+			count4(static_cast<uint32_t>(_mm_cvtsi128_si32(v)));
+			count4(static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 4))));
+			count4(static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 8))));
+			count4(static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(v, 12))));
+		}
+#endif
+		for (; i + 4 <= size; i += 4) {
+			uint32_t v;
+			memcpy(&v, p + i, sizeof(v));
+			count4(v);
+		}
+		for (; i < size; i++)
+			sub[0][p[i]]++;
+
+		for (int b = 0; b < 256; b++)
+			counts[b] += sub[0][b] + sub[1][b] + sub[2][b] + sub[3][b];
+	}
+
+	double Entropy(const uint32_t counts[256]) {
+		uint64_t total = 0;
+		for (int b = 0; b < 256; b++)
+			total += counts[b];
+		if (total == 0)
+			return 0;
+
+		double entropy = 0;
+		for (int b = 0; b < 256; b++) {
+			if (counts[b]) {
+				auto p = static_cast<double>(counts[b]) / total;
+				entropy -= p * std::log2(p);
+			}
+		}
+		return entropy;
+	}
+
+	size_t StrNLen(const char* str, size_t maxLen) {
+		if (str == nullptr || maxLen == 0)
+			return 0;
+
+#ifdef SIMDSCAN_SSE2
+		auto p = reinterpret_cast<const uint8_t*>(str);
+		auto len = HasAVX2() ? StrNLenAVX2(p, maxLen) : StrNLenSSE2(p, maxLen);
+		return len < maxLen ? len : maxLen;
+#else
+		return strnlen(str, maxLen);
+#endif
+	}
+
+	size_t FindPair(const std::byte* data, size_t size, uint8_t first, uint8_t second) {
+		return FindPair(data, size, first, second, second);
+	}
+
+	size_t FindPair(const std::byte* data, size_t size, uint8_t first, uint8_t second1, uint8_t second2) {
+		if (data == nullptr || size < 2)
+			return size;
+
+		auto p = reinterpret_cast<const uint8_t*>(data);
+		size_t i = 0;
+#ifdef SIMDSCAN_SSE2
+		i = HasAVX2() ? FindPairAVX2(p, size, first, second1, second2) : FindPairSSE2(p, size, first, second1, second2);
+#endif
+		for (; i + 1 < size; i++)
+			if (p[i] == first && (p[i + 1] == second1 || p[i + 1] == second2))
+				return i;
+		return size;
+	}
+
+	int CompareNoCase(std::string_view s1, std::string_view s2) {
+		return ::CompareNoCase(s1, s2);
+	}
+
+	int CompareNoCase(std::wstring_view s1, std::wstring_view s2) {
+		return ::CompareNoCase(s1, s2);
+	}
+
+	bool EqualsNoCase(std::string_view s1, std::string_view s2) {
+		return ::EqualsNoCase(s1, s2);
+	}
+
+	bool EqualsNoCase(std::wstring_view s1, std::wstring_view s2) {
+		return ::EqualsNoCase(s1, s2);
+	}
+
+	uint64_t HashNoCase(std::string_view name) {
+		return ::HashNoCase(name);
+	}
+
+	uint64_t HashNoCase(std::wstring_view name) {
+		return ::HashNoCase(name);
+	}
+
+	bool IsApiSetName(std::wstring_view name) {
+		if (name.size() < 7)
+			return false;
+
+#ifdef SIMDSCAN_SSE2
+		if (name.size() >= 8) {
+			//
+			// one folded 8-character block against both prefixes; the 8th character is don't care
+			//
+			auto v = FoldWords(_mm_loadu_si128(reinterpret_cast<const __m128i*>(name.data())));
+			auto api = _mm_setr_epi16('a', 'p', 'i', '-', 'm', 's', '-', 0);
+			auto ext = _mm_setr_epi16('e', 'x', 't', '-', 'm', 's', '-', 0);
+			auto hit = _mm_movemask_epi8(_mm_cmpeq_epi16(v, api)) | (_mm_movemask_epi8(_mm_cmpeq_epi16(v, ext)) << 16);
+			return (hit & 0x3fff) == 0x3fff || (hit & 0x3fff0000) == 0x3fff0000;
+		}
+#endif
+		auto prefix = name.substr(0, 7);
+		return EqualsNoCase(prefix, L"api-ms-") || EqualsNoCase(prefix, L"ext-ms-");
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//
+// SSE2/AVX2 scanning kernels over mapped image data, with scalar fallbacks.
+// All functions only read inside the ranges they are given.
+//
+namespace SimdScan {
+	bool HasAVX2();
+
+	//
+	// counts[b] receives the number of entries in a strided table whose flag byte (at flagOffset
+	// inside each entry) has bit b set. Used for tables such as the GuardCFFunctionTable, where
+	// the flag byte follows a 4-byte RVA.
+	//
+	void CountStridedFlagBits(const std::byte* table, uint32_t count, uint32_t stride, uint32_t flagOffset, uint32_t counts[8]);
+
+	//
+	// strnlen: length of the zero terminated string, or maxLen if there is no terminator in the first maxLen bytes.
+	// Vector loads are aligned, so they never touch a page the range doesn't touch.
+	//
+	size_t StrNLen(const char* str, size_t maxLen);
+
+	//
+	// offset of the first occurrence of the byte pair (first, second), or size if there is none
+	//
+	size_t FindPair(const std::byte* data, size_t size, uint8_t first, uint8_t second);
+
+	//
+	// same, with first followed by either second1 or second2: FF 15 / FF 25 for call/jmp [mem]
+	//
+	size_t FindPair(const std::byte* data, size_t size, uint8_t first, uint8_t second1, uint8_t second2);
+
+	//
+	// counts[b] += occurrences of byte b. Four interleaved sub-histograms, so that runs
+	// of the same byte don't stall on one counter, are summed at the end.
+	//
+	void ByteHistogram(const std::byte* data, size_t size, uint32_t counts[256]);
+
+	//
+	// Shannon entropy of a byte histogram in bits per byte: 0 (constant) to 8 (random or compressed)
+	//
+	double Entropy(const uint32_t counts[256]);
+
+	//
+	// ASCII case-insensitive name compare and hash: only 'A'-'Z' fold, like _wcsicmp in the "C" locale,
+	// but without the locale lookups. Compare results order like _wcsicmp (<0, 0, >0).
+	//
+	int CompareNoCase(std::string_view s1, std::string_view s2);
+	int CompareNoCase(std::wstring_view s1, std::wstring_view s2);
+	bool EqualsNoCase(std::string_view s1, std::string_view s2);
+	bool EqualsNoCase(std::wstring_view s1, std::wstring_view s2);
+
+	//
+	// a wide name hashes the same as its narrow spelling when the name is ASCII,
+	// so import names (narrow) and module table keys (wide) can share one hash
+	//
+	uint64_t HashNoCase(std::string_view name);
+	uint64_t HashNoCase(std::wstring_view name);
+
+	//
+	// "api-ms-*" or "ext-ms-*" (any case): an api set contract rather than a file
+	//
+	bool IsApiSetName(std::wstring_view name);
+
+	struct NameHash {
+		size_t operator()(std::wstring_view name) const {
+			return static_cast<size_t>(HashNoCase(name));
+		}
+	};
+
+	struct NameEquals {
+		bool operator()(std::wstring_view s1, std::wstring_view s2) const {
+			return EqualsNoCase(s1, s2);
+		}
+	};
+
+	struct NameLess {
+		bool operator()(std::wstring_view s1, std::wstring_view s2) const {
+			return CompareNoCase(s1, s2) < 0;
+		}
+	};
+}
@@ -0,0 +1,60 @@
+#include "pch.h"
+#include "Startup.h"
+#include <format>
+
+namespace {
+	//
+	// .CRT$XCA/.CRT$XCZ and .CRT$XIA/.CRT$XIZ only hold the null sentinels bracketing the table
+	//
+	uint32_t CountInitializers(libpe::PEPogoEntry const& entry, std::string_view prefix, uint32_t ptrSize) {
+		std::string_view name(entry.Name);
+		if (!name.starts_with(prefix) || (name.size() == prefix.size() + 1 && (name.back() == 'A' || name.back() == 'Z')))
+			return 0;
+		return entry.Size / ptrSize;
+	}
+}
+
+ModuleStartup ModuleStartup::FromPE(PEFile const& pe) {
+	ModuleStartup s;
+	if (!pe || !pe->IsLoaded() || pe->GetNTHeader() == nullptr)
+		return s;
+
+	auto nt = pe->GetNTHeader();
+	auto is64 = pe->GetFileInfo()->IsPE64;
+	s.EntryPoint = is64 ? nt->NTHdr64.OptionalHeader.AddressOfEntryPoint : nt->NTHdr32.OptionalHeader.AddressOfEntryPoint;
+	s.IsDll = (nt->NTHdr32.FileHeader.Characteristics & IMAGE_FILE_DLL) != 0;
+
+	if (auto tls = pe->GetTLS(); tls)
+		s.TLSCallbacks = (uint32_t)tls->TLSCallbacks.size();
+
+	if (auto debug = pe->GetDebug(); debug) {
+		uint32_t ptrSize = is64 ? 8 : 4;
+		for (auto& d : *debug) {
+			if (d.DebugDir.Type != IMAGE_DEBUG_TYPE_POGO)
+				continue;
+			s.InitializersKnown = !d.DebugHdrInfo.PogoEntries.empty();
+			for (auto& entry : d.DebugHdrInfo.PogoEntries) {
+				s.CppInitializers += CountInitializers(entry, ".CRT$XC", ptrSize);
+				s.CInitializers += CountInitializers(entry, ".CRT$XI", ptrSize);
+			}
+		}
+	}
+	return s;
+}
+
+bool ModuleStartup::HasWork() const {
+	return EntryPoint || TLSCallbacks || CppInitializers || CInitializers;
+}
+
+std::wstring ModuleStartup::ToString() const {
+	std::wstring text;
+	if (EntryPoint)
+		text += IsDll ? L"DllMain " : L"Entry ";
+	if (TLSCallbacks)
+		text += std::format(L"TLS({}) ", TLSCallbacks);
+	if (CppInitializers + CInitializers)
+		text += std::format(L"Init({}) ", CppInitializers + CInitializers);
+	if (!text.empty())
+		text.pop_back();
+	return text;
+}
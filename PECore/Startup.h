@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include "PEFile.h"
+
+//
+// code a module runs while the process starts: TLS callbacks, the entry point (DllMain for DLLs)
+// and CRT static initializers, as far as the POGO debug entry names the .CRT$XC* / .CRT$XI* groups
+//
+struct ModuleStartup {
+	static ModuleStartup FromPE(PEFile const& pe);
+
+	std::wstring ToString() const;
+	bool HasWork() const;
+
+	DWORD EntryPoint{ 0 };				// RVA, 0 if none
+	uint32_t TLSCallbacks{ 0 };
+	uint32_t CppInitializers{ 0 };		// .CRT$XC* pointers (dynamic initializers of globals)
+	uint32_t CInitializers{ 0 };		// .CRT$XI* pointers
+	bool IsDll : 1{};
+	bool InitializersKnown : 1{};		// POGO entry present, initializer counts are meaningful
+};
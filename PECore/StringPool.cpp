@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "StringPool.h"
+#include <algorithm>
+
+namespace {
+	void PutVarint(std::vector<uint8_t>& out, uint32_t value) {
+		for (; value >= 0x80; value >>= 7)
+			out.push_back((uint8_t)(value | 0x80));
+		out.push_back((uint8_t)value);
+	}
+
+	void PutUInt32(std::vector<uint8_t>& out, uint32_t value) {
+		for (int i = 0; i < 4; i++, value >>= 8)
+			out.push_back((uint8_t)value);
+	}
+
+	bool GetUInt32(std::span<const uint8_t>& data, uint32_t& value) {
+		if (data.size() < 4)
+			return false;
+		value = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+		data = data.subspan(4);
+		return true;
+	}
+
+	//
+	// walks the entries of one block; every read is checked against the end of the block,
+	// so a damaged cache file ends the block early rather than reading past it
+	//
+	class BlockReader {
+	public:
+		BlockReader(uint8_t const* p, uint8_t const* end) : m_P(p), m_End(end) {}
+
+		bool Head(std::string_view& s) {
+			uint32_t size;
+			if (!Varint(size) || size > (size_t)(m_End - m_P))
+				return false;
+			s = std::string_view((char const*)m_P, size);
+			m_P += size;
+			return true;
+		}
+
+		bool Next(uint32_t& shared, std::string_view& suffix) {
+			return Varint(shared) && Head(suffix);
+		}
+
+	private:
+		bool Varint(uint32_t& value) {
+			value = 0;
+			for (int shift = 0; m_P < m_End && shift < 32; shift += 7) {
+				auto b = *m_P++;
+				value |= (uint32_t)(b & 0x7f) << shift;
+				if (b < 0x80)
+					return true;
+			}
+			return false;
+		}
+
+		uint8_t const* m_P;
+		uint8_t const* m_End;
+	};
+
+	size_t CommonPrefix(std::string_view s1, std::string_view s2) {
+		auto [it, _] = std::ranges::mismatch(s1, s2);
+		return it - s1.begin();
+	}
+}
+
+StringPool StringPool::Build(std::vector<std::string_view> strings) {
+	std::ranges::sort(strings);
+	strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+
+	StringPool pool;
+	pool.m_Count = (uint32_t)strings.size();
+	pool.m_Blocks.reserve((strings.size() + BlockSize - 1) / BlockSize);
+	std::string_view prev;
+	for (size_t i = 0; i < strings.size(); i++) {
+		auto s = strings[i];
+		size_t shared = 0;
+		if (i % BlockSize == 0)
+			pool.m_Blocks.push_back((uint32_t)pool.m_Bytes.size());
+		else
+			PutVarint(pool.m_Bytes, (uint32_t)(shared = CommonPrefix(prev, s)));
+		PutVarint(pool.m_Bytes, (uint32_t)(s.size() - shared));
+		pool.m_Bytes.insert(pool.m_Bytes.end(), s.begin() + shared, s.end());
+		prev = s;
+	}
+	pool.m_Bytes.shrink_to_fit();
+	return pool;
+}
+
+size_t StringPool::GetCount() const {
+	return m_Count;
+}
+
+size_t StringPool::GetSize() const {
+	return m_Bytes.size() + m_Blocks.size() * sizeof(uint32_t);
+}
+
+std::string StringPool::Get(size_t index) const {
+	std::string result;
+	ForEach(index, [&](auto, auto s) {
+		result = s;
+		return false;
+		});
+	return result;
+}
+
+size_t StringPool::Find(std::string_view s) const {
+	bool found;
+	auto index = Search(s, found);
+	return found ? index : NotFound;
+}
+
+size_t StringPool::LowerBound(std::string_view s) const {
+	bool found;
+	return Search(s, found);
+}
+
+size_t StringPool::Search(std::string_view s, bool& found) const {
+	found = false;
+	auto blockEnd = [&](size_t block) {
+		return m_Bytes.data() + (block + 1 < m_Blocks.size() ? m_Blocks[block + 1] : m_Bytes.size());
+	};
+	auto head = [&](size_t block) {
+		std::string_view h;
+		BlockReader(m_Bytes.data() + m_Blocks[block], blockEnd(block)).Head(h);
+		return h;
+	};
+
+	//
+	// the last block whose head isn't greater than s
+	//
+	size_t low = 0, high = m_Blocks.size();
+	while (low < high) {
+		auto mid = (low + high) / 2;
+		if (head(mid) <= s)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low == 0)
+		return 0;
+
+	auto block = low - 1;
+	auto index = block * BlockSize;
+	auto last = (std::min)(index + BlockSize, (size_t)m_Count);
+	BlockReader reader(m_Bytes.data() + m_Blocks[block], blockEnd(block));
+	std::string_view entry;
+	if (!reader.Head(entry))
+		return last;
+	if (entry == s) {
+		found = true;
+		return index;
+	}
+
+	//
+	// the previous entry is less than s and shares match bytes with it. An entry sharing more with the
+	// previous one is still less than s, one sharing fewer is greater; only an entry sharing exactly
+	// match bytes needs its suffix compared.
+	//
+	auto match = CommonPrefix(entry, s);
+	uint32_t shared;
+	while (++index < last && reader.Next(shared, entry)) {
+		if (shared > match)
+			continue;
+		if (shared < match)
+			return index;
+
+		auto rest = s.substr(match);
+		auto common = CommonPrefix(entry, rest);
+		if (common == entry.size() && common == rest.size()) {
+			found = true;
+			return index;
+		}
+		if (common == rest.size() || (common < entry.size() && (uint8_t)entry[common] > (uint8_t)rest[common]))
+			return index;
+		match += common;
+	}
+	return last;
+}
+
+void StringPool::ForEach(size_t index, std::function<bool(size_t index, std::string_view s)> const& fn) const {
+	std::string current;
+	for (auto block = index / BlockSize; block < m_Blocks.size(); block++) {
+		auto end = m_Bytes.data() + (block + 1 < m_Blocks.size() ? m_Blocks[block + 1] : m_Bytes.size());
+		BlockReader reader(m_Bytes.data() + m_Blocks[block], end);
+		std::string_view part;
+		if (!reader.Head(part))
+			return;
+
+		current = part;
+		auto last = (std::min)((block + 1) * BlockSize, (size_t)m_Count);
+		for (auto i = block * BlockSize; i < last; i++) {
+			uint32_t shared = 0;
+			if (i > block * BlockSize) {
+				if (!reader.Next(shared, part) || shared > current.size())
+					return;
+				current.resize(shared);
+				current += part;
+			}
+			if (i >= index && !fn(i, current))
+				return;
+		}
+	}
+}
+
+void StringPool::Save(std::vector<uint8_t>& out) const {
+	PutUInt32(out, m_Count);
+	PutUInt32(out, (uint32_t)m_Blocks.size());
+	PutUInt32(out, (uint32_t)m_Bytes.size());
+	for (auto offset : m_Blocks)
+		PutUInt32(out, offset);
+	out.insert(out.end(), m_Bytes.begin(), m_Bytes.end());
+}
+
+bool StringPool::Load(std::span<const uint8_t>& data) {
+	uint32_t count, blocks, bytes;
+	if (!GetUInt32(data, count) || !GetUInt32(data, blocks) || !GetUInt32(data, bytes)
+		|| blocks != (count + (uint64_t)BlockSize - 1) / BlockSize || data.size() < blocks * 4ull + bytes)
+		return false;
+
+	std::vector<uint32_t> offsets(blocks);
+	for (uint32_t i = 0; i < blocks; i++) {
+		GetUInt32(data, offsets[i]);
+		if (offsets[i] >= bytes || (i > 0 && offsets[i] <= offsets[i - 1]))
+			return false;
+	}
+
+	m_Count = count;
+	m_Blocks = std::move(offsets);
+	m_Bytes.assign(data.begin(), data.begin() + bytes);
+	data = data.subspan(bytes);
+	return true;
+}
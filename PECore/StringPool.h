@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// read-only pool of distinct byte strings in sorted order, front coded: blocks of BlockSize strings,
+// each block starting with a whole string, every other one stored as the length of the prefix it shares
+// with the one before plus the rest. Sorted symbol names share long prefixes (Rtl, Nt, ?...@@), so the
+// pool takes a fraction of the plain strings. A lookup is a binary search over the block heads and one
+// pass over a block that compares in place, without decoding anything. String i is the i-th in order.
+//
+class StringPool {
+public:
+	static constexpr size_t NotFound = SIZE_MAX;
+	static constexpr uint32_t BlockSize = 16;
+
+	//
+	// sorted and made distinct first
+	//
+	static StringPool Build(std::vector<std::string_view> strings);
+
+	size_t GetCount() const;
+	size_t GetSize() const;								// encoded bytes and the block index
+
+	std::string Get(size_t index) const;
+	size_t Find(std::string_view s) const;				// index or NotFound
+	size_t LowerBound(std::string_view s) const;		// first string not less than s, GetCount() if none
+
+	//
+	// strings from index on, in order, until fn returns false; the view is only good during the call
+	//
+	void ForEach(size_t index, std::function<bool(size_t index, std::string_view s)> const& fn) const;
+
+	//
+	// flat layout for caches on disk; Load takes its part off the front of data and checks it
+	//
+	void Save(std::vector<uint8_t>& out) const;
+	bool Load(std::span<const uint8_t>& data);
+
+private:
+	size_t Search(std::string_view s, bool& found) const;
+
+	std::vector<uint8_t> m_Bytes;
+	std::vector<uint32_t> m_Blocks;		// offset of each block in m_Bytes
+	uint32_t m_Count{ 0 };
+};
@@ -0,0 +1,190 @@
+#include "pch.h"
+#include "StructureMap.h"
+#include <algorithm>
+#include <queue>
+#include <set>
+
+namespace {
+	PCWSTR const DirectoryNames[IMAGE_NUMBEROF_DIRECTORY_ENTRIES] = {
+		L"Export directory", L"Import directory", L"Resources", L"Exception table", L"Certificates", L"Base relocations",
+		L"Debug directory", L"Architecture", L"Global pointer", L"TLS directory", L"Load configuration", L"Bound imports",
+		L"Import address table", L"Delay imports", L"CLR header", L"Reserved",
+	};
+
+	std::wstring Widen(std::string_view text) {
+		std::wstring result(::MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), nullptr, 0), L'\0');
+		::MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), result.data(), (int)result.size());
+		return result;
+	}
+}
+
+StructureMap StructureMap::Build(PEFile const& pe) {
+	StructureMap map;
+	if (!pe || !pe->IsLoaded())
+		return map;
+
+	auto dos = pe->GetMSDOSHeader();
+	map.Add(0, sizeof(IMAGE_DOS_HEADER), L"DOS header");
+	if (dos && dos->e_lfanew > (LONG)sizeof(IMAGE_DOS_HEADER))
+		map.Add(sizeof(IMAGE_DOS_HEADER), dos->e_lfanew - sizeof(IMAGE_DOS_HEADER), L"DOS stub");
+
+	auto is64 = pe->GetFileInfo()->IsPE64;
+	if (auto nt = pe->GetNTHeader(); nt) {
+		auto offset = nt->dwOffset;
+		auto optional = nt->NTHdr32.FileHeader.SizeOfOptionalHeader;
+		map.Add(offset, sizeof(DWORD) + sizeof(IMAGE_FILE_HEADER) + optional, L"NT headers");
+		map.Add(offset, sizeof(DWORD), L"Signature");
+		map.Add(offset + sizeof(DWORD), sizeof(IMAGE_FILE_HEADER), L"File header");
+		map.Add(offset + sizeof(DWORD) + sizeof(IMAGE_FILE_HEADER), optional, L"Optional header");
+		auto dirs = is64 ? nt->NTHdr64.OptionalHeader.NumberOfRvaAndSizes : nt->NTHdr32.OptionalHeader.NumberOfRvaAndSizes;
+		map.Add(offset + (uint32_t)(is64 ? offsetof(IMAGE_NT_HEADERS64, OptionalHeader.DataDirectory) : offsetof(IMAGE_NT_HEADERS32, OptionalHeader.DataDirectory)),
+			(std::min)(dirs, (DWORD)IMAGE_NUMBEROF_DIRECTORY_ENTRIES) * sizeof(IMAGE_DATA_DIRECTORY), L"Data directories");
+	}
+
+	uint64_t rawEnd = 0;
+	if (auto sections = pe->GetSecHeaders(); sections && !sections->empty()) {
+		map.Add(sections->front().Offset, (uint32_t)(sections->size() * sizeof(IMAGE_SECTION_HEADER)), L"Section headers");
+		for (auto& section : *sections) {
+			auto name = Widen(section.SectionName);
+			map.Add(section.Offset, sizeof(IMAGE_SECTION_HEADER), name);
+			auto& header = section.SecHdr;
+			if (header.SizeOfRawData) {
+				map.Add(header.PointerToRawData, header.SizeOfRawData, L"Section " + name);
+				rawEnd = (std::max)(rawEnd, (uint64_t)header.PointerToRawData + header.SizeOfRawData);
+			}
+		}
+	}
+	if (rawEnd && rawEnd < pe.GetFileSize())
+		map.Add((uint32_t)rawEnd, pe.GetFileSize() - (uint32_t)rawEnd, L"Overlay");
+
+	if (auto dirs = pe->GetDataDirs(); dirs) {
+		for (size_t i = 0; i < dirs->size() && i < IMAGE_NUMBEROF_DIRECTORY_ENTRIES; i++) {
+			auto& dir = (*dirs)[i].DataDir;
+			if (dir.VirtualAddress == 0 || dir.Size == 0)
+				continue;
+			//
+			// the certificate table is the one directory given as a file offset
+			//
+			auto offset = i == IMAGE_DIRECTORY_ENTRY_SECURITY ? dir.VirtualAddress : pe->GetOffsetFromRVA(dir.VirtualAddress);
+			if (offset)
+				map.Add(offset, dir.Size, DirectoryNames[i]);
+		}
+	}
+
+	if (auto exports = pe->GetExport(); exports) {
+		auto& desc = exports->ExportDesc;
+		map.Add(exports->Offset, sizeof(IMAGE_EXPORT_DIRECTORY), L"Export descriptor");
+		if (auto offset = pe->GetOffsetFromRVA(desc.AddressOfFunctions); offset)
+			map.Add(offset, desc.NumberOfFunctions * sizeof(DWORD), L"Export address table");
+		if (auto offset = pe->GetOffsetFromRVA(desc.AddressOfNames); offset)
+			map.Add(offset, desc.NumberOfNames * sizeof(DWORD), L"Export name pointers");
+		if (auto offset = pe->GetOffsetFromRVA(desc.AddressOfNameOrdinals); offset)
+			map.Add(offset, desc.NumberOfNames * sizeof(WORD), L"Export ordinals");
+	}
+
+	if (auto imports = pe->GetImport(); imports) {
+		uint32_t thunk = is64 ? sizeof(IMAGE_THUNK_DATA64) : sizeof(IMAGE_THUNK_DATA32);
+		for (auto& lib : *imports) {
+			auto name = Widen(lib.ModuleName);
+			auto thunks = (uint32_t)(lib.ImportFunc.size() + 1) * thunk;
+			map.Add(lib.Offset, sizeof(IMAGE_IMPORT_DESCRIPTOR), name + L" descriptor");
+			if (auto offset = pe->GetOffsetFromRVA(lib.ImportDesc.Name); offset)
+				map.Add(offset, (uint32_t)lib.ModuleName.size() + 1, name + L" name");
+			if (auto offset = lib.ImportDesc.OriginalFirstThunk ? pe->GetOffsetFromRVA(lib.ImportDesc.OriginalFirstThunk) : 0; offset)
+				map.Add(offset, thunks, name + L" lookup thunks");
+			if (auto offset = pe->GetOffsetFromRVA(lib.ImportDesc.FirstThunk); offset)
+				map.Add(offset, thunks, name + L" address thunks");
+		}
+	}
+
+	map.Index(pe.GetFileSize());
+	return map;
+}
+
+std::vector<StructureMap::Range> const& StructureMap::GetRanges() const {
+	return m_Ranges;
+}
+
+uint32_t StructureMap::Find(uint32_t offset) const {
+	auto it = std::ranges::upper_bound(m_Segments, offset, {}, &Segment::Offset);
+	return it == m_Segments.begin() ? NoRange : (it - 1)->Range;
+}
+
+uint32_t StructureMap::FindStart(uint32_t offset, uint32_t end) const {
+	auto it = std::ranges::upper_bound(m_Ranges, offset, {}, &Range::Offset);
+	return it != m_Ranges.end() && it->Offset < end ? (uint32_t)(it - m_Ranges.begin()) : NoRange;
+}
+
+std::wstring StructureMap::GetPath(uint32_t range) const {
+	std::vector<std::wstring_view> names;
+	for (; range != NoRange; range = m_Ranges[range].Parent)
+		names.push_back(m_Ranges[range].Name);
+
+	std::wstring path;
+	for (auto it = names.rbegin(); it != names.rend(); ++it)
+		path.append(path.empty() ? L"" : L" > ").append(*it);
+	return path;
+}
+
+void StructureMap::Add(uint32_t offset, uint32_t size, std::wstring name) {
+	if (size)
+		m_Ranges.push_back({ offset, size, std::move(name) });
+}
+
+void StructureMap::Index(uint64_t fileSize) {
+	//
+	// clipped to the file, outer ranges before the ranges they contain
+	//
+	std::erase_if(m_Ranges, [&](auto& r) { return r.Offset >= fileSize; });
+	for (auto& r : m_Ranges)
+		r.Size = (uint32_t)(std::min)((uint64_t)r.Size, fileSize - r.Offset);
+	std::ranges::stable_sort(m_Ranges, [](auto& r1, auto& r2) {
+		return r1.Offset != r2.Offset ? r1.Offset < r2.Offset : r1.Size > r2.Size;
+		});
+
+	auto end = [&](uint32_t i) { return (uint64_t)m_Ranges[i].Offset + m_Ranges[i].Size; };
+	std::vector<uint32_t> open;
+	for (uint32_t i = 0; i < m_Ranges.size(); i++) {
+		while (!open.empty() && end(open.back()) <= m_Ranges[i].Offset)
+			open.pop_back();
+		for (auto it = open.rbegin(); it != open.rend(); ++it)
+			if (end(*it) >= end(i)) {
+				m_Ranges[i].Parent = *it;
+				break;
+			}
+		open.push_back(i);
+	}
+
+	//
+	// sweep over the range boundaries; the smallest range open at a boundary names the segment after it,
+	// among equal sizes the one added last
+	//
+	std::vector<uint64_t> bounds{ 0 };
+	for (uint32_t i = 0; i < m_Ranges.size(); i++) {
+		bounds.push_back(m_Ranges[i].Offset);
+		bounds.push_back(end(i));
+	}
+	std::ranges::sort(bounds);
+	bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+	std::set<std::pair<uint32_t, uint32_t>> active;		// size, NoRange - index
+	std::priority_queue<std::pair<uint64_t, uint32_t>, std::vector<std::pair<uint64_t, uint32_t>>, std::greater<>> ends;
+	m_Segments.clear();
+	uint32_t next = 0;
+	for (auto bound : bounds) {
+		if (bound >= fileSize && !m_Segments.empty())
+			break;
+		while (!ends.empty() && ends.top().first <= bound) {
+			auto i = ends.top().second;
+			active.erase({ m_Ranges[i].Size, NoRange - i });
+			ends.pop();
+		}
+		for (; next < m_Ranges.size() && m_Ranges[next].Offset == bound; next++) {
+			active.insert({ m_Ranges[next].Size, NoRange - next });
+			ends.push({ end(next), next });
+		}
+		auto range = active.empty() ? NoRange : NoRange - active.begin()->second;
+		if (m_Segments.empty() || m_Segments.back().Range != range)
+			m_Segments.push_back({ (uint32_t)bound, range });
+	}
+}
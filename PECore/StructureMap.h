@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PEFile.h"
+
+//
+// file ranges of an image's structures (headers, sections, data directories, import descriptors and
+// thunks) for annotating a raw view of the file. Ranges nest; the index is a flat list of segments that
+// don't overlap, each naming the innermost range covering it, so naming an offset is one binary search.
+//
+class StructureMap {
+public:
+	static constexpr uint32_t NoRange = UINT32_MAX;
+
+	struct Range {
+		uint32_t Offset;
+		uint32_t Size;
+		std::wstring Name;
+		uint32_t Parent{ NoRange };		// innermost range containing this one
+	};
+
+	static StructureMap Build(PEFile const& pe);
+
+	std::vector<Range> const& GetRanges() const;
+
+	//
+	// innermost range covering offset, NoRange if none does
+	//
+	uint32_t Find(uint32_t offset) const;
+
+	//
+	// first range starting after offset and before end, NoRange if none does
+	//
+	uint32_t FindStart(uint32_t offset, uint32_t end) const;
+
+	//
+	// "Sections > .text", outermost first
+	//
+	std::wstring GetPath(uint32_t range) const;
+
+private:
+	void Add(uint32_t offset, uint32_t size, std::wstring name);
+	void Index(uint64_t fileSize);
+
+	struct Segment {
+		uint32_t Offset;
+		uint32_t Range;					// NoRange for bytes nothing covers
+	};
+
+	std::vector<Range> m_Ranges;		// by offset, then outer before inner
+	std::vector<Segment> m_Segments;	// by offset, the last one runs to the end of the file
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+//
+// lazy coroutine result: the body starts when the task is awaited (or started with a completion
+// callback) and resumes its awaiter when it's done, on whatever thread it finished on
+//
+template<typename T>
+class Task {
+public:
+	struct promise_type {
+		Task get_return_object() {
+			return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+		auto final_suspend() noexcept {
+			struct FinalAwaiter {
+				bool await_ready() noexcept {
+					return false;
+				}
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+					auto continuation = h.promise().Continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+				void await_resume() noexcept {}
+			};
+			return FinalAwaiter{};
+		}
+		void return_value(T value) {
+			Value = std::move(value);
+		}
+		void unhandled_exception() {
+			Error = std::current_exception();
+		}
+
+		std::optional<T> Value;
+		std::exception_ptr Error;
+		std::coroutine_handle<> Continuation;
+	};
+
+	Task(Task&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+	Task(Task const&) = delete;
+	Task& operator=(Task const&) = delete;
+	~Task() {
+		if (m_Handle)
+			m_Handle.destroy();
+	}
+
+	bool await_ready() const noexcept {
+		return false;
+	}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+		m_Handle.promise().Continuation = awaiter;
+		return m_Handle;
+	}
+	T await_resume() {
+		auto& promise = m_Handle.promise();
+		if (promise.Error)
+			std::rethrow_exception(promise.Error);
+		return std::move(*promise.Value);
+	}
+
+	//
+	// for callers that don't use coroutines: runs the task detached, completion gets its result
+	//
+	void Start(std::function<void(T)> completion) && {
+		Run(std::move(*this), std::move(completion));
+	}
+
+private:
+	struct Detached {
+		struct promise_type {
+			Detached get_return_object() {
+				return {};
+			}
+			std::suspend_never initial_suspend() noexcept {
+				return {};
+			}
+			std::suspend_never final_suspend() noexcept {
+				return {};
+			}
+			void return_void() {}
+			void unhandled_exception() {
+				std::terminate();
+			}
+		};
+	};
+
+	static Detached Run(Task task, std::function<void(T)> completion) {
+		completion(co_await task);
+	}
+
+	explicit Task(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+
+	std::coroutine_handle<promise_type> m_Handle;
+};
@@ -0,0 +1,336 @@
+#include "pch.h"
+#include "Toolchain.h"
+#include <array>
+#include <algorithm>
+#include <format>
+#include <map>
+
+namespace {
+	using Toolchain::Tool;
+	using Toolchain::Release;
+
+	constexpr WORD MaxProductId = 0x0200;
+
+	//
+	// product ids before VS2015 identify the release on their own
+	//
+	enum LegacyRelease : uint8_t {
+		RelUnknown, RelVS6, RelVS2002, RelVS2003, RelVS2005, RelVS2008, RelVS2010, RelVS2012, RelVS2013, RelMSVC14,
+	};
+
+	constexpr Release LegacyReleases[] = {
+		{ 0, L"", L"" },
+		{ 0, L"VS6 or older", L"6.0" },
+		{ 0, L"VS2002", L"7.0" },
+		{ 0, L"VS2003", L"7.1" },
+		{ 0, L"VS2005", L"8.0" },
+		{ 0, L"VS2008", L"9.0" },
+		{ 0, L"VS2010", L"10.0" },
+		{ 0, L"VS2012", L"11.0" },
+		{ 0, L"VS2013", L"12.0" },
+	};
+
+	constexpr struct {
+		WORD First;
+		LegacyRelease Release;
+	} ReleaseRanges[] = {
+		{ 0x0000, RelUnknown }, { 0x0002, RelVS6 }, { 0x0019, RelVS2002 }, { 0x005A, RelVS2003 }, { 0x006D, RelVS2005 },
+		{ 0x0083, RelVS2008 }, { 0x0098, RelVS2010 }, { 0x00C7, RelVS2012 }, { 0x00D9, RelVS2013 }, { 0x00FD, RelMSVC14 },
+	};
+
+	//
+	// MSVC 14.x shares one set of product ids, the releases are told apart by build number
+	//
+	constexpr Release Builds[] = {
+		{ 0, L"VS2015", L"14.0" },
+		{ 23506, L"VS2015 Update 1", L"14.0" },
+		{ 23918, L"VS2015 Update 2", L"14.0" },
+		{ 24123, L"VS2015 Update 3", L"14.0" },
+		{ 25017, L"VS2017 15.0", L"14.10" },
+		{ 25506, L"VS2017 15.3", L"14.11" },
+		{ 25830, L"VS2017 15.5", L"14.12" },
+		{ 26128, L"VS2017 15.6", L"14.13" },
+		{ 26428, L"VS2017 15.7", L"14.14" },
+		{ 26726, L"VS2017 15.8", L"14.15" },
+		{ 27023, L"VS2017 15.9", L"14.16" },
+		{ 27508, L"VS2019 16.0", L"14.20" },
+		{ 27702, L"VS2019 16.1", L"14.21" },
+		{ 27905, L"VS2019 16.2", L"14.22" },
+		{ 28105, L"VS2019 16.3", L"14.23" },
+		{ 28314, L"VS2019 16.4", L"14.24" },
+		{ 28610, L"VS2019 16.5", L"14.25" },
+		{ 28805, L"VS2019 16.6", L"14.26" },
+		{ 29110, L"VS2019 16.7", L"14.27" },
+		{ 29333, L"VS2019 16.8", L"14.28" },
+		{ 29910, L"VS2019 16.9", L"14.28" },
+		{ 30037, L"VS2019 16.10", L"14.29" },
+		{ 30133, L"VS2019 16.11", L"14.29" },
+		{ 30705, L"VS2022 17.0", L"14.30" },
+		{ 31104, L"VS2022 17.1", L"14.31" },
+		{ 31328, L"VS2022 17.2", L"14.32" },
+		{ 31629, L"VS2022 17.3", L"14.33" },
+		{ 31933, L"VS2022 17.4", L"14.34" },
+		{ 32215, L"VS2022 17.5", L"14.35" },
+		{ 32532, L"VS2022 17.6", L"14.36" },
+		{ 32822, L"VS2022 17.7", L"14.37" },
+		{ 33130, L"VS2022 17.8", L"14.38" },
+		{ 33519, L"VS2022 17.9", L"14.39" },
+		{ 33808, L"VS2022 17.10", L"14.40" },
+		{ 34120, L"VS2022 17.11", L"14.41" },
+		{ 34433, L"VS2022 17.12", L"14.42" },
+		{ 34808, L"VS2022 17.13", L"14.43" },
+		{ 35207, L"VS2022 17.14", L"14.44" },
+	};
+	static_assert(std::ranges::is_sorted(Builds, {}, &Release::MinBuild));
+
+	//
+	// from VS2010 on every release allocates the same run of tools, then the same run of compilers
+	//
+	constexpr Tool LinkerTools[] = {
+		Tool::AliasObj, Tool::Cvtpgd, Tool::Cvtres, Tool::Export, Tool::Implib, Tool::Linker, Tool::Masm,
+	};
+	constexpr Tool CompilerTools[] = {
+		Tool::C, Tool::Cpp, Tool::CvtCilC, Tool::CvtCilCpp, Tool::LtcgC, Tool::LtcgCpp, Tool::LtcgMsil,
+		Tool::PogoInstrumentC, Tool::PogoInstrumentCpp, Tool::PogoOptimizeC, Tool::PogoOptimizeCpp,
+	};
+
+	constexpr struct {
+		WORD Tools, Compilers;
+	} StandardBlocks[] = {
+		{ 0x0098, 0x00AA },		// VS2010
+		{ 0x00C7, 0x00CE },		// VS2012
+		{ 0x00D9, 0x00E0 },		// VS2013
+		{ 0x00FD, 0x0104 },		// VS2015 and later
+	};
+
+	constexpr struct {
+		WORD FirstCompiler;		// C, C++, then the rest of CompilerTools
+		WORD Linker, Export, Implib, Cvtres, Masm;
+	} OlderBlocks[] = {
+		{ 0x005F, 0x005A, 0x005C, 0x005D, 0x005E, 0x000F },		// VS2003
+		{ 0x006D, 0x0078, 0x007A, 0x007B, 0x007C, 0x007D },		// VS2005
+		{ 0x0083, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095 },		// VS2008
+	};
+
+	struct ProductEntry {
+		Tool Kind{ Tool::Unknown };
+		LegacyRelease Release{ RelUnknown };
+	};
+
+	constexpr auto ProductTable = [] {
+		std::array<ProductEntry, MaxProductId> table{};
+
+		size_t range = 0;
+		for (WORD id = 0; id < MaxProductId; id++) {
+			while (range + 1 < std::size(ReleaseRanges) && ReleaseRanges[range + 1].First <= id)
+				range++;
+			table[id].Release = ReleaseRanges[range].Release;
+		}
+
+		for (auto& block : StandardBlocks) {
+			for (size_t i = 0; i < std::size(LinkerTools); i++)
+				table[block.Tools + i].Kind = LinkerTools[i];
+			for (size_t i = 0; i < std::size(CompilerTools); i++)
+				table[block.Compilers + i].Kind = CompilerTools[i];
+		}
+
+		for (auto& block : OlderBlocks) {
+			// VS2003 has no CIL/LTCG/POGO flavors at the same offsets
+			auto count = block.FirstCompiler == 0x005F ? 2 : std::size(CompilerTools);
+			for (size_t i = 0; i < count; i++)
+				table[block.FirstCompiler + i].Kind = CompilerTools[i];
+			table[block.Linker].Kind = Tool::Linker;
+			table[block.Export].Kind = Tool::Export;
+			table[block.Implib].Kind = Tool::Implib;
+			table[block.Cvtres].Kind = Tool::Cvtres;
+			table[block.Masm].Kind = Tool::Masm;
+		}
+
+		// VS6 / VS2002
+		table[0x0001].Kind = Tool::Import;
+		table[0x0002].Kind = Tool::Linker;
+		table[0x0004].Kind = Tool::Linker;
+		table[0x0006].Kind = Tool::Cvtres;
+		table[0x0007].Kind = Tool::Basic;
+		table[0x0008].Kind = Tool::C;
+		table[0x0009].Kind = Tool::Basic;
+		table[0x000A].Kind = Tool::C;
+		table[0x000B].Kind = Tool::Cpp;
+		table[0x000E].Kind = Tool::Masm;
+		table[0x0012].Kind = Tool::Masm;
+		table[0x0013].Kind = Tool::Linker;
+		table[0x0019].Kind = Tool::Implib;
+		table[0x001C].Kind = Tool::C;
+		table[0x001D].Kind = Tool::Cpp;
+		table[0x003D].Kind = Tool::Linker;
+		table[0x003F].Kind = Tool::Export;
+		table[0x0045].Kind = Tool::Cvtres;
+
+		return table;
+	}();
+
+	static_assert(ProductTable[0x0102].Kind == Tool::Linker && ProductTable[0x0105].Kind == Tool::Cpp);
+	static_assert(ProductTable[0x0093].Kind == Tool::Implib && ProductTable[0x0093].Release == RelVS2008);
+}
+
+Tool Toolchain::GetTool(WORD productId) {
+	return productId < MaxProductId ? ProductTable[productId].Kind : Tool::Unknown;
+}
+
+bool Toolchain::IsCompiler(Tool tool) {
+	return tool >= Tool::C;
+}
+
+PCWSTR Toolchain::ToolToString(Tool tool) {
+	switch (tool) {
+		case Tool::Import: return L"Import";
+		case Tool::Linker: return L"Linker";
+		case Tool::Export: return L"Export";
+		case Tool::Implib: return L"Implib";
+		case Tool::Cvtres: return L"Cvtres";
+		case Tool::Masm: return L"MASM";
+		case Tool::AliasObj: return L"AliasObj";
+		case Tool::Cvtpgd: return L"Cvtpgd";
+		case Tool::Basic: return L"Basic";
+		case Tool::C: return L"C";
+		case Tool::Cpp: return L"C++";
+		case Tool::CvtCilC: return L"C (CIL)";
+		case Tool::CvtCilCpp: return L"C++ (CIL)";
+		case Tool::LtcgC: return L"C (LTCG)";
+		case Tool::LtcgCpp: return L"C++ (LTCG)";
+		case Tool::LtcgMsil: return L"MSIL (LTCG)";
+		case Tool::PogoInstrumentC: return L"C (PGI)";
+		case Tool::PogoInstrumentCpp: return L"C++ (PGI)";
+		case Tool::PogoOptimizeC: return L"C (PGO)";
+		case Tool::PogoOptimizeCpp: return L"C++ (PGO)";
+	}
+	return L"Unknown";
+}
+
+Release const& Toolchain::GetRelease(WORD productId, WORD build) {
+	if (productId >= MaxProductId)
+		return LegacyReleases[RelUnknown];
+
+	auto release = ProductTable[productId].Release;
+	if (release != RelMSVC14)
+		return LegacyReleases[release];
+
+	auto it = std::ranges::upper_bound(Builds, build, {}, &Release::MinBuild);
+	return *(it - 1);
+}
+
+ModuleToolchain ModuleToolchain::FromPE(PEFile const& pe) {
+	ModuleToolchain tc;
+	if (!pe || !pe->IsLoaded())
+		return tc;
+
+	auto rich = pe->GetRichHeader();
+	if (rich == nullptr || rich->empty())
+		return tc;
+
+	tc.HasRichHeader = true;
+	uint32_t top = 0;
+	for (auto& entry : *rich) {
+		auto tool = Toolchain::GetTool(entry.wId);
+		if (tool == Toolchain::Tool::Linker) {
+			if (entry.wVersion >= tc.LinkerBuild) {
+				tc.LinkerId = entry.wId;
+				tc.LinkerBuild = entry.wVersion;
+			}
+		}
+		else if (Toolchain::IsCompiler(tool)) {
+			tc.Objects += entry.dwCount;
+			if (tc.CompilerId && tc.CompilerBuild != entry.wVersion)
+				tc.MixedCompilers = true;
+			if (entry.dwCount > top) {
+				top = entry.dwCount;
+				tc.CompilerId = entry.wId;
+				tc.CompilerBuild = entry.wVersion;
+			}
+		}
+	}
+	return tc;
+}
+
+std::wstring ModuleToolchain::ToString() const {
+	auto id = LinkerId ? LinkerId : CompilerId;
+	auto build = LinkerId ? LinkerBuild : CompilerBuild;
+	if (id == 0)
+		return L"";
+
+	auto& release = Toolchain::GetRelease(id, build);
+	if (*release.VisualStudio == 0)
+		return std::format(L"Build {}", build);
+	return std::format(L"{} ({}.{})", release.VisualStudio, release.Toolset, build);
+}
+
+void ToolchainHistogram::Add(libpe::PERICHHDR_VEC const* rich) {
+	m_Modules++;
+	if (rich == nullptr || rich->empty()) {
+		m_NoRichHeader++;
+		return;
+	}
+	for (auto& entry : *rich) {
+		auto& counters = m_Counts[(uint32_t)entry.wId << 16 | entry.wVersion];
+		counters.Modules++;
+		counters.Objects += entry.dwCount;
+	}
+}
+
+void ToolchainHistogram::Merge(ToolchainHistogram const& other) {
+	for (auto& [key, counters] : other.m_Counts) {
+		auto& c = m_Counts[key];
+		c.Modules += counters.Modules;
+		c.Objects += counters.Objects;
+	}
+	m_Modules += other.m_Modules;
+	m_NoRichHeader += other.m_NoRichHeader;
+}
+
+size_t ToolchainHistogram::GetModuleCount() const {
+	return m_Modules;
+}
+
+size_t ToolchainHistogram::GetModulesWithoutRichHeader() const {
+	return m_NoRichHeader;
+}
+
+std::wstring ToolchainHistogram::ToString() const {
+	//
+	// linker and compiler releases first, then every @comp.id seen
+	//
+	std::map<std::wstring, uint64_t> linkers, compilers;
+	for (auto& [key, counters] : m_Counts) {
+		auto id = WORD(key >> 16), build = WORD(key);
+		auto tool = Toolchain::GetTool(id);
+		auto& release = Toolchain::GetRelease(id, build);
+		auto name = *release.VisualStudio ? std::format(L"{} ({})", release.VisualStudio, release.Toolset) : std::format(L"Unknown (build {})", build);
+		if (tool == Toolchain::Tool::Linker)
+			linkers[name] += counters.Modules;
+		else if (Toolchain::IsCompiler(tool))
+			compilers[name] += counters.Objects;
+	}
+
+	auto text = std::format(L"Modules: {}, without Rich header: {}\n", m_Modules, m_NoRichHeader);
+	text += L"\nLinker releases (modules)\n";
+	for (auto& [name, count] : linkers)
+		text += std::format(L"  {:<40} {:>10}\n", name, count);
+	text += L"\nCompiler releases (objects)\n";
+	for (auto& [name, count] : compilers)
+		text += std::format(L"  {:<40} {:>10}\n", name, count);
+
+	std::vector<std::pair<uint32_t, Counters>> entries(m_Counts.begin(), m_Counts.end());
+	std::ranges::sort(entries, [](auto& e1, auto& e2) {
+		auto t1 = Toolchain::GetTool(WORD(e1.first >> 16)), t2 = Toolchain::GetTool(WORD(e2.first >> 16));
+		return t1 != t2 ? t1 < t2 : e1.first < e2.first;
+		});
+
+	text += std::format(L"\n{:<12} {:<7} {:<22} {:<8} {:>7} {:>10} {:>12}\n", L"Tool", L"Id", L"Release", L"Toolset", L"Build", L"Modules", L"Objects");
+	for (auto& [key, counters] : entries) {
+		auto id = WORD(key >> 16), build = WORD(key);
+		auto& release = Toolchain::GetRelease(id, build);
+		text += std::format(L"{:<12} 0x{:04X}  {:<22} {:<8} {:>7} {:>10} {:>12}\n", Toolchain::ToolToString(Toolchain::GetTool(id)),
+			id, release.VisualStudio, release.Toolset, build, counters.Modules, counters.Objects);
+	}
+	return text;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include "PEFile.h"
+
+//
+// Rich header @comp.id decoding: product id -> tool, build number -> MSVC toolset
+//
+namespace Toolchain {
+	enum class Tool : uint8_t {
+		Unknown, Import, Linker, Export, Implib, Cvtres, Masm, AliasObj, Cvtpgd, Basic,
+		C, Cpp, CvtCilC, CvtCilCpp, LtcgC, LtcgCpp, LtcgMsil, PogoInstrumentC, PogoInstrumentCpp, PogoOptimizeC, PogoOptimizeCpp,
+	};
+
+	struct Release {
+		WORD MinBuild;
+		PCWSTR VisualStudio;	// "VS2019 16.11"
+		PCWSTR Toolset;			// "14.29"
+	};
+
+	Tool GetTool(WORD productId);
+	bool IsCompiler(Tool tool);
+	PCWSTR ToolToString(Tool tool);
+
+	//
+	// product ids are allocated per Visual Studio release; from VS2015 on they stay
+	// the same and the build number tells the releases apart
+	//
+	Release const& GetRelease(WORD productId, WORD build);
+}
+
+//
+// compiler and linker versions a module was built with
+//
+struct ModuleToolchain {
+	static ModuleToolchain FromPE(PEFile const& pe);
+
+	std::wstring ToString() const;
+
+	WORD LinkerId{ 0 }, LinkerBuild{ 0 };
+	WORD CompilerId{ 0 }, CompilerBuild{ 0 };	// compiler that produced most objects
+	uint32_t Objects{ 0 };						// compiled objects (C, C++, LTCG, POGO)
+	bool HasRichHeader : 1{};
+	bool MixedCompilers : 1{};					// objects from more than one compiler build
+};
+
+//
+// @comp.id histogram: modules and objects per (product id, build).
+// Batch scans keep one per worker and merge them once the workers are done.
+//
+class ToolchainHistogram {
+public:
+	void Add(libpe::PERICHHDR_VEC const* rich);	// nullptr - no Rich header
+	void Merge(ToolchainHistogram const& other);
+
+	size_t GetModuleCount() const;
+	size_t GetModulesWithoutRichHeader() const;
+	std::wstring ToString() const;
+
+private:
+	struct Counters {
+		uint64_t Modules{ 0 };
+		uint64_t Objects{ 0 };
+	};
+	std::unordered_map<uint32_t, Counters> m_Counts;	// productId << 16 | build
+	size_t m_Modules{ 0 }, m_NoRichHeader{ 0 };
+};
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "Watchdog.h"
+#include <algorithm>
+
+Watchdog::Watchdog(uint32_t budgetMsec, size_t slots) : m_Slots(std::make_unique<Slot[]>(slots)), m_Count(slots), m_Budget(budgetMsec * 10000ULL) {
+	m_Thread = std::jthread([this](std::stop_token stop) { Run(stop); });
+}
+
+Watchdog::~Watchdog() {
+	m_Thread.request_stop();
+	m_Thread.join();
+	for (size_t i = 0; i < m_Count; i++)
+		if (m_Slots[i].Thread)
+			::CloseHandle(m_Slots[i].Thread);
+}
+
+void Watchdog::Start(size_t slot) {
+	auto& s = m_Slots[slot];
+	std::lock_guard lock(s.Lock);
+	if (!s.Thread)
+		::DuplicateHandle(::GetCurrentProcess(), ::GetCurrentThread(), ::GetCurrentProcess(), &s.Thread, THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0);
+	s.Cancel = false;
+	s.StartTime = GetCpuTime(s.Thread);
+	s.Running = true;
+}
+
+bool Watchdog::Stop(size_t slot) {
+	auto& s = m_Slots[slot];
+	std::lock_guard lock(s.Lock);
+	s.Running = false;
+	return s.Cancel;
+}
+
+std::atomic<bool> const* Watchdog::GetCancelFlag(size_t slot) const {
+	return &m_Slots[slot].Cancel;
+}
+
+void Watchdog::Run(std::stop_token stop) {
+	//
+	// a tenth of the budget between samples, within reason
+	//
+	auto interval = std::chrono::milliseconds(std::clamp<uint64_t>(m_Budget / 100000, 10, 250));
+	std::unique_lock lock(m_WakeLock);
+	while (!m_Wake.wait_for(lock, stop, interval, [&] { return stop.stop_requested(); })) {
+		for (size_t i = 0; i < m_Count; i++) {
+			auto& s = m_Slots[i];
+			std::lock_guard slotLock(s.Lock);
+			if (s.Running && !s.Cancel && GetCpuTime(s.Thread) - s.StartTime > m_Budget)
+				s.Cancel = true;
+		}
+	}
+}
+
+uint64_t Watchdog::GetCpuTime(HANDLE hThread) {
+	FILETIME created, exited, kernel, user;
+	if (hThread == nullptr || !::GetThreadTimes(hThread, &created, &exited, &kernel, &user))
+		return 0;
+	return ((uint64_t)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime) + ((uint64_t)user.dwHighDateTime << 32 | user.dwLowDateTime);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//
+// cancels work items that run over a CPU time budget. Every worker has a slot and brackets each item
+// with Start/Stop; a watchdog thread samples the CPU time the worker threads spent on their current
+// items and raises the cancel flag of the ones over budget. Cancelling is cooperative, the work polls
+// the flag (libpe::PEParseOptions::pfCancel), so a stuck item costs at most the budget plus one interval.
+//
+class Watchdog {
+public:
+	Watchdog(uint32_t budgetMsec, size_t slots);
+	~Watchdog();
+
+	Watchdog(Watchdog const&) = delete;
+	Watchdog& operator=(Watchdog const&) = delete;
+
+	//
+	// the calling thread begins an item in the slot
+	//
+	void Start(size_t slot);
+	//
+	// ends it, true if it was cancelled
+	//
+	bool Stop(size_t slot);
+
+	std::atomic<bool> const* GetCancelFlag(size_t slot) const;
+
+private:
+	struct Slot {
+		std::mutex Lock;
+		HANDLE Thread{ nullptr };
+		uint64_t StartTime{ 0 };		// thread CPU time at Start, 100 nsec units
+		bool Running{ false };
+		std::atomic<bool> Cancel{ false };
+	};
+
+	void Run(std::stop_token stop);
+	static uint64_t GetCpuTime(HANDLE hThread);
+
+	std::unique_ptr<Slot[]> m_Slots;
+	size_t m_Count;
+	uint64_t m_Budget;
+	std::mutex m_WakeLock;
+	std::condition_variable_any m_Wake;
+	std::jthread m_Thread;				// last, so it's joined before the slots go away
+};
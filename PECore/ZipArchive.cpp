@@ -0,0 +1,186 @@
+#include "pch.h"
+#include "ZipArchive.h"
+#include "Inflate.h"
+#include "SimdScan.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	constexpr uint32_t EndOfCentralDirSignature = 0x06054b50;
+	constexpr uint32_t Zip64EndOfCentralDirSignature = 0x06064b50;
+	constexpr uint32_t Zip64LocatorSignature = 0x07064b50;
+	constexpr uint32_t CentralHeaderSignature = 0x02014b50;
+	constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+	constexpr uint16_t Zip64ExtraId = 0x0001;
+
+	template<typename T>
+	T Get(const std::byte* p) {
+		T value;
+		memcpy(&value, p, sizeof(T));
+		return value;
+	}
+
+	std::wstring DecodeName(const std::byte* name, uint16_t length, bool utf8) {
+		auto codePage = utf8 ? CP_UTF8 : CP_OEMCP;
+		auto chars = ::MultiByteToWideChar(codePage, 0, reinterpret_cast<const char*>(name), length, nullptr, 0);
+		std::wstring result(chars, L'\0');
+		::MultiByteToWideChar(codePage, 0, reinterpret_cast<const char*>(name), length, result.data(), chars);
+		return result;
+	}
+}
+
+bool ZipArchive::Entry::IsSupported() const {
+	return !Encrypted && !IsDirectory && (Method == 0 || Method == 8);
+}
+
+bool ZipArchive::Open(std::wstring const& path) {
+	Close();
+	if (!m_File.Open(path) || m_File.GetSize() < 22 || !ReadCentralDirectory()) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void ZipArchive::Close() {
+	m_File.Close();
+	m_Entries.clear();
+}
+
+std::vector<ZipArchive::Entry> const& ZipArchive::GetEntries() const {
+	return m_Entries;
+}
+
+bool ZipArchive::ReadCentralDirectory() {
+	//
+	// the end of central directory record is in the last 64K + 22 bytes, behind an optional comment
+	//
+	auto size = m_File.GetSize();
+	auto tailSize = (std::min<uint64_t>)(size, 0xffff + 22);
+	auto tail = m_File.GetData(size - tailSize, tailSize);
+	const std::byte* eocd = nullptr;
+	for (auto i = tail.size() - 22 + 1; i-- > 0; ) {
+		if (Get<uint32_t>(tail.data() + i) == EndOfCentralDirSignature) {
+			eocd = tail.data() + i;
+			break;
+		}
+	}
+	if (eocd == nullptr)
+		return false;
+
+	uint64_t count = Get<uint16_t>(eocd + 10);
+	uint64_t dirSize = Get<uint32_t>(eocd + 12);
+	uint64_t dirOffset = Get<uint32_t>(eocd + 16);
+
+	if (count == 0xffff || dirSize == 0xffffffff || dirOffset == 0xffffffff) {
+		auto eocdOffset = static_cast<uint64_t>(eocd - m_File.GetData().data());
+		if (eocdOffset < 20)
+			return false;
+		auto locator = m_File.GetData(eocdOffset - 20, 20);
+		if (locator.empty() || Get<uint32_t>(locator.data()) != Zip64LocatorSignature)
+			return false;
+		auto zip64 = m_File.GetData(Get<uint64_t>(locator.data() + 8), 56);
+		if (zip64.empty() || Get<uint32_t>(zip64.data()) != Zip64EndOfCentralDirSignature)
+			return false;
+		count = Get<uint64_t>(zip64.data() + 32);
+		dirSize = Get<uint64_t>(zip64.data() + 40);
+		dirOffset = Get<uint64_t>(zip64.data() + 48);
+	}
+
+	auto dir = m_File.GetData(dirOffset, dirSize);
+	if (dir.empty() && count)
+		return false;
+
+	// every central header takes at least 46 bytes, anything claiming more entries is bogus
+	m_Entries.reserve(static_cast<size_t>(std::min<uint64_t>(count, dir.size() / 46)));
+	size_t pos = 0;
+	for (uint64_t i = 0; i < count && pos + 46 <= dir.size(); i++) {
+		auto p = dir.data() + pos;
+		if (Get<uint32_t>(p) != CentralHeaderSignature)
+			break;
+
+		auto flags = Get<uint16_t>(p + 8);
+		auto nameLength = Get<uint16_t>(p + 28);
+		auto extraLength = Get<uint16_t>(p + 30);
+		auto commentLength = Get<uint16_t>(p + 32);
+		if (pos + 46 + nameLength + extraLength + commentLength > dir.size())
+			break;
+
+		Entry entry;
+		entry.Name = DecodeName(p + 46, nameLength, (flags & 0x800) != 0);
+		entry.Method = Get<uint16_t>(p + 10);
+		entry.Crc32 = Get<uint32_t>(p + 16);
+		entry.CompressedSize = Get<uint32_t>(p + 20);
+		entry.Size = Get<uint32_t>(p + 24);
+		entry.LocalHeaderOffset = Get<uint32_t>(p + 42);
+		entry.Encrypted = (flags & 1) != 0;
+		entry.IsDirectory = !entry.Name.empty() && entry.Name.back() == L'/';
+
+		//
+		// ZIP64 extra field: only the fields saturated in the header are present, in this order
+		//
+		auto extra = p + 46 + nameLength;
+		for (size_t e = 0; e + 4 <= extraLength; ) {
+			auto id = Get<uint16_t>(extra + e);
+			auto size = Get<uint16_t>(extra + e + 2);
+			if (e + 4 + size > extraLength)
+				break;
+			if (id == Zip64ExtraId) {
+				auto field = extra + e + 4, end = field + size;
+				auto next = [&](uint64_t& value) {
+					if (value == 0xffffffff && field + 8 <= end) {
+						value = Get<uint64_t>(field);
+						field += 8;
+					}
+				};
+				next(entry.Size);
+				next(entry.CompressedSize);
+				next(entry.LocalHeaderOffset);
+			}
+			e += 4 + size;
+		}
+
+		m_Entries.push_back(std::move(entry));
+		pos += 46 + nameLength + extraLength + commentLength;
+	}
+	return true;
+}
+
+bool ZipArchive::Extract(Entry const& entry, std::vector<std::byte>& buffer, uint64_t maxSize) const {
+	if (!entry.IsSupported() || entry.Size > maxSize)
+		return false;
+
+	//
+	// the local header repeats name and extra field with lengths of its own
+	//
+	auto local = m_File.GetData(entry.LocalHeaderOffset, 30);
+	if (local.empty() || Get<uint32_t>(local.data()) != LocalHeaderSignature)
+		return false;
+
+	auto dataOffset = entry.LocalHeaderOffset + 30 + Get<uint16_t>(local.data() + 26) + Get<uint16_t>(local.data() + 28);
+	auto data = m_File.GetData(dataOffset, entry.CompressedSize);
+	if (data.empty() && entry.CompressedSize)
+		return false;
+
+	buffer.resize(static_cast<size_t>(entry.Size));
+	if (entry.Method == 0) {
+		if (entry.CompressedSize != entry.Size)
+			return false;
+		if (!buffer.empty())
+			memcpy(buffer.data(), data.data(), buffer.size());
+	}
+	else if (!Inflate::Decompress(data, buffer))
+		return false;
+
+	return Inflate::Crc32(buffer) == entry.Crc32;
+}
+
+bool ZipArchive::IsPackageExtension(std::wstring_view ext) {
+	static const PCWSTR extensions[] = {
+		L".zip", L".nupkg", L".snupkg", L".vsix", L".appx", L".msix",
+	};
+	for (auto e : extensions)
+		if (SimdScan::EqualsNoCase(ext, e))
+			return true;
+	return false;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+//
+// read-only ZIP (and ZIP64) archive over a file mapping: .zip, .nupkg, .vsix, .appx, .msix.
+// Entries are listed from the central directory; Extract is const and may run on several
+// threads at once, each with its own buffer.
+//
+class ZipArchive {
+public:
+	struct Entry {
+		std::wstring Name;				// path inside the archive, '/' separated
+		uint64_t LocalHeaderOffset;
+		uint64_t CompressedSize;
+		uint64_t Size;
+		uint32_t Crc32;
+		uint16_t Method;				// 0 - stored, 8 - deflated
+		bool Encrypted : 1;
+		bool IsDirectory : 1;
+
+		bool IsSupported() const;
+	};
+
+	bool Open(std::wstring const& path);
+	void Close();
+
+	std::vector<Entry> const& GetEntries() const;
+
+	//
+	// decompresses the entry into buffer (resized, capacity kept for the next entry) and checks the CRC.
+	// Entries larger than maxSize are refused.
+	//
+	bool Extract(Entry const& entry, std::vector<std::byte>& buffer, uint64_t maxSize) const;
+
+	static bool IsPackageExtension(std::wstring_view ext);
+
+private:
+	bool ReadCentralDirectory();
+
+	MappedFile m_File;
+	std::vector<Entry> m_Entries;
+};
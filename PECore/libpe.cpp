@@ -6,8 +6,16 @@
 ****************************************************************************************/
 #include "pch.h"
 #include "libpe.h"
+#include "SimdScan.h"
+#include "Authenticode.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <strsafe.h>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <utility>
 
 #define LIBPE_PRODUCT_NAME		  L"libpe, (C) Jovibor 2018-2022, https://github.com/jovibor/libpe"
 #define LIBPE_VERSION_MAJOR		  1
@@ -36,11 +44,103 @@ namespace libpe {
 		return (dwFirst + dwSecond) < dwFirst;
 	}
 
+	//Size on disk (headers and sections' raw data) of the PE image spnImage starts with, 0 if the headers
+	//don't hold up. Everything is checked in place, nothing is copied before the image is accepted.
+	auto GetImageSizeInPlace(std::span<const std::byte> spnImage)->DWORD {
+		if (spnImage.size() < sizeof(IMAGE_DOS_HEADER) || spnImage.size() > 0xFFFFFFFFULL)
+			return 0;
+
+		const auto pDosHdr = reinterpret_cast<const IMAGE_DOS_HEADER*>(spnImage.data());
+		if (pDosHdr->e_magic != IMAGE_DOS_SIGNATURE || pDosHdr->e_lfanew < 4 || pDosHdr->e_lfanew > 0x10000)
+			return 0;
+
+		const auto ullOptHdr = static_cast<ULONGLONG>(pDosHdr->e_lfanew) + sizeof(DWORD) + sizeof(IMAGE_FILE_HEADER);
+		if (ullOptHdr + sizeof(WORD) > spnImage.size())
+			return 0;
+
+		const auto pNTHdr = reinterpret_cast<const IMAGE_NT_HEADERS32*>(spnImage.data() + pDosHdr->e_lfanew);
+		const auto& stFileHdr = pNTHdr->FileHeader;
+		if (pNTHdr->Signature != IMAGE_NT_SIGNATURE || stFileHdr.NumberOfSections > 96
+			|| ullOptHdr + stFileHdr.SizeOfOptionalHeader + stFileHdr.NumberOfSections * sizeof(IMAGE_SECTION_HEADER) > spnImage.size())
+			return 0;
+
+		DWORD dwSizeOfHeaders;
+		const auto pOptHdr = spnImage.data() + ullOptHdr;
+		switch (*reinterpret_cast<const WORD*>(pOptHdr)) {
+		case IMAGE_NT_OPTIONAL_HDR32_MAGIC:
+			if (stFileHdr.SizeOfOptionalHeader < offsetof(IMAGE_OPTIONAL_HEADER32, DataDirectory))
+				return 0;
+			dwSizeOfHeaders = reinterpret_cast<const IMAGE_OPTIONAL_HEADER32*>(pOptHdr)->SizeOfHeaders;
+			break;
+		case IMAGE_NT_OPTIONAL_HDR64_MAGIC:
+			if (stFileHdr.SizeOfOptionalHeader < offsetof(IMAGE_OPTIONAL_HEADER64, DataDirectory))
+				return 0;
+			dwSizeOfHeaders = reinterpret_cast<const IMAGE_OPTIONAL_HEADER64*>(pOptHdr)->SizeOfHeaders;
+			break;
+		default:
+			return 0;
+		}
+
+		auto ullEnd = static_cast<ULONGLONG>(dwSizeOfHeaders);
+		const auto pSecHdr = reinterpret_cast<const IMAGE_SECTION_HEADER*>(pOptHdr + stFileHdr.SizeOfOptionalHeader);
+		for (WORD i = 0; i < stFileHdr.NumberOfSections; ++i)
+			if (pSecHdr[i].SizeOfRawData != 0)
+				ullEnd = (std::max)(ullEnd, static_cast<ULONGLONG>(pSecHdr[i].PointerToRawData) + pSecHdr[i].SizeOfRawData);
+
+		//Truncated images are still taken, as far as the data goes.
+		return static_cast<DWORD>((std::min)(ullEnd, static_cast<ULONGLONG>(spnImage.size())));
+	}
+
+	//Resource directories met during the walk: offset from the root directory -> decode index.
+	//Open addressing with linear probing, grows at half load.
+	class CResDirMap final {
+	public:
+		[[nodiscard]] auto Find(DWORD dwOffset)const->DWORD {
+			if (m_vecSlots.empty())
+				return RESDIR_NOT_SHARED;
+
+			for (auto i = Hash(dwOffset); ; i = (i + 1) & (m_vecSlots.size() - 1)) {
+				const auto& stSlot = m_vecSlots[i];
+				if (stSlot.dwIndex == RESDIR_NOT_SHARED || stSlot.dwOffset == dwOffset)
+					return stSlot.dwIndex;
+			}
+		}
+		void Insert(DWORD dwOffset, DWORD dwIndex) {
+			if ((m_sCount + 1) * 2 > m_vecSlots.size()) {
+				auto vecOld = std::exchange(m_vecSlots, std::vector<SLOT>(m_vecSlots.empty() ? 64 : m_vecSlots.size() * 2));
+				m_sCount = 0;
+				for (const auto& stSlot : vecOld)
+					if (stSlot.dwIndex != RESDIR_NOT_SHARED)
+						Insert(stSlot.dwOffset, stSlot.dwIndex);
+			}
+
+			auto i = Hash(dwOffset);
+			while (m_vecSlots[i].dwIndex != RESDIR_NOT_SHARED && m_vecSlots[i].dwOffset != dwOffset)
+				i = (i + 1) & (m_vecSlots.size() - 1);
+			if (m_vecSlots[i].dwIndex == RESDIR_NOT_SHARED)
+				++m_sCount;
+			m_vecSlots[i] = { dwOffset, dwIndex };
+		}
+	private:
+		[[nodiscard]] auto Hash(DWORD dwOffset)const->std::size_t {
+			return static_cast<std::size_t>((dwOffset * 0x9E3779B1U) >> 8) & (m_vecSlots.size() - 1);
+		}
+		struct SLOT {
+			DWORD dwOffset{ };
+			DWORD dwIndex{ RESDIR_NOT_SHARED };
+		};
+		std::vector<SLOT> m_vecSlots;
+		std::size_t m_sCount{ };
+	};
+
 	//Class Clibpe.
 	class Clibpe final : public Ilibpe {
 	public:
 		auto LoadPe(LPCWSTR pwszFile) -> int override;
 		auto LoadPe(std::span<const std::byte> spnFile) -> int override;
+		void SetParseOptions(const PEParseOptions& stOpts)override;
+		[[nodiscard]] auto GetParseStatus()const->int override;
+		auto ScanImportUsage() -> bool override;
 		[[nodiscard]] auto GetFileInfo()const->PEFILEINFO const* override;
 		[[nodiscard]] auto IsLoaded() const -> bool override;
 		[[nodiscard]] auto GetOffsetFromRVA(ULONGLONG ullRVA)const->DWORD override;
@@ -62,6 +162,7 @@ namespace libpe {
 		[[nodiscard]] auto GetBoundImport() -> PEBOUNDIMPORT_VEC* override;
 		[[nodiscard]] auto GetDelayImport() -> PEDELAYIMPORT_VEC* override;
 		[[nodiscard]] auto GetCOMDescriptor() -> PECOMDESCRIPTOR* override;
+		[[nodiscard]] auto GetEmbedded() -> PEEMBEDDED_VEC* override;
 
 		void Clear()override;
 		void Destroy()override;
@@ -82,6 +183,9 @@ namespace libpe {
 		[[nodiscard]] auto PtrToOffset(LPCVOID lp)const->DWORD;
 		[[nodiscard]] auto RVAToOffset(ULONGLONG ullRVA)const->DWORD;
 		[[nodiscard]] auto RVAToPtr(ULONGLONG ullRVA)const->LPVOID;
+		[[nodiscard]] auto GetStrView(LPCSTR lpszStr)const->std::optional<std::string_view>;
+		bool Checkpoint(std::size_t sAlloc = 0);
+		[[nodiscard]] auto IsCancelled()const->bool;
 		bool ParseMSDOSHeader();
 		bool ParseRichHeader();
 		bool ParseNTFileOptHeader();
@@ -89,6 +193,9 @@ namespace libpe {
 		bool ParseSectionsHeaders();
 		bool ParseExport();
 		bool ParseImport();
+		template<typename TThunk>
+		void ParseImportDescs(PIMAGE_IMPORT_DESCRIPTOR pImpDesc, ULONGLONG ullOrdinalFlag);
+		bool ParseImportUsage();
 		bool ParseResources();
 		bool ParseExceptions();
 		bool ParseSecurity();
@@ -98,14 +205,21 @@ namespace libpe {
 		bool ParseGlobalPtr();
 		bool ParseTLS();
 		bool ParseLCD();
+		template<typename TLCD>
+		void ParseGuardTables(const TLCD* pLCD);
+		auto ParseGuardTable(ULONGLONG ullTableVA, ULONGLONG ullCount, DWORD dwStride)const->PEGuardTable;
 		bool ParseBoundImport();
 		bool ParseIAT();
 		bool ParseDelayImport();
 		bool ParseCOMDescriptor();
+		bool ParseEmbedded();
 	private:
 		wil::unique_mapview_ptr<const std::byte> m_ptr;
 		wil::unique_handle m_map;
 		bool m_fLoaded{ false };              //Flag shows PE load succession.
+		PEParseOptions m_stParseOpts{ };      //Limits and streaming callbacks.
+		int m_iParseStatus{ PEOK };           //ERR_PARSE_* once a checkpoint stopped parsing.
+		ULONGLONG m_ullAllocated{ };          //Bytes charged against m_stParseOpts.ullMaxAlloc.
 		std::unique_ptr<char[]> m_pEmergencyMemory{ std::make_unique<char[]>(0x8FFF) }; //Reserved 16K of memory.
 		std::span<const std::byte> m_spnData; //File data.
 		PIMAGE_NT_HEADERS32 m_pNTHeader32{ }; //NT header pointer for x86.
@@ -130,6 +244,7 @@ namespace libpe {
 		PEBOUNDIMPORT_VEC m_vecBoundImp{ };   //Bound import.
 		PEDELAYIMPORT_VEC m_vecDelayImp{ };   //Delay import.
 		PECOMDESCRIPTOR m_stCOR20Desc{ };     //COM table descriptor.
+		PEEMBEDDED_VEC m_vecEmbedded{ };      //Embedded PE images.
 	};
 
 	//CreateRawlibpe implementation.
@@ -139,6 +254,8 @@ namespace libpe {
 
 	auto Clibpe::LoadPe(LPCWSTR pwszFile)->int {
 		assert(pwszFile != nullptr);
+		if (m_fLoaded)
+			ClearAll();
 
 		const auto hFile = CreateFileW(pwszFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
 		assert(hFile != INVALID_HANDLE_VALUE);
@@ -166,12 +283,25 @@ namespace libpe {
 			return ERR_FILE_MAPPING;
 		}
 		
+		//The view stays mapped while loaded: GetBaseAddr() and the PEFile readers point into it.
+		//Pages are only faulted in when read, a large image costs address space, not memory.
 		const auto ret = LoadPe({ m_ptr.get(), static_cast<std::size_t>(stLI.QuadPart) });
-		m_ptr.reset();
+		if (ret != PEOK) {
+			m_ptr.reset();
+			m_map.reset();
+		}
 
 		return ret;
 	}
 
+	void Clibpe::SetParseOptions(const PEParseOptions& stOpts) {
+		m_stParseOpts = stOpts;
+	}
+
+	auto Clibpe::GetParseStatus()const->int {
+		return m_iParseStatus;
+	}
+
 	auto Clibpe::LoadPe(std::span<const std::byte> spnFile)->int {
 		assert(!spnFile.empty());
 		if (m_fLoaded)
@@ -190,23 +320,16 @@ namespace libpe {
 		ParseRichHeader();
 
 		if (ParseNTFileOptHeader()) { //If there is no NT header then it's pointless to parse further.
-			ParseDataDirectories();
-			ParseSectionsHeaders();
-			ParseExport();
-			ParseImport();
-			ParseResources();
-			ParseExceptions();
-			ParseSecurity();
-			ParseRelocations();
-			ParseDebug();
-			ParseArchitecture();
-			ParseGlobalPtr();
-			ParseTLS();
-			ParseLCD();
-			ParseBoundImport();
-			ParseIAT();
-			ParseDelayImport();
-			ParseCOMDescriptor();
+			//The tables a checkpoint stopped in are kept as far as they got, the following ones are skipped.
+			for (const auto pfnParse : { &Clibpe::ParseDataDirectories, &Clibpe::ParseSectionsHeaders, &Clibpe::ParseExport,
+				&Clibpe::ParseImport, &Clibpe::ParseImportUsage, &Clibpe::ParseResources, &Clibpe::ParseExceptions,
+				&Clibpe::ParseSecurity, &Clibpe::ParseRelocations, &Clibpe::ParseDebug, &Clibpe::ParseArchitecture,
+				&Clibpe::ParseGlobalPtr, &Clibpe::ParseTLS, &Clibpe::ParseLCD, &Clibpe::ParseBoundImport, &Clibpe::ParseIAT,
+				&Clibpe::ParseDelayImport, &Clibpe::ParseCOMDescriptor, &Clibpe::ParseEmbedded }) {
+				if (!Checkpoint())
+					break;
+				(this->*pfnParse)();
+			}
 		}
 
 		return PEOK;
@@ -375,6 +498,14 @@ namespace libpe {
 		return &m_stCOR20Desc;
 	}
 
+	auto Clibpe::GetEmbedded()->PEEMBEDDED_VEC* {
+		assert(m_fLoaded);
+		if (!m_fLoaded || !m_stFileInfo.HasEmbedded)
+			return nullptr;
+
+		return &m_vecEmbedded;
+	}
+
 	void Clibpe::Clear() {
 		ClearAll();
 	}
@@ -384,15 +515,36 @@ namespace libpe {
 	}
 
 	auto Ilibpe::FlatResources(const PEResRoot& stResRoot)->PERESFLAT_VEC {
+		//Shared directories resolve to their decoded copy on the same level. Anything else (a loop back
+		//to an upper level, or a directory decoded on another level) has nothing to flatten.
+		std::unordered_map<DWORD, const PEResLevel2*> mapLvL2;
+		std::unordered_map<DWORD, const PEResLevel3*> mapLvL3;
+		for (const auto& iterRoot : stResRoot.ResData) {
+			if (iterRoot.ResLvL2.DirIndex != 0)
+				mapLvL2.emplace(iterRoot.ResLvL2.DirIndex, &iterRoot.ResLvL2);
+			for (const auto& iterLvL2 : iterRoot.ResLvL2.ResData)
+				if (iterLvL2.ResLvL3.DirIndex != 0)
+					mapLvL3.emplace(iterLvL2.ResLvL3.DirIndex, &iterLvL2.ResLvL3);
+		}
+		static const PEResLevel2 stEmptyLvL2{ };
+		static const PEResLevel3 stEmptyLvL3{ };
+		const auto lmbResolve = [](const auto& stResLvL, const auto& mapLvL, const auto& stEmpty)->decltype(stEmpty) {
+			if (stResLvL.SharedDirIndex == RESDIR_NOT_SHARED)
+				return stResLvL;
+			const auto iter = mapLvL.find(stResLvL.SharedDirIndex);
+			return iter != mapLvL.end() ? *iter->second : stEmpty;
+		};
+		const auto lmbLvL2 = [&](const PEResLevel2& stResLvL2)->const PEResLevel2& { return lmbResolve(stResLvL2, mapLvL2, stEmptyLvL2); };
+		const auto lmbLvL3 = [&](const PEResLevel3& stResLvL3)->const PEResLevel3& { return lmbResolve(stResLvL3, mapLvL3, stEmptyLvL3); };
+
 		std::size_t sTotalRes{ 0 }; //How many resources total?
 		for (const auto& iterRoot : stResRoot.ResData) { //To reserve space in vector, count total amount of resources.
 			const auto pResDirEntry = &iterRoot.ResDirEntry; //Level Root
 			if (pResDirEntry->DataIsDirectory) {
-				const auto pstResLvL2 = &iterRoot.ResLvL2;
-				for (const auto& iterLvL2 : pstResLvL2->ResData) {
+				for (const auto& iterLvL2 : lmbLvL2(iterRoot.ResLvL2).ResData) {
 					const auto pResDirEntry2 = &iterLvL2.ResDirEntry; //Level 2 IMAGE_RESOURCE_DIRECTORY_ENTRY
 					if (pResDirEntry2->DataIsDirectory) {
-						sTotalRes += iterLvL2.ResLvL3.ResData.size(); //Level 3
+						sTotalRes += lmbLvL3(iterLvL2.ResLvL3).ResData.size(); //Level 3
 					}
 					else
 						++sTotalRes;
@@ -413,7 +565,7 @@ namespace libpe {
 				stRes.TypeID = pResDirEntryRoot->Id;
 
 			if (pResDirEntryRoot->DataIsDirectory) {
-				for (auto& iterLvL2 : iterRoot.ResLvL2.ResData) {
+				for (auto& iterLvL2 : lmbLvL2(iterRoot.ResLvL2).ResData) {
 					const auto pResDirEntry2 = &iterLvL2.ResDirEntry; //Level 2 IMAGE_RESOURCE_DIRECTORY_ENTRY
 					if (pResDirEntry2->NameIsString)
 						stRes.NameStr = iterLvL2.ResName;
@@ -421,7 +573,7 @@ namespace libpe {
 						stRes.NameID = pResDirEntry2->Id;
 
 					if (pResDirEntry2->DataIsDirectory) {
-						for (auto& iterLvL3 : iterLvL2.ResLvL3.ResData) {
+						for (auto& iterLvL3 : lmbLvL3(iterLvL2.ResLvL3).ResData) {
 							const auto pResDirEntry3 = &iterLvL3.ResDirEntry; //Level 3 IMAGE_RESOURCE_DIRECTORY_ENTRY
 							if (pResDirEntry3->NameIsString)
 								stRes.LangStr = iterLvL3.ResName;
@@ -456,7 +608,11 @@ namespace libpe {
 		* Called if LoadPe is invoked second time by the same Ilibpe pointer.         *
 		******************************************************************************/
 		m_fLoaded = false;
+		m_iParseStatus = PEOK;
+		m_ullAllocated = 0;
 		m_spnData = {};
+		m_ptr.reset();
+		m_map.reset();
 		m_pNTHeader32 = nullptr;
 		m_pNTHeader64 = nullptr;
 		m_stFileInfo = { };
@@ -477,10 +633,11 @@ namespace libpe {
 		m_vecBoundImp.clear();
 		m_vecDelayImp.clear();
 		m_stCOR20Desc = { };
+		m_vecEmbedded.clear();
 	}
 
 	auto Clibpe::GetBaseAddr()const->DWORD_PTR {
-		return reinterpret_cast<DWORD_PTR>(m_ptr.get());
+		return reinterpret_cast<DWORD_PTR>(m_spnData.data());
 	}
 
 	auto Clibpe::GetDataSize()const->ULONGLONG {
@@ -646,6 +803,39 @@ namespace libpe {
 		return IsPtrSafe(ptr, true) ? ptr : nullptr;
 	}
 
+	auto Clibpe::GetStrView(LPCSTR lpszStr)const->std::optional<std::string_view> {
+		//Zero terminated string within the file data, viewed in place.
+		//nullopt if there is no terminator before the end of file or within dwMaxNameLength chars.
+		if (!IsPtrSafe(lpszStr))
+			return std::nullopt;
+
+		const auto ullMax = (std::min)(static_cast<ULONGLONG>(m_stParseOpts.dwMaxNameLength) + 1,
+			GetBaseAddr() + GetDataSize() - reinterpret_cast<DWORD_PTR>(lpszStr));
+		const auto sLen = SimdScan::StrNLen(lpszStr, static_cast<size_t>(ullMax));
+		if (sLen == ullMax)
+			return std::nullopt;
+
+		return std::string_view(lpszStr, sLen);
+	}
+
+	bool Clibpe::Checkpoint(std::size_t sAlloc) {
+		//Called between entries of the tables a file controls the size of. sAlloc is what the entry
+		//about to be stored costs; once cancelled or over budget every further checkpoint fails.
+		if (m_iParseStatus != PEOK)
+			return false;
+
+		if (IsCancelled())
+			m_iParseStatus = ERR_PARSE_CANCELLED;
+		else if (m_stParseOpts.ullMaxAlloc != 0 && (m_ullAllocated += sAlloc) > m_stParseOpts.ullMaxAlloc)
+			m_iParseStatus = ERR_PARSE_BUDGET;
+
+		return m_iParseStatus == PEOK;
+	}
+
+	auto Clibpe::IsCancelled()const->bool {
+		return m_stParseOpts.pfCancel != nullptr && m_stParseOpts.pfCancel->load(std::memory_order_relaxed);
+	}
+
 	bool Clibpe::ParseMSDOSHeader() {
 		const auto pDosHdr = GetDosPtr();
 
@@ -810,7 +1000,10 @@ namespace libpe {
 				//So String Table's beginning can be calculated like this:
 				//FileHeader.PointerToSymbolTable + FileHeader.NumberOfSymbols * 18;
 
-				const auto pStart = reinterpret_cast<const char*>(&pSecHdr->Name[1]);
+				//Name isn't zero terminated when all 8 chars are used, the digits are parsed from a copy.
+				char szDigits[IMAGE_SIZEOF_SHORT_NAME] { };
+				std::memcpy(szDigits, &pSecHdr->Name[1], IMAGE_SIZEOF_SHORT_NAME - 1);
+				const auto pStart = szDigits;
 				char* pEnd{ };
 				errno = 0;
 				const auto lOffset = strtol(pStart, &pEnd, 10);
@@ -820,8 +1013,8 @@ namespace libpe {
 				const auto lpszSecRealName = reinterpret_cast<const char*>(GetBaseAddr()
 					+ static_cast<DWORD_PTR>(dwSymbolTable) + static_cast<DWORD_PTR>(dwNumberOfSymbols) * 18
 					+ static_cast<DWORD_PTR>(lOffset));
-				if (IsPtrSafe(lpszSecRealName))
-					strSecRealName = lpszSecRealName;
+				if (const auto svName = GetStrView(lpszSecRealName); svName)
+					strSecRealName = *svName;
 			}
 			else {
 				if (pSecHdr->Name[7] == 0)
@@ -836,6 +1029,22 @@ namespace libpe {
 		if (m_vecSecHeaders.empty())
 			return false;
 
+		//Compressed or encrypted data is close to 8 bits per byte, code and tables stay well below.
+		if (m_stParseOpts.fSectionEntropy) {
+			for (auto& stSec : m_vecSecHeaders) {
+				const auto ullRaw = static_cast<ULONGLONG>(stSec.SecHdr.PointerToRawData);
+				if (ullRaw >= m_spnData.size())
+					continue;
+				if (!Checkpoint())
+					break;
+
+				const auto sSize = static_cast<std::size_t>((std::min)(static_cast<ULONGLONG>(stSec.SecHdr.SizeOfRawData), m_spnData.size() - ullRaw));
+				uint32_t arrCounts[256]{ };
+				SimdScan::ByteHistogram(m_spnData.data() + ullRaw, sSize, arrCounts);
+				stSec.Entropy = SimdScan::Entropy(arrCounts);
+			}
+		}
+
 		m_stFileInfo.HasSections = true;
 
 		return true;
@@ -854,11 +1063,33 @@ namespace libpe {
 
 		const auto pwOrdinals = static_cast<PWORD>(RVAToPtr(pExportDir->AddressOfNameOrdinals));
 		const auto pdwNamesRVA = static_cast<PDWORD>(RVAToPtr(pExportDir->AddressOfNames));
+		const auto dwFuncs = (std::min)(pExportDir->NumberOfFunctions, m_stParseOpts.dwMaxExportFuncs);
 		std::vector<PEExportFunction> vecFuncs;
 		std::string strModuleName;
 
 		try {
-			for (size_t iterFuncs = 0; iterFuncs < static_cast<size_t>(pExportDir->NumberOfFunctions); ++iterFuncs) {
+			//Name index for every function, built in one pass over the names table.
+			//If several names refer to the same function the first one wins.
+			std::vector<DWORD> vecNameIndex(dwFuncs, (std::numeric_limits<DWORD>::max)());
+			if (pdwNamesRVA && pwOrdinals) {
+				//NumberOfNames comes from the file: only the entries of both tables inside the image count.
+				const auto ullEnd = GetBaseAddr() + GetDataSize();
+				const auto ullNames = (std::min)({ static_cast<ULONGLONG>(pExportDir->NumberOfNames),
+					static_cast<ULONGLONG>(m_stParseOpts.dwMaxExportFuncs),
+					(ullEnd - reinterpret_cast<DWORD_PTR>(pwOrdinals)) / sizeof(WORD),
+					(ullEnd - reinterpret_cast<DWORD_PTR>(pdwNamesRVA)) / sizeof(DWORD) });
+				for (auto iterFuncNames = static_cast<DWORD>(ullNames); iterFuncNames-- > 0;) {
+					if (!IsPtrSafe(pwOrdinals + iterFuncNames) || !IsPtrSafe(pdwNamesRVA + iterFuncNames))
+						break;
+					if (pwOrdinals[iterFuncNames] < dwFuncs)
+						vecNameIndex[pwOrdinals[iterFuncNames]] = iterFuncNames;
+				}
+			}
+
+			if (m_stParseOpts.fStoreExports)
+				vecFuncs.reserve(dwFuncs);
+
+			for (DWORD iterFuncs = 0; iterFuncs < dwFuncs; ++iterFuncs) {
 				if (!IsPtrSafe(pdwFuncsRVA + iterFuncs)) //Checking pdwFuncsRVA array.
 					break;
 
@@ -866,37 +1097,36 @@ namespace libpe {
 					std::string strFuncName;
 					std::string strForwarderName;
 					DWORD dwNameRVA{ };
-					if (pdwNamesRVA && pwOrdinals) {
-						for (size_t iterFuncNames = 0; iterFuncNames < static_cast<size_t>(pExportDir->NumberOfNames); ++iterFuncNames) {
-							if (!IsPtrSafe(pwOrdinals + iterFuncNames)) //Checking pwOrdinals array.
-								break;
-
-							if (pwOrdinals[iterFuncNames] == iterFuncs) { //Cycling through ordinals table to get func name.
-								dwNameRVA = pdwNamesRVA[iterFuncNames];
-								const auto pszFuncName = static_cast<LPCSTR>(RVAToPtr(dwNameRVA));
-								//Checking func name for length correctness.
-								if (pszFuncName && (StringCchLengthA(pszFuncName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER)) {
-									strFuncName = pszFuncName;
-								}
-								break;
-							}
-						}
+					if (const auto dwNameIndex = vecNameIndex[iterFuncs]; dwNameIndex != (std::numeric_limits<DWORD>::max)()) {
+						dwNameRVA = pdwNamesRVA[dwNameIndex];
+						const auto pszFuncName = static_cast<LPCSTR>(RVAToPtr(dwNameRVA));
+						//Checking func name for length correctness.
+						if (const auto svName = GetStrView(pszFuncName); svName)
+							strFuncName = *svName;
 					}
 
 					if ((pdwFuncsRVA[iterFuncs] >= dwExportStartRVA) && (pdwFuncsRVA[iterFuncs] <= dwExportEndRVA)) {
 						const auto pszForwarderName = static_cast<LPCSTR>(RVAToPtr(pdwFuncsRVA[iterFuncs]));
 						//Checking forwarder name for length correctness.
-						if (pszForwarderName && (StringCchLengthA(pszForwarderName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-							strForwarderName = pszForwarderName;
+						if (const auto svName = GetStrView(pszForwarderName); svName)
+							strForwarderName = *svName;
 					}
-					vecFuncs.emplace_back(pdwFuncsRVA[iterFuncs], static_cast<DWORD>(iterFuncs)/*Ordinal*/, dwNameRVA,
-						std::move(strFuncName), std::move(strForwarderName));
+
+					if (!Checkpoint(m_stParseOpts.fStoreExports ? sizeof(PEExportFunction) + strFuncName.size() + strForwarderName.size() : 0))
+						break;
+
+					PEExportFunction stFunc{ pdwFuncsRVA[iterFuncs], iterFuncs/*Ordinal*/, dwNameRVA,
+						std::move(strFuncName), std::move(strForwarderName) };
+					if (m_stParseOpts.fnExportFunc && !m_stParseOpts.fnExportFunc(stFunc))
+						break;
+					if (m_stParseOpts.fStoreExports)
+						vecFuncs.emplace_back(std::move(stFunc));
 				}
 			}
 			const auto szExportName = static_cast<LPCSTR>(RVAToPtr(pExportDir->Name));
 			//Checking Export name for length correctness.
-			if (szExportName && (StringCchLengthA(szExportName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-				strModuleName = szExportName;
+			if (const auto svName = GetStrView(szExportName); svName)
+				strModuleName = *svName;
 
 			m_stExport = { PtrToOffset(pExportDir), *pExportDir, std::move(strModuleName) /*Actual IMG name*/, std::move(vecFuncs) };
 		}
@@ -919,138 +1149,227 @@ namespace libpe {
 	}
 
 	bool Clibpe::ParseImport() {
-		auto pImpDesc = static_cast<PIMAGE_IMPORT_DESCRIPTOR>(RVAToPtr(GetDirEntryRVA(IMAGE_DIRECTORY_ENTRY_IMPORT)));
+		const auto pImpDesc = static_cast<PIMAGE_IMPORT_DESCRIPTOR>(RVAToPtr(GetDirEntryRVA(IMAGE_DIRECTORY_ENTRY_IMPORT)));
 		if (pImpDesc == nullptr)
 			return false;
 
 		try {
-			//Counter for import modules. If it exceeds iMaxModules we stop parsing file, it's definitely bogus.
-			//Very unlikely PE file has more than 1000 import modules.
-			constexpr auto iMaxModules = 1000;
-			constexpr auto iMaxFuncs = 5000;
-			int iModulesCount = 0;
-
-			if (m_stFileInfo.IsPE32) {
-				while (pImpDesc->Name) {
-					auto pThunk32 = reinterpret_cast<PIMAGE_THUNK_DATA32>(static_cast<DWORD_PTR>(pImpDesc->OriginalFirstThunk));
-					if (!pThunk32)
-						pThunk32 = reinterpret_cast<PIMAGE_THUNK_DATA32>(static_cast<DWORD_PTR>(pImpDesc->FirstThunk));
-
-					if (pThunk32) {
-						pThunk32 = static_cast<PIMAGE_THUNK_DATA32>(RVAToPtr(reinterpret_cast<DWORD_PTR>(pThunk32)));
-						if (!pThunk32)
-							break;
+			if (m_stFileInfo.IsPE32)
+				ParseImportDescs<IMAGE_THUNK_DATA32>(pImpDesc, IMAGE_ORDINAL_FLAG32);
+			else if (m_stFileInfo.IsPE64)
+				ParseImportDescs<IMAGE_THUNK_DATA64>(pImpDesc, IMAGE_ORDINAL_FLAG64);
+		}
+		catch (const std::bad_alloc&) {
+			m_pEmergencyMemory.reset();
+			MessageBoxW(nullptr, L"E_OUTOFMEMORY error while trying to get Import table.\r\n"
+				L"Too many import entries!\nFile seems to be corrupted.", L"Error", MB_ICONERROR);
 
-						std::vector<PEImportFunction> vecFunc{ };
-						std::string strDllName{ };
-						//Counter for import module funcs, if it exceeds iMaxFuncs we stop parsing import descr, it's definitely bogus.
-						int iFuncsCount = 0;
-
-						while (pThunk32->u1.AddressOfData) {
-							PEImportFunction::UNPEIMPORTTHUNK unImpThunk32;
-							unImpThunk32.Thunk32 = *pThunk32;
-							IMAGE_IMPORT_BY_NAME stImpByName{ };
-							std::string strFuncName{ };
-							if (!(pThunk32->u1.Ordinal & IMAGE_ORDINAL_FLAG32)) {
-								const auto pName = static_cast<PIMAGE_IMPORT_BY_NAME>(RVAToPtr(pThunk32->u1.AddressOfData));
-								if (pName && (StringCchLengthA(pName->Name, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER)) {
-									stImpByName = *pName;
-									strFuncName = pName->Name;
-								}
-							}
-							vecFunc.emplace_back(unImpThunk32, stImpByName, std::move(strFuncName));
+			m_vecImport.clear();
+			m_pEmergencyMemory = std::make_unique<char[]>(0x8FFF);
+		}
+		catch (...) {
+			MessageBoxW(nullptr, L"Unknown exception raised while trying to get Import table.\r\nFile seems to be corrupted.",
+				L"Error", MB_ICONERROR);
+		}
 
-							if (!IsPtrSafe(++pThunk32))
-								break;
-							if (++iFuncsCount == iMaxFuncs)
-								break;
-						}
+		m_stFileInfo.HasImport = true;
 
-						const auto szName = static_cast<LPCSTR>(RVAToPtr(pImpDesc->Name));
-						if (szName && (StringCchLengthA(szName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-							strDllName = szName;
+		return true;
+	}
 
-						m_vecImport.emplace_back(PtrToOffset(pImpDesc), *pImpDesc, std::move(strDllName), std::move(vecFunc));
+	template<typename TThunk>
+	void Clibpe::ParseImportDescs(PIMAGE_IMPORT_DESCRIPTOR pImpDesc, ULONGLONG ullOrdinalFlag) {
+		//Import descriptors past dwMaxImportModules, and functions past dwMaxImportFuncs
+		//in one descriptor, are considered bogus and aren't parsed.
+		DWORD dwModulesCount = 0;
+		bool fContinue = true;
+
+		while (fContinue && IsPtrSafe(reinterpret_cast<DWORD_PTR>(pImpDesc) + sizeof(IMAGE_IMPORT_DESCRIPTOR), true) && pImpDesc->Name) {
+			//No IMPORT pointers for that DLL?... Going next dll.
+			if (const auto dwThunkRVA = pImpDesc->OriginalFirstThunk ? pImpDesc->OriginalFirstThunk : pImpDesc->FirstThunk; dwThunkRVA) {
+				auto pThunk = static_cast<const TThunk*>(RVAToPtr(dwThunkRVA));
+				if (!pThunk)
+					break;
 
-						if (!IsPtrSafe(++pImpDesc))
-							break;
+				PEImport stImport{ PtrToOffset(pImpDesc), *pImpDesc };
+				const auto szName = static_cast<LPCSTR>(RVAToPtr(pImpDesc->Name));
+				if (const auto svName = GetStrView(szName); svName)
+					stImport.ModuleName = *svName;
+
+				DWORD dwFuncsCount = 0;
+				while (dwFuncsCount < m_stParseOpts.dwMaxImportFuncs
+					&& IsPtrSafe(reinterpret_cast<DWORD_PTR>(pThunk) + sizeof(TThunk), true) && pThunk->u1.AddressOfData) {
+					PEImportFunction stFunc{ };
+					if constexpr (std::is_same_v<TThunk, IMAGE_THUNK_DATA64>)
+						stFunc.unThunk.Thunk64 = *pThunk;
+					else
+						stFunc.unThunk.Thunk32 = *pThunk;
+
+					stFunc.ByOrdinal = (pThunk->u1.Ordinal & ullOrdinalFlag) != 0;
+					if (!stFunc.ByOrdinal) {
+						const auto pName = static_cast<PIMAGE_IMPORT_BY_NAME>(RVAToPtr(pThunk->u1.AddressOfData));
+						if (const auto svName = GetStrView(pName ? pName->Name : nullptr); svName) {
+							stFunc.ImpByName = *pName;
+							stFunc.FuncName = *svName;
+						}
 					}
-					else //No IMPORT pointers for that DLL?...
-						if (!IsPtrSafe(++pImpDesc))  //Going next dll.
-							break;
 
-					if (++iModulesCount == iMaxModules)
+					if (!Checkpoint(m_stParseOpts.fStoreImports ? sizeof(PEImportFunction) + stFunc.FuncName.size() : 0)) {
+						fContinue = false;
+						break;
+					}
+					if (m_stParseOpts.fnImportFunc && !m_stParseOpts.fnImportFunc(stImport, stFunc))
+						fContinue = false;
+					if (m_stParseOpts.fStoreImports)
+						stImport.ImportFunc.emplace_back(std::move(stFunc));
+					if (!fContinue)
 						break;
+
+					++pThunk;
+					++dwFuncsCount;
 				}
+
+				if (m_stParseOpts.fStoreImports)
+					m_vecImport.emplace_back(std::move(stImport));
 			}
-			else if (m_stFileInfo.IsPE64) {
-				while (pImpDesc->Name) {
-					auto pThunk64 = reinterpret_cast<PIMAGE_THUNK_DATA64>(static_cast<DWORD_PTR>(pImpDesc->OriginalFirstThunk));
-					if (!pThunk64)
-						pThunk64 = reinterpret_cast<PIMAGE_THUNK_DATA64>(static_cast<DWORD_PTR>(pImpDesc->FirstThunk));
-
-					if (pThunk64) {
-						pThunk64 = static_cast<PIMAGE_THUNK_DATA64>(RVAToPtr(reinterpret_cast<DWORD_PTR>(pThunk64)));
-						if (!pThunk64)
-							return false;
-
-						std::vector<PEImportFunction> vecFunc{ };
-						std::string strDllName{ };
-						int iFuncsCount = 0;
-
-						while (pThunk64->u1.AddressOfData) {
-							PEImportFunction::UNPEIMPORTTHUNK unImpThunk64;
-							unImpThunk64.Thunk64 = *pThunk64;
-							IMAGE_IMPORT_BY_NAME stImpByName{ };
-							std::string strFuncName{ };
-							if (!(pThunk64->u1.Ordinal & IMAGE_ORDINAL_FLAG32)) {
-								const auto pName = static_cast<PIMAGE_IMPORT_BY_NAME>(RVAToPtr(pThunk64->u1.AddressOfData));
-								if (pName && (StringCchLengthA(pName->Name, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER)) {
-									stImpByName = *pName;
-									strFuncName = pName->Name;
-								}
-							}
-							vecFunc.emplace_back(unImpThunk64, stImpByName, std::move(strFuncName));
 
-							pThunk64++;
-							if (++iFuncsCount == iMaxFuncs)
-								break;
-							if (++iFuncsCount == iMaxFuncs)
-								break;
-						}
+			++pImpDesc;
+			if (++dwModulesCount == m_stParseOpts.dwMaxImportModules)
+				break;
+		}
+	}
 
-						const auto szName = static_cast<LPCSTR>(RVAToPtr(pImpDesc->Name));
-						if (szName && (StringCchLengthA(szName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-							strDllName = szName;
+	bool Clibpe::ParseImportUsage() {
+		if (!m_stParseOpts.fScanImportUsage)
+			return false;
 
-						m_vecImport.emplace_back(PtrToOffset(pImpDesc), *pImpDesc, std::move(strDllName), std::move(vecFunc));
+		return ScanImportUsage();
+	}
 
-						if (!IsPtrSafe(++pImpDesc))
-							break;
-					}
-					else
-						if (!IsPtrSafe(++pImpDesc))
-							break;
+	auto Clibpe::ScanImportUsage()->bool {
+		if (!m_fLoaded || m_stFileInfo.HasImportUsage)
+			return m_stFileInfo.HasImportUsage;
+		if (m_vecImport.empty())
+			return false;
+
+		//IAT slots of every import descriptor, sorted by RVA. Slots are numbered across
+		//the descriptors, so each thread counts into one flat vector.
+		struct IATRange {
+			ULONGLONG ullBegin;
+			ULONGLONG ullEnd;
+			std::size_t sFirstSlot;
+		};
+		//Code to scan, split so that big sections spread over the threads.
+		//A chunk may read the last instruction's operand past its end, up to the section end.
+		struct CodeChunk {
+			std::size_t sOffset;   //File's raw offset.
+			std::size_t sSize;     //Instructions start in [sOffset, sOffset + sSize).
+			std::size_t sAvail;    //Bytes up to the section end.
+			ULONGLONG   ullRVA;    //RVA at sOffset.
+		};
+		constexpr std::size_t sChunkSize = 1 << 20;
+		constexpr std::size_t sInstrSize = 6; //FF 15/25 disp32.
+
+		const DWORD dwPtrSize = m_stFileInfo.IsPE64 ? 8 : 4;
+		const auto ullImageBase = GetImageBase();
+
+		try {
+			std::vector<IATRange> vecIAT;
+			std::size_t sSlots = 0;
+			for (const auto& stImport : m_vecImport) {
+				if (stImport.ImportDesc.FirstThunk != 0 && !stImport.ImportFunc.empty())
+					vecIAT.emplace_back(stImport.ImportDesc.FirstThunk,
+						stImport.ImportDesc.FirstThunk + static_cast<ULONGLONG>(stImport.ImportFunc.size()) * dwPtrSize, sSlots);
+				sSlots += stImport.ImportFunc.size();
+			}
+			std::ranges::sort(vecIAT, { }, &IATRange::ullBegin);
+
+			std::vector<CodeChunk> vecChunks;
+			for (const auto& stSec : m_vecSecHeaders) {
+				const auto& stHdr = stSec.SecHdr;
+				if (!(stHdr.Characteristics & (IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_CNT_CODE)) || stHdr.PointerToRawData >= m_spnData.size())
+					continue;
+
+				auto sSize = (std::min)(static_cast<std::size_t>(stHdr.SizeOfRawData), m_spnData.size() - stHdr.PointerToRawData);
+				if (stHdr.Misc.VirtualSize != 0)
+					sSize = (std::min)(sSize, static_cast<std::size_t>(stHdr.Misc.VirtualSize));
+				for (std::size_t sPos = 0; sPos < sSize; sPos += sChunkSize)
+					vecChunks.emplace_back(stHdr.PointerToRawData + sPos, (std::min)(sChunkSize, sSize - sPos), sSize - sPos,
+						static_cast<ULONGLONG>(stHdr.VirtualAddress) + sPos);
+			}
+
+			//x64: call/jmp [rip+disp32], the slot is relative to the next instruction.
+			//x86: call/jmp [abs32], the slot is a VA at the preferred image base.
+			//FF 15/FF 25 candidates come from the vectorized pair search, the IAT ranges sort out the rest.
+			const auto lmbScan = [&](const CodeChunk& stChunk, std::vector<DWORD>& vecRefs) {
+				if (stChunk.sAvail < sInstrSize)
+					return;
+
+				const auto pData = m_spnData.data() + stChunk.sOffset;
+				const auto sEnd = (std::min)(stChunk.sSize, stChunk.sAvail - sInstrSize + 1);
+				for (std::size_t sPos = 0; sPos < sEnd; ++sPos) {
+					sPos += SimdScan::FindPair(pData + sPos, sEnd + 1 - sPos, 0xFF, 0x15, 0x25);
+					if (sPos >= sEnd)
+						break;
+
+					LONG lDisp;
+					std::memcpy(&lDisp, pData + sPos + 2, sizeof(lDisp));
+					const auto ullTarget = m_stFileInfo.IsPE64 ? stChunk.ullRVA + sPos + sInstrSize + static_cast<LONGLONG>(lDisp)
+						: static_cast<ULONGLONG>(static_cast<DWORD>(lDisp)) - ullImageBase;
+
+					auto iter = std::ranges::upper_bound(vecIAT, ullTarget, { }, &IATRange::ullBegin);
+					if (iter == vecIAT.begin() || ullTarget >= (--iter)->ullEnd || (ullTarget - iter->ullBegin) % dwPtrSize != 0)
+						continue;
+					++vecRefs[iter->sFirstSlot + static_cast<std::size_t>((ullTarget - iter->ullBegin) / dwPtrSize)];
+				}
+			};
+
+			auto sThreads = static_cast<std::size_t>(m_stParseOpts.dwUsageThreads ? m_stParseOpts.dwUsageThreads : std::thread::hardware_concurrency());
+			sThreads = std::clamp<std::size_t>(sThreads, 1, (std::max)(vecChunks.size(), std::size_t { 1 }));
+			if (!Checkpoint(sThreads * sSlots * sizeof(DWORD)))
+				return false;
 
-					if (++iModulesCount == iMaxModules)
+			//The scanning threads only look at pfCancel, the status is set once they are joined.
+			std::vector<std::vector<DWORD>> vecRefs(sThreads, std::vector<DWORD>(sSlots));
+			if (sThreads == 1) {
+				for (const auto& stChunk : vecChunks) {
+					if (IsCancelled())
 						break;
+					lmbScan(stChunk, vecRefs[0]);
+				}
+			}
+			else {
+				std::atomic<std::size_t> sNext{ 0 };
+				std::vector<std::jthread> vecThreads;
+				for (std::size_t iterThread = 0; iterThread < sThreads; ++iterThread)
+					vecThreads.emplace_back([&, iterThread] {
+						for (auto sChunk = sNext++; sChunk < vecChunks.size() && !IsCancelled(); sChunk = sNext++)
+							lmbScan(vecChunks[sChunk], vecRefs[iterThread]);
+						});
+			} //Joined here.
+			if (!Checkpoint())
+				return false;
+
+			std::size_t sSlot = 0;
+			for (auto& stImport : m_vecImport) {
+				for (auto& stFunc : stImport.ImportFunc) {
+					stFunc.References = 0;
+					for (const auto& vecThreadRefs : vecRefs)
+						stFunc.References += vecThreadRefs[sSlot];
+					++sSlot;
 				}
 			}
 		}
 		catch (const std::bad_alloc&) {
 			m_pEmergencyMemory.reset();
-			MessageBoxW(nullptr, L"E_OUTOFMEMORY error while trying to get Import table.\r\n"
-				L"Too many import entries!\nFile seems to be corrupted.", L"Error", MB_ICONERROR);
+			MessageBoxW(nullptr, L"E_OUTOFMEMORY error while trying to count import references.\nFile seems to be corrupted.",
+				L"Error", MB_ICONERROR);
 
-			m_vecImport.clear();
 			m_pEmergencyMemory = std::make_unique<char[]>(0x8FFF);
-		}
-		catch (...) {
-			MessageBoxW(nullptr, L"Unknown exception raised while trying to get Import table.\r\nFile seems to be corrupted.",
-				L"Error", MB_ICONERROR);
+			return false;
 		}
 
-		m_stFileInfo.HasImport = true;
+		m_stFileInfo.HasImportUsage = true;
 
 		return true;
 	}
@@ -1064,7 +1383,67 @@ namespace libpe {
 		if (!IsPtrSafe(pResDirEntryRoot))
 			return false;
 
-		PIMAGE_RESOURCE_DIR_STRING_U pResDirStr;
+		//Every directory is decoded once. One reached again, through a loop or an entry shared between
+		//subtrees, keeps only its header, and SharedDirIndex tells which decoded directory it repeats.
+		CResDirMap mapResDirs;
+		DWORD dwResDirs{ 0 };
+		mapResDirs.Insert(0, dwResDirs++);
+
+		//Name of the entry, if it is presented by a string rather than an ID.
+		const auto lmbResName = [&](PIMAGE_RESOURCE_DIRECTORY_ENTRY pResDirEntry)->std::wstring {
+			if (!pResDirEntry->NameIsString
+				|| IsSumOverflow(reinterpret_cast<DWORD_PTR>(pResDirRoot), static_cast<DWORD_PTR>(pResDirEntry->NameOffset)))
+				return { };
+
+			const auto pResDirStr = reinterpret_cast<PIMAGE_RESOURCE_DIR_STRING_U>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
+				+ static_cast<DWORD_PTR>(pResDirEntry->NameOffset));
+			if (!IsPtrSafe(pResDirStr))
+				return { };
+
+			//Copy not more then MAX_PATH chars, avoiding overflow.
+			return { pResDirStr->NameString, pResDirStr->Length < MAX_PATH ? pResDirStr->Length : MAX_PATH };
+		};
+
+		//IMAGE_RESOURCE_DATA_ENTRY of a leaf entry, and its RAW data.
+		const auto lmbResData = [&](PIMAGE_RESOURCE_DIRECTORY_ENTRY pResDirEntry, IMAGE_RESOURCE_DATA_ENTRY& stDataEntry)->std::vector<std::byte> {
+			const auto pResDataEntry = reinterpret_cast<PIMAGE_RESOURCE_DATA_ENTRY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
+				+ static_cast<DWORD_PTR>(pResDirEntry->OffsetToData));
+			if (!IsPtrSafe(pResDataEntry))
+				return { };
+
+			stDataEntry = *pResDataEntry;
+			//IMAGE_RESOURCE_DATA_ENTRY::OffsetToData is actually a general RVA,
+			//not an offset from root IMAGE_RESOURCE_DIRECTORY, like IMAGE_RESOURCE_DIRECTORY_ENTRY::OffsetToData.
+			const auto pResRawDataBegin = static_cast<std::byte*>(RVAToPtr(pResDataEntry->OffsetToData));
+			//Checking RAW Resource data pointer out of bounds.
+			if (pResRawDataBegin == nullptr || !IsPtrSafe(reinterpret_cast<DWORD_PTR>(pResRawDataBegin)
+				+ static_cast<DWORD_PTR>(pResDataEntry->Size), true))
+				return { };
+			if (!Checkpoint(pResDataEntry->Size))
+				return { };
+
+			return { pResRawDataBegin, pResRawDataBegin + pResDataEntry->Size };
+		};
+
+		//Fills the header of the subdirectory pResDirEntry points to. Returns the directory if its entries
+		//still have to be decoded, nullptr if it was decoded before, std::nullopt if it is out of bounds.
+		const auto lmbResSubDir = [&](PIMAGE_RESOURCE_DIRECTORY_ENTRY pResDirEntry, auto& stResLvL)->std::optional<PIMAGE_RESOURCE_DIRECTORY> {
+			const auto pResDir = reinterpret_cast<PIMAGE_RESOURCE_DIRECTORY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
+				+ static_cast<DWORD_PTR>(pResDirEntry->OffsetToDirectory));
+			if (!IsPtrSafe(pResDir))
+				return std::nullopt;
+
+			stResLvL.Offset = PtrToOffset(pResDir);
+			stResLvL.ResDir = *pResDir;
+			if (const auto dwIndex = mapResDirs.Find(pResDirEntry->OffsetToDirectory); dwIndex != RESDIR_NOT_SHARED) {
+				stResLvL.SharedDirIndex = dwIndex;
+				return nullptr;
+			}
+
+			stResLvL.DirIndex = dwResDirs;
+			mapResDirs.Insert(pResDirEntry->OffsetToDirectory, dwResDirs++);
+			return pResDir;
+		};
 
 		try {
 			const DWORD dwNumOfEntriesRoot = pResDirRoot->NumberOfNamedEntries + pResDirRoot->NumberOfIdEntries;
@@ -1073,143 +1452,74 @@ namespace libpe {
 
 			std::vector<PEResRootData> vecResDataRoot;
 			vecResDataRoot.reserve(dwNumOfEntriesRoot);
-			for (unsigned iLvLRoot = 0; iLvLRoot < dwNumOfEntriesRoot; ++iLvLRoot) {
-				PIMAGE_RESOURCE_DATA_ENTRY pResDataEntryRoot{ };
-				std::wstring wstrResNameRoot{ };
+			for (unsigned iLvLRoot = 0; iLvLRoot < dwNumOfEntriesRoot && Checkpoint(sizeof(PEResRootData)); ++iLvLRoot) {
+				IMAGE_RESOURCE_DATA_ENTRY stResDataEntryRoot{ };
 				std::vector<std::byte> vecRawResDataRoot{ };
 				PEResLevel2 stResLvL2{ };
 
 				//Name of Resource Type (ICON, BITMAP, MENU, etc...).
-				if (pResDirEntryRoot->NameIsString) {
-					if (IsSumOverflow(reinterpret_cast<DWORD_PTR>(pResDirRoot), static_cast<DWORD_PTR>(pResDirEntryRoot->NameOffset)))
-						break;
-					pResDirStr = reinterpret_cast<PIMAGE_RESOURCE_DIR_STRING_U>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-						+ static_cast<DWORD_PTR>(pResDirEntryRoot->NameOffset));
-					if (IsPtrSafe(pResDirStr))
-						//Copy not more then MAX_PATH chars into wstrResNameRoot, avoiding overflow.
-						wstrResNameRoot.assign(pResDirStr->NameString, pResDirStr->Length < MAX_PATH ? pResDirStr->Length : MAX_PATH);
-				}
+				auto wstrResNameRoot = lmbResName(pResDirEntryRoot);
 				if (pResDirEntryRoot->DataIsDirectory) {
-					const auto pResDirLvL2 = reinterpret_cast<PIMAGE_RESOURCE_DIRECTORY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-						+ static_cast<DWORD_PTR>(pResDirEntryRoot->OffsetToDirectory));
-					if (!IsPtrSafe(pResDirLvL2))
+					const auto optResDirLvL2 = lmbResSubDir(pResDirEntryRoot, stResLvL2);
+					if (!optResDirLvL2)
 						break;
 
-					std::vector<PEResLevel2Data> vecResDataLvL2;
-					if (pResDirLvL2 == pResDirRoot) //Resource loop hack
-						stResLvL2 = { PtrToOffset(pResDirLvL2), *pResDirLvL2, vecResDataLvL2 };
-					else {
+					if (const auto pResDirLvL2 = *optResDirLvL2; pResDirLvL2 != nullptr) {
 						auto pResDirEntryLvL2 = reinterpret_cast<PIMAGE_RESOURCE_DIRECTORY_ENTRY>(pResDirLvL2 + 1);
 						const DWORD dwNumOfEntriesLvL2 = pResDirLvL2->NumberOfNamedEntries + pResDirLvL2->NumberOfIdEntries;
 						if (!IsPtrSafe(pResDirEntryLvL2 + dwNumOfEntriesLvL2))
 							break;
 
+						std::vector<PEResLevel2Data> vecResDataLvL2;
 						vecResDataLvL2.reserve(dwNumOfEntriesLvL2);
-						for (unsigned iLvL2 = 0; iLvL2 < dwNumOfEntriesLvL2; ++iLvL2) {
-							PIMAGE_RESOURCE_DATA_ENTRY pResDataEntryLvL2{ };
-							std::wstring wstrResNameLvL2{ };
+						for (unsigned iLvL2 = 0; iLvL2 < dwNumOfEntriesLvL2 && Checkpoint(sizeof(PEResLevel2Data)); ++iLvL2) {
+							IMAGE_RESOURCE_DATA_ENTRY stResDataEntryLvL2{ };
 							std::vector<std::byte> vecRawResDataLvL2{ };
 							PEResLevel3 stResLvL3{ };
 
 							//Name of resource itself if not presented by ID ("AFX_MY_SUPER_DIALOG"...).
-							if (pResDirEntryLvL2->NameIsString) {
-								if (IsSumOverflow(reinterpret_cast<DWORD_PTR>(pResDirRoot), static_cast<DWORD_PTR>(pResDirEntryLvL2->NameOffset)))
-									break;
-								pResDirStr = reinterpret_cast<PIMAGE_RESOURCE_DIR_STRING_U>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-									+ static_cast<DWORD_PTR>(pResDirEntryLvL2->NameOffset));
-								if (IsPtrSafe(pResDirStr))
-									//Copy not more then MAX_PATH chars into wstrResNameLvL2, avoiding overflow.
-									wstrResNameLvL2.assign(pResDirStr->NameString, pResDirStr->Length < MAX_PATH ? pResDirStr->Length : MAX_PATH);
-							}
-
+							auto wstrResNameLvL2 = lmbResName(pResDirEntryLvL2);
 							if (pResDirEntryLvL2->DataIsDirectory) {
-								const auto pResDirLvL3 = reinterpret_cast<PIMAGE_RESOURCE_DIRECTORY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-									+ static_cast<DWORD_PTR>(pResDirEntryLvL2->OffsetToDirectory));
-								if (!IsPtrSafe(pResDirLvL3))
+								const auto optResDirLvL3 = lmbResSubDir(pResDirEntryLvL2, stResLvL3);
+								if (!optResDirLvL3)
 									break;
 
-								std::vector<PEResLevel3Data> vecResDataLvL3;
-								if (pResDirLvL3 == pResDirLvL2 || pResDirLvL3 == pResDirRoot)
-									stResLvL3 = { PtrToOffset(pResDirLvL3), *pResDirLvL3, vecResDataLvL3 };
-								else {
+								if (const auto pResDirLvL3 = *optResDirLvL3; pResDirLvL3 != nullptr) {
 									auto pResDirEntryLvL3 = reinterpret_cast<PIMAGE_RESOURCE_DIRECTORY_ENTRY>(pResDirLvL3 + 1);
 									const DWORD dwNumOfEntriesLvL3 = pResDirLvL3->NumberOfNamedEntries + pResDirLvL3->NumberOfIdEntries;
 									if (!IsPtrSafe(pResDirEntryLvL3 + dwNumOfEntriesLvL3))
 										break;
 
-									vecResDataLvL3.reserve(dwNumOfEntriesLvL3);
-									for (unsigned iLvL3 = 0; iLvL3 < dwNumOfEntriesLvL3; ++iLvL3) {
-										std::wstring wstrResNameLvL3{ };
-										std::vector<std::byte> vecRawResDataLvL3{ };
-
-										if (pResDirEntryLvL3->NameIsString) {
-											if (IsSumOverflow(reinterpret_cast<DWORD_PTR>(pResDirRoot), static_cast<DWORD_PTR>(pResDirEntryLvL3->NameOffset)))
-												break;
-											pResDirStr = reinterpret_cast<PIMAGE_RESOURCE_DIR_STRING_U>
-												(reinterpret_cast<DWORD_PTR>(pResDirRoot) + static_cast<DWORD_PTR>(pResDirEntryLvL3->NameOffset));
-											if (IsPtrSafe(pResDirStr))
-												//Copy not more then MAX_PATH chars into wstrResNameLvL3, avoiding overflow.
-												wstrResNameLvL3.assign(pResDirStr->NameString, pResDirStr->Length < MAX_PATH ? pResDirStr->Length : MAX_PATH);
-										}
-
-										const auto pResDataEntryLvL3 = reinterpret_cast<PIMAGE_RESOURCE_DATA_ENTRY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-											+ static_cast<DWORD_PTR>(pResDirEntryLvL3->OffsetToData));
-										if (IsPtrSafe(pResDataEntryLvL3)) {	//Resource LvL 3 RAW Data.
-											//IMAGE_RESOURCE_DATA_ENTRY::OffsetToData is actually a general RVA,
-											//not an offset from root IMAGE_RESOURCE_DIRECTORY, like IMAGE_RESOURCE_DIRECTORY_ENTRY::OffsetToData.
-
-											const auto pThirdResRawDataBegin = static_cast<std::byte*>(RVAToPtr(pResDataEntryLvL3->OffsetToData));
-											//Checking RAW Resource data pointer out of bounds.
-											if (pThirdResRawDataBegin && IsPtrSafe(reinterpret_cast<DWORD_PTR>(pThirdResRawDataBegin)
-												+ static_cast<DWORD_PTR>(pResDataEntryLvL3->Size), true)) {
-												vecRawResDataLvL3.assign(pThirdResRawDataBegin, pThirdResRawDataBegin + pResDataEntryLvL3->Size);
-											}
-										}
-
-										vecResDataLvL3.emplace_back(*pResDirEntryLvL3, std::move(wstrResNameLvL3),
-											IsPtrSafe(pResDataEntryLvL3) ? *pResDataEntryLvL3 : IMAGE_RESOURCE_DATA_ENTRY{ }, std::move(vecRawResDataLvL3));
+									stResLvL3.ResData.reserve(dwNumOfEntriesLvL3);
+									for (unsigned iLvL3 = 0; iLvL3 < dwNumOfEntriesLvL3 && Checkpoint(sizeof(PEResLevel3Data)); ++iLvL3) {
+										IMAGE_RESOURCE_DATA_ENTRY stResDataEntryLvL3{ };
+										auto wstrResNameLvL3 = lmbResName(pResDirEntryLvL3);
+										auto vecRawResDataLvL3 = lmbResData(pResDirEntryLvL3, stResDataEntryLvL3); //Resource LvL 3 RAW Data.
+										stResLvL3.ResData.emplace_back(*pResDirEntryLvL3, std::move(wstrResNameLvL3), stResDataEntryLvL3,
+											std::move(vecRawResDataLvL3));
 
 										if (!IsPtrSafe(++pResDirEntryLvL3))
 											break;
 									}
-									stResLvL3 = { PtrToOffset(pResDirLvL3), *pResDirLvL3, std::move(vecResDataLvL3) };
 								}
 							}
-							else {	//////Resource LvL2 RAW Data.
-								pResDataEntryLvL2 = reinterpret_cast<PIMAGE_RESOURCE_DATA_ENTRY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-									+ static_cast<DWORD_PTR>(pResDirEntryLvL2->OffsetToData));
-								if (IsPtrSafe(pResDataEntryLvL2)) {
-									const auto pSecondResRawDataBegin = static_cast<std::byte*>(RVAToPtr(pResDataEntryLvL2->OffsetToData));
-									//Checking RAW Resource data pointer out of bounds.
-									if (pSecondResRawDataBegin && IsPtrSafe(reinterpret_cast<DWORD_PTR>(pSecondResRawDataBegin)
-										+ static_cast<DWORD_PTR>(pResDataEntryLvL2->Size), true)) {
-										vecRawResDataLvL2.assign(pSecondResRawDataBegin, pSecondResRawDataBegin + pResDataEntryLvL2->Size);
-									}
-								}
-							}
-							vecResDataLvL2.emplace_back(*pResDirEntryLvL2, std::move(wstrResNameLvL2),
-								IsPtrSafe(pResDataEntryLvL2) ? *pResDataEntryLvL2 : IMAGE_RESOURCE_DATA_ENTRY{ }, std::move(vecRawResDataLvL2), stResLvL3);
+							else //Resource LvL2 RAW Data.
+								vecRawResDataLvL2 = lmbResData(pResDirEntryLvL2, stResDataEntryLvL2);
+
+							vecResDataLvL2.emplace_back(*pResDirEntryLvL2, std::move(wstrResNameLvL2), stResDataEntryLvL2,
+								std::move(vecRawResDataLvL2), std::move(stResLvL3));
 
 							if (!IsPtrSafe(++pResDirEntryLvL2))
 								break;
 						}
-						stResLvL2 = { PtrToOffset(pResDirLvL2), *pResDirLvL2, std::move(vecResDataLvL2) };
+						stResLvL2.ResData = std::move(vecResDataLvL2);
 					}
 				}
-				else {	//////Resource LvL Root RAW Data.
-					pResDataEntryRoot = reinterpret_cast<PIMAGE_RESOURCE_DATA_ENTRY>(reinterpret_cast<DWORD_PTR>(pResDirRoot)
-						+ static_cast<DWORD_PTR>(pResDirEntryRoot->OffsetToData));
-					if (IsPtrSafe(pResDataEntryRoot)) {
-						auto pRootResRawDataBegin = static_cast<std::byte*>(RVAToPtr(pResDataEntryRoot->OffsetToData));
-						//Checking RAW Resource data pointer out of bounds.
-						if (pRootResRawDataBegin && IsPtrSafe(reinterpret_cast<DWORD_PTR>(pRootResRawDataBegin)
-							+ static_cast<DWORD_PTR>(pResDataEntryRoot->Size), true)) {
-							vecRawResDataRoot.assign(pRootResRawDataBegin, pRootResRawDataBegin + pResDataEntryRoot->Size);
-						}
-					}
-				}
-				vecResDataRoot.emplace_back(*pResDirEntryRoot, std::move(wstrResNameRoot),
-					IsPtrSafe(pResDataEntryRoot) ? *pResDataEntryRoot : IMAGE_RESOURCE_DATA_ENTRY{ }, std::move(vecRawResDataRoot), stResLvL2);
+				else //Resource LvL Root RAW Data.
+					vecRawResDataRoot = lmbResData(pResDirEntryRoot, stResDataEntryRoot);
+
+				vecResDataRoot.emplace_back(*pResDirEntryRoot, std::move(wstrResNameRoot), stResDataEntryRoot,
+					std::move(vecRawResDataRoot), std::move(stResLvL2));
 
 				if (!IsPtrSafe(++pResDirEntryRoot))
 					break;
@@ -1245,7 +1555,7 @@ namespace libpe {
 			return false;
 
 		for (unsigned i = 0; i < dwEntries; ++i, ++pRuntimeFuncsEntry) {
-			if (!IsPtrSafe(pRuntimeFuncsEntry))
+			if (!IsPtrSafe(pRuntimeFuncsEntry) || !Checkpoint(sizeof(PEException)))
 				break;
 
 			m_vecException.emplace_back(PtrToOffset(pRuntimeFuncsEntry), *pRuntimeFuncsEntry);
@@ -1277,11 +1587,20 @@ namespace libpe {
 
 		while (dwSecurityDirStartVA < dwSecurityDirEndVA) {
 			auto pCertificate = reinterpret_cast<LPWIN_CERTIFICATE>(dwSecurityDirStartVA);
+			if (!IsPtrSafe(dwSecurityDirStartVA + offsetof(WIN_CERTIFICATE, bCertificate), true)
+				|| pCertificate->dwLength < offsetof(WIN_CERTIFICATE, bCertificate))
+				break;
+
 			const auto dwCertSize = pCertificate->dwLength - static_cast<DWORD>(offsetof(WIN_CERTIFICATE, bCertificate));
-			if (!IsPtrSafe(dwSecurityDirStartVA + static_cast<DWORD_PTR>(dwCertSize)))
+			if (!IsPtrSafe(dwSecurityDirStartVA + static_cast<DWORD_PTR>(dwCertSize)) || !Checkpoint(sizeof(PESecurity) + dwCertSize))
 				break;
 
-			m_vecSecurity.emplace_back(PtrToOffset(pCertificate), *pCertificate);
+			std::shared_ptr<const PESigner> pSigner;
+			if (pCertificate->wCertificateType == WIN_CERT_TYPE_PKCS_SIGNED_DATA
+				&& IsPtrSafe(dwSecurityDirStartVA + static_cast<DWORD_PTR>(pCertificate->dwLength), true))
+				pSigner = Authenticode::ParseSignedData({ reinterpret_cast<const std::byte*>(pCertificate->bCertificate), dwCertSize });
+
+			m_vecSecurity.emplace_back(PtrToOffset(pCertificate), *pCertificate, std::move(pSigner));
 
 			//Get next certificate entry, all entries start at 8 aligned address.
 			DWORD dwLength = pCertificate->dwLength;
@@ -1313,6 +1632,8 @@ namespace libpe {
 
 				//Amount of Reloc entries.
 				DWORD dwNumRelocEntries = (pBaseRelocDesc->SizeOfBlock - static_cast<DWORD>(sizeof(IMAGE_BASE_RELOCATION))) / static_cast<DWORD>(sizeof(WORD));
+				if (!Checkpoint(sizeof(PERelocation) + static_cast<std::size_t>(dwNumRelocEntries) * sizeof(PERelocData)))
+					break;
 				auto pwRelocEntry = reinterpret_cast<PWORD>(reinterpret_cast<DWORD_PTR>(pBaseRelocDesc) + sizeof(IMAGE_BASE_RELOCATION));
 				std::vector<PERelocData> vecRelocs;
 				for (DWORD i = 0; i < dwNumRelocEntries; ++i, ++pwRelocEntry) {
@@ -1394,7 +1715,7 @@ namespace libpe {
 			return false;
 
 		try {
-			for (unsigned i = 0; i < dwDebugEntries; ++i) {
+			for (unsigned i = 0; i < dwDebugEntries && Checkpoint(sizeof(PEDebug)); ++i) {
 				PEDebugHeader stDbgHdr;
 				for (unsigned iterDbgHdr = 0; iterDbgHdr < (sizeof(PEDebugHeader::Header) / sizeof(DWORD)); iterDbgHdr++) {
 					stDbgHdr.Header[iterDbgHdr] = GetTData<DWORD>(static_cast<size_t>(pDebugDir->PointerToRawData) + (sizeof(DWORD) * iterDbgHdr));
@@ -1407,15 +1728,24 @@ namespace libpe {
 					else if (stDbgHdr.Header[0] == 0x3031424E) //"NB10"
 						dwOffset = sizeof(DWORD) * 4;
 
-					std::string strPDBName;
-					if (dwOffset > 0)
-						for (unsigned iterStr = 0; iterStr < MAX_PATH; iterStr++) {
-							const auto byte = GetTData<BYTE>(pDebugDir->PointerToRawData + dwOffset + iterStr);
-							if (byte == 0) //End of string.
-								break;
-							strPDBName += byte;
-						}
-					stDbgHdr.PDBName = std::move(strPDBName);
+					if (dwOffset > 0 && static_cast<ULONGLONG>(pDebugDir->PointerToRawData) + dwOffset < GetDataSize())
+						if (const auto svName = GetStrView(reinterpret_cast<LPCSTR>(GetBaseAddr() + pDebugDir->PointerToRawData + dwOffset)); svName)
+							stDbgHdr.PDBName = *svName;
+				}
+				else if (pDebugDir->Type == IMAGE_DEBUG_TYPE_POGO && pDebugDir->PointerToRawData > 0) {
+					//Signature ("LTCG", "PGU" ...), then {RVA, Size, zero terminated name} records, each 4 bytes aligned.
+					const ULONGLONG ullStart = pDebugDir->PointerToRawData;
+					const ULONGLONG ullEnd = ullStart + pDebugDir->SizeOfData;
+					ULONGLONG ullEntry = ullStart + sizeof(DWORD);
+					while (ullEnd <= GetDataSize() && ullEntry + sizeof(DWORD) * 2 < ullEnd && Checkpoint(sizeof(PEPogoEntry))) {
+						PEPogoEntry stEntry{ GetTData<DWORD>(ullEntry), GetTData<DWORD>(ullEntry + sizeof(DWORD)) };
+						const auto ullName = ullEntry + sizeof(DWORD) * 2;
+						const auto pszName = reinterpret_cast<LPCSTR>(GetBaseAddr() + ullName);
+						const auto sLen = SimdScan::StrNLen(pszName, static_cast<size_t>(ullEnd - ullName));
+						stEntry.Name.assign(pszName, sLen);
+						stDbgHdr.PogoEntries.emplace_back(std::move(stEntry));
+						ullEntry = ullStart + ((ullName + sLen + 1 - ullStart + 3) & ~3ULL);
+					}
 				}
 
 				m_vecDebug.emplace_back(PtrToOffset(pDebugDir), *pDebugDir, stDbgHdr);
@@ -1498,14 +1828,18 @@ namespace libpe {
 			else
 				return false;
 
-			auto pTLSCallbacks = static_cast<PDWORD>(RVAToPtr(ullAddressOfCallBacks - GetImageBase()));
+			//Callbacks are VAs, 8 bytes wide in PE32+.
+			const auto ullImageBase = GetImageBase();
+			const auto dwPtrSize = m_stFileInfo.IsPE64 ? sizeof(ULONGLONG) : sizeof(DWORD);
+			auto pTLSCallbacks = static_cast<const std::byte*>(RVAToPtr(ullAddressOfCallBacks - ullImageBase));
 			if (pTLSCallbacks) {
-				while (*pTLSCallbacks) {
-					vecTLSCallbacks.push_back(*pTLSCallbacks);
-					if (!IsPtrSafe(++pTLSCallbacks)) {
-						vecTLSCallbacks.clear();
+				while (IsPtrSafe(reinterpret_cast<DWORD_PTR>(pTLSCallbacks) + dwPtrSize, true)) {
+					const auto ullCallback = m_stFileInfo.IsPE64 ? *reinterpret_cast<const ULONGLONG*>(pTLSCallbacks)
+						: *reinterpret_cast<const DWORD*>(pTLSCallbacks);
+					if (ullCallback == 0 || !Checkpoint(sizeof(DWORD)))
 						break;
-					}
+					vecTLSCallbacks.push_back(static_cast<DWORD>(ullCallback - ullImageBase));
+					pTLSCallbacks += dwPtrSize;
 				}
 			}
 
@@ -1535,14 +1869,16 @@ namespace libpe {
 
 			m_stLCD.dwOffset = PtrToOffset(pLCD32);
 			m_stLCD.LCD32 = *pLCD32;
+			ParseGuardTables(pLCD32);
 		}
 		else if (m_stFileInfo.IsPE64) {
 			const auto pLCD64 = static_cast<PIMAGE_LOAD_CONFIG_DIRECTORY64>(RVAToPtr(GetDirEntryRVA(IMAGE_DIRECTORY_ENTRY_LOAD_CONFIG)));
-			if (!pLCD64 || !IsPtrSafe(reinterpret_cast<DWORD_PTR>(pLCD64) + sizeof(PIMAGE_LOAD_CONFIG_DIRECTORY64)))
+			if (!pLCD64 || !IsPtrSafe(reinterpret_cast<DWORD_PTR>(pLCD64) + sizeof(IMAGE_LOAD_CONFIG_DIRECTORY64)))
 				return false;
 
 			m_stLCD.dwOffset = PtrToOffset(pLCD64);
 			m_stLCD.LCD64 = *pLCD64;
+			ParseGuardTables(pLCD64);
 		}
 		else
 			return false;
@@ -1552,46 +1888,148 @@ namespace libpe {
 		return true;
 	}
 
-	bool Clibpe::ParseBoundImport() {
-		auto pBoundImpDesc = static_cast<PIMAGE_BOUND_IMPORT_DESCRIPTOR>(RVAToPtr(GetDirEntryRVA(IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT)));
-		if (pBoundImpDesc == nullptr)
-			return false;
-
-		while (pBoundImpDesc->TimeDateStamp) {
-			std::string strModuleName;
-			std::vector<PEBoundForwarder> vecBoundForwarders;
+	template<typename TLCD>
+	void Clibpe::ParseGuardTables(const TLCD* pLCD) {
+		//LCD grows with every OS release, fields beyond pLCD->Size are not present in the file.
+#define LIBPE_LCD_HAS(field) (pLCD->Size >= offsetof(TLCD, field) + sizeof(TLCD::field))
+		auto& stGuard = m_stLCD.Guard;
+		if (!LIBPE_LCD_HAS(GuardFlags))
+			return;
+
+		stGuard.GuardFlags = pLCD->GuardFlags;
+		const DWORD dwStride = sizeof(DWORD) + ((pLCD->GuardFlags & IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_MASK)
+			>> IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT);
+		stGuard.CFFunctions = ParseGuardTable(pLCD->GuardCFFunctionTable, pLCD->GuardCFFunctionCount, dwStride);
+		if (LIBPE_LCD_HAS(GuardAddressTakenIatEntryCount))
+			stGuard.AddressTakenIAT = ParseGuardTable(pLCD->GuardAddressTakenIatEntryTable, pLCD->GuardAddressTakenIatEntryCount, dwStride);
+		if (LIBPE_LCD_HAS(GuardLongJumpTargetCount))
+			stGuard.LongJumpTargets = ParseGuardTable(pLCD->GuardLongJumpTargetTable, pLCD->GuardLongJumpTargetCount, dwStride);
+		if (LIBPE_LCD_HAS(GuardEHContinuationCount))
+			stGuard.EHContinuations = ParseGuardTable(pLCD->GuardEHContinuationTable, pLCD->GuardEHContinuationCount, dwStride);
+
+		//Flag coverage is counted straight over the mapped table, no per-entry objects.
+		if (stGuard.CFFunctions.Offset && dwStride > sizeof(DWORD)) {
+			uint32_t arrCounts[8];
+			SimdScan::CountStridedFlagBits(m_spnData.data() + stGuard.CFFunctions.Offset, stGuard.CFFunctions.Count,
+				dwStride, sizeof(DWORD), arrCounts);
+			stGuard.SuppressedFuncs = arrCounts[0];    //IMAGE_GUARD_FLAG_FID_SUPPRESSED
+			stGuard.ExpSuppressedFuncs = arrCounts[1]; //IMAGE_GUARD_FLAG_EXPORT_SUPPRESSED
+			stGuard.LangExcptFuncs = arrCounts[2];     //IMAGE_GUARD_FLAG_FID_LANGEXCPTHANDLER
+			stGuard.XFGFuncs = arrCounts[3];           //IMAGE_GUARD_FLAG_FID_XFG
+		}
 
-			auto pBoundImpForwarder = reinterpret_cast<PIMAGE_BOUND_FORWARDER_REF>(pBoundImpDesc + 1);
-			if (!IsPtrSafe(pBoundImpForwarder))
+		//Dynamic value relocation table: either section relative (newer linkers) or by VA.
+		const std::byte* pDynRelocTable{ };
+		if (LIBPE_LCD_HAS(DynamicValueRelocTableSection) && pLCD->DynamicValueRelocTableSection != 0
+			&& pLCD->DynamicValueRelocTableSection <= m_vecSecHeaders.size()) {
+			const auto& stSecHdr = m_vecSecHeaders[pLCD->DynamicValueRelocTableSection - 1].SecHdr;
+			pDynRelocTable = m_spnData.data() + static_cast<ULONGLONG>(stSecHdr.PointerToRawData) + pLCD->DynamicValueRelocTableOffset;
+		}
+		else if (LIBPE_LCD_HAS(DynamicValueRelocTable) && pLCD->DynamicValueRelocTable > GetImageBase())
+			pDynRelocTable = static_cast<const std::byte*>(RVAToPtr(pLCD->DynamicValueRelocTable - GetImageBase()));
+#undef LIBPE_LCD_HAS
+
+		if (pDynRelocTable == nullptr || !IsPtrSafe(reinterpret_cast<DWORD_PTR>(pDynRelocTable) + sizeof(IMAGE_DYNAMIC_RELOCATION_TABLE), true))
+			return;
+
+		const auto pDynTable = reinterpret_cast<const IMAGE_DYNAMIC_RELOCATION_TABLE*>(pDynRelocTable);
+		if (pDynTable->Version != 1 && pDynTable->Version != 2)
+			return;
+
+		stGuard.DynRelocOffset = PtrToOffset(pDynTable);
+		stGuard.DynRelocVersion = pDynTable->Version;
+
+		auto pEntry = pDynRelocTable + sizeof(IMAGE_DYNAMIC_RELOCATION_TABLE);
+		const auto pEnd = pEntry + pDynTable->Size;
+		if (!IsPtrSafe(reinterpret_cast<DWORD_PTR>(pEnd), true))
+			return;
+
+		//Entries: { Symbol, BaseRelocSize } (v1) or { HeaderSize, FixupInfoSize, Symbol, ... } (v2).
+		//Symbol is ULONGLONG for PE32+ and DWORD for PE32.
+		const std::size_t sSymbolSize = m_stFileInfo.IsPE64 ? sizeof(ULONGLONG) : sizeof(DWORD);
+		while (pEntry < pEnd) {
+			ULONGLONG ullSymbol{ };
+			std::size_t sEntrySize;
+			if (pDynTable->Version == 1) {
+				if (pEntry + sSymbolSize + sizeof(DWORD) > pEnd)
+					break;
+				DWORD dwBaseRelocSize;
+				memcpy(&ullSymbol, pEntry, sSymbolSize);
+				memcpy(&dwBaseRelocSize, pEntry + sSymbolSize, sizeof(DWORD));
+				sEntrySize = sSymbolSize + sizeof(DWORD) + dwBaseRelocSize;
+			}
+			else {
+				if (pEntry + sizeof(DWORD) * 2 + sSymbolSize > pEnd)
+					break;
+				DWORD dwHeaderSize, dwFixupInfoSize;
+				memcpy(&dwHeaderSize, pEntry, sizeof(DWORD));
+				memcpy(&dwFixupInfoSize, pEntry + sizeof(DWORD), sizeof(DWORD));
+				memcpy(&ullSymbol, pEntry + sizeof(DWORD) * 2, sSymbolSize);
+				sEntrySize = static_cast<std::size_t>(dwHeaderSize) + dwFixupInfoSize;
+				if (dwHeaderSize == 0)
+					break;
+			}
+			if (sEntrySize == 0 || pEntry + sEntrySize > pEnd)
 				break;
 
-			for (unsigned i = 0; i < pBoundImpDesc->NumberOfModuleForwarderRefs; ++i) {
-				std::string strForwarderModuleName{ };
+			++stGuard.DynRelocCount;
+			if (ullSymbol < 32)
+				stGuard.DynRelocSymbols |= 1UL << ullSymbol;
+			pEntry += sEntrySize;
+		}
+	}
 
-				const auto szName = reinterpret_cast<LPCSTR>(reinterpret_cast<DWORD_PTR>(pBoundImpDesc) + pBoundImpForwarder->OffsetModuleName);
-				if (IsPtrSafe(szName))
-					if (szName && (StringCchLengthA(szName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-						strForwarderModuleName = szName;
+	auto Clibpe::ParseGuardTable(ULONGLONG ullTableVA, ULONGLONG ullCount, DWORD dwStride)const->PEGuardTable {
+		if (ullTableVA == 0 || ullCount == 0 || ullTableVA < GetImageBase())
+			return { };
 
-				vecBoundForwarders.emplace_back(PtrToOffset(pBoundImpForwarder), *pBoundImpForwarder, std::move(strForwarderModuleName));
+		const auto pTable = RVAToPtr(ullTableVA - GetImageBase());
+		if (pTable == nullptr)
+			return { };
 
-				if (!IsPtrSafe(++pBoundImpForwarder))
-					break;
+		//Bogus counts are clamped to what actually fits in the file.
+		const auto ullAvail = (GetDataSize() - PtrToOffset(pTable)) / dwStride;
+		return { PtrToOffset(pTable), static_cast<DWORD>(ullCount < ullAvail ? ullCount : ullAvail), dwStride };
+	}
 
-				pBoundImpDesc = reinterpret_cast<PIMAGE_BOUND_IMPORT_DESCRIPTOR>(reinterpret_cast<DWORD_PTR>(pBoundImpDesc) + sizeof(IMAGE_BOUND_FORWARDER_REF));
-				if (!IsPtrSafe(pBoundImpDesc))
-					break;
-			}
+	bool Clibpe::ParseBoundImport() {
+		const auto pBoundImpDir = static_cast<PIMAGE_BOUND_IMPORT_DESCRIPTOR>(RVAToPtr(GetDirEntryRVA(IMAGE_DIRECTORY_ENTRY_BOUND_IMPORT)));
+		if (pBoundImpDir == nullptr)
+			return false;
+
+		//Descriptors and their forwarder refs are one flat array of 8 byte entries: a descriptor is
+		//followed by its NumberOfModuleForwarderRefs forwarder refs, then the next descriptor.
+		//Name offsets of both are relative to the start of the directory, not to the entry.
+		const auto lmbName = [&](WORD wOffsetModuleName)->std::string {
+			const auto szName = reinterpret_cast<LPCSTR>(reinterpret_cast<DWORD_PTR>(pBoundImpDir) + wOffsetModuleName);
+			if (const auto svName = GetStrView(szName); svName)
+				return std::string(*svName);
+			return { };
+		};
 
-			const auto szName = reinterpret_cast<LPCSTR>(reinterpret_cast<DWORD_PTR>(pBoundImpDesc) + pBoundImpDesc->OffsetModuleName);
-			if (IsPtrSafe(szName))
-				if (StringCchLengthA(szName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER)
-					strModuleName = szName;
+		auto pBoundImpDesc = pBoundImpDir;
+		DWORD dwModulesCount = 0;
+		while (IsPtrSafe(reinterpret_cast<DWORD_PTR>(pBoundImpDesc) + sizeof(IMAGE_BOUND_IMPORT_DESCRIPTOR), true)
+			&& pBoundImpDesc->OffsetModuleName != 0 && dwModulesCount++ < m_stParseOpts.dwMaxImportModules
+			&& Checkpoint(sizeof(PEBoundImport) + static_cast<std::size_t>(pBoundImpDesc->NumberOfModuleForwarderRefs) * sizeof(PEBoundForwarder))) {
+			std::vector<PEBoundForwarder> vecBoundForwarders;
+			bool fTruncated = false;
 
-			m_vecBoundImp.emplace_back(PtrToOffset(pBoundImpDesc), *pBoundImpDesc, std::move(strModuleName), std::move(vecBoundForwarders));
+			auto pBoundImpForwarder = reinterpret_cast<PIMAGE_BOUND_FORWARDER_REF>(pBoundImpDesc + 1);
+			for (unsigned i = 0; i < pBoundImpDesc->NumberOfModuleForwarderRefs; ++i, ++pBoundImpForwarder) {
+				if (!IsPtrSafe(reinterpret_cast<DWORD_PTR>(pBoundImpForwarder) + sizeof(IMAGE_BOUND_FORWARDER_REF), true)) {
+					fTruncated = true;
+					break;
+				}
+
+				vecBoundForwarders.emplace_back(PtrToOffset(pBoundImpForwarder), *pBoundImpForwarder, lmbName(pBoundImpForwarder->OffsetModuleName));
+			}
 
-			if (!IsPtrSafe(++pBoundImpDesc))
+			m_vecBoundImp.emplace_back(PtrToOffset(pBoundImpDesc), *pBoundImpDesc, lmbName(pBoundImpDesc->OffsetModuleName), std::move(vecBoundForwarders));
+			if (fTruncated)
 				break;
+
+			pBoundImpDesc = reinterpret_cast<PIMAGE_BOUND_IMPORT_DESCRIPTOR>(pBoundImpForwarder);
 		}
 
 		m_stFileInfo.HasBoundImp = true;
@@ -1615,7 +2053,7 @@ namespace libpe {
 			return false;
 
 		if (m_stFileInfo.IsPE32) {
-			while (pDelayImpDescr->DllNameRVA) {
+			while (pDelayImpDescr->DllNameRVA && Checkpoint(sizeof(PEDelayImport))) {
 				auto pThunk32Name = reinterpret_cast<PIMAGE_THUNK_DATA32>(static_cast<DWORD_PTR>(pDelayImpDescr->ImportNameTableRVA));
 
 				if (!pThunk32Name) {
@@ -1634,7 +2072,7 @@ namespace libpe {
 					if (!pThunk32Name)
 						break;
 
-					while (pThunk32Name->u1.AddressOfData) {
+					while (pThunk32Name->u1.AddressOfData && Checkpoint(sizeof(PEDelayImportFunc))) {
 						PEDelayImportFunc::PEDelayImportThunk unDelayImpThunk32{ };
 						unDelayImpThunk32.st32.ImportAddressTable = *pThunk32Name;
 						unDelayImpThunk32.st32.ImportNameTable = pThunk32IAT ? *pThunk32IAT : IMAGE_THUNK_DATA32{ };
@@ -1645,9 +2083,9 @@ namespace libpe {
 						IMAGE_IMPORT_BY_NAME stImpByName{ };
 						if (!(pThunk32Name->u1.Ordinal & IMAGE_ORDINAL_FLAG32)) {
 							const auto pName = static_cast<PIMAGE_IMPORT_BY_NAME>(RVAToPtr(pThunk32Name->u1.AddressOfData));
-							if (pName && (StringCchLengthA(pName->Name, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER)) {
+							if (const auto svName = GetStrView(pName ? pName->Name : nullptr); svName) {
 								stImpByName = *pName;
-								strFuncName = pName->Name;
+								strFuncName = *svName;
 							}
 						}
 						vecFunc.emplace_back(unDelayImpThunk32, stImpByName, std::move(strFuncName));
@@ -1666,8 +2104,8 @@ namespace libpe {
 					}
 
 					const auto szName = static_cast<LPCSTR>(RVAToPtr(pDelayImpDescr->DllNameRVA));
-					if (szName && (StringCchLengthA(szName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-						strDllName = szName;
+					if (const auto svName = GetStrView(szName); svName)
+						strDllName = *svName;
 
 					m_vecDelayImp.emplace_back(PtrToOffset(pDelayImpDescr), *pDelayImpDescr, std::move(strDllName), std::move(vecFunc));
 
@@ -1677,7 +2115,7 @@ namespace libpe {
 			}
 		}
 		else if (m_stFileInfo.IsPE64) {
-			while (pDelayImpDescr->DllNameRVA) {
+			while (pDelayImpDescr->DllNameRVA && Checkpoint(sizeof(PEDelayImport))) {
 				auto pThunk64Name = reinterpret_cast<PIMAGE_THUNK_DATA64>(static_cast<DWORD_PTR>(pDelayImpDescr->ImportNameTableRVA));
 
 				if (!pThunk64Name) {
@@ -1696,7 +2134,7 @@ namespace libpe {
 					if (!pThunk64Name)
 						break;
 
-					while (pThunk64Name->u1.AddressOfData) {
+					while (pThunk64Name->u1.AddressOfData && Checkpoint(sizeof(PEDelayImportFunc))) {
 						PEDelayImportFunc::PEDelayImportThunk unDelayImpThunk64{ };
 						unDelayImpThunk64.st64.ImportAddressTable = *pThunk64Name;
 						unDelayImpThunk64.st64.ImportNameTable = pThunk64IAT ? *pThunk64IAT : IMAGE_THUNK_DATA64{ };
@@ -1707,9 +2145,9 @@ namespace libpe {
 						IMAGE_IMPORT_BY_NAME stImpByName{ };
 						if (!(pThunk64Name->u1.Ordinal & IMAGE_ORDINAL_FLAG64)) {
 							const auto pName = static_cast<PIMAGE_IMPORT_BY_NAME>(RVAToPtr(pThunk64Name->u1.AddressOfData));
-							if (pName && (StringCchLengthA(pName->Name, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER)) {
+							if (const auto svName = GetStrView(pName ? pName->Name : nullptr); svName) {
 								stImpByName = *pName;
-								strFuncName = pName->Name;
+								strFuncName = *svName;
 							}
 						}
 						vecFunc.emplace_back(unDelayImpThunk64, stImpByName, std::move(strFuncName));
@@ -1728,8 +2166,8 @@ namespace libpe {
 					}
 
 					const auto szName = static_cast<LPCSTR>(RVAToPtr(pDelayImpDescr->DllNameRVA));
-					if (szName && (StringCchLengthA(szName, MAX_PATH, nullptr) != STRSAFE_E_INVALID_PARAMETER))
-						strDllName = szName;
+					if (const auto svName = GetStrView(szName); svName)
+						strDllName = *svName;
 
 					m_vecDelayImp.emplace_back(PtrToOffset(pDelayImpDescr), *pDelayImpDescr, std::move(strDllName), std::move(vecFunc));
 
@@ -1754,4 +2192,71 @@ namespace libpe {
 
 		return true;
 	}
-}
\ No newline at end of file
+
+	bool Clibpe::ParseEmbedded() {
+		if (!m_stParseOpts.fScanEmbedded)
+			return false;
+
+		//"MZ" candidates come from the vectorized pair search; an image that holds up is skipped
+		//as a whole, images nested in it are found when it is loaded itself.
+		const auto lmbScan = [&](std::span<const std::byte> spnData, DWORD dwBaseOffset, const std::wstring& wstrSource) {
+			for (std::size_t sPos = 0; sPos < spnData.size() && m_vecEmbedded.size() < m_stParseOpts.dwMaxEmbedded; ) {
+				sPos += SimdScan::FindPair(spnData.data() + sPos, spnData.size() - sPos, 'M', 'Z');
+				if (sPos >= spnData.size())
+					break;
+
+				const auto spnImage = spnData.subspan(sPos);
+				if (const auto dwSize = GetImageSizeInPlace(spnImage); dwSize != 0) {
+					//A resource covering the whole file holds the host itself, loading it would find it again.
+					if (sPos == 0 && dwSize == m_spnData.size()) {
+						sPos += dwSize;
+						continue;
+					}
+					if (!Checkpoint(dwSize))
+						break;
+					m_vecEmbedded.emplace_back(dwBaseOffset + static_cast<DWORD>(sPos), dwSize, wstrSource,
+						std::vector<std::byte>(spnImage.begin(), spnImage.begin() + dwSize));
+					sPos += dwSize;
+				}
+				else
+					++sPos;
+			}
+		};
+
+		try {
+			for (const auto& stRes : FlatResources(m_stResource)) {
+				const auto lmbPart = [](std::wstring_view wsvStr, WORD wID) {
+					return wsvStr.empty() ? std::to_wstring(wID) : std::wstring(wsvStr);
+				};
+				std::wstring wstrType;
+				if (const auto iter = MapResID.find(stRes.TypeID); stRes.TypeStr.empty() && iter != MapResID.end())
+					wstrType = iter->second;
+				else
+					wstrType = lmbPart(stRes.TypeStr, stRes.TypeID);
+				lmbScan(stRes.Data, 0, wstrType + L"\\" + lmbPart(stRes.NameStr, stRes.NameID) + L"\\" + lmbPart(stRes.LangStr, stRes.LangID));
+			}
+
+			//The overlay starts past the headers and the last section's raw data.
+			ULONGLONG ullOverlay = m_stFileInfo.IsPE64 ? m_pNTHeader64->OptionalHeader.SizeOfHeaders : m_pNTHeader32->OptionalHeader.SizeOfHeaders;
+			for (const auto& stSec : m_vecSecHeaders)
+				if (stSec.SecHdr.SizeOfRawData != 0)
+					ullOverlay = (std::max)(ullOverlay, static_cast<ULONGLONG>(stSec.SecHdr.PointerToRawData) + stSec.SecHdr.SizeOfRawData);
+			if (ullOverlay < m_spnData.size() && m_spnData.size() <= 0xFFFFFFFFULL)
+				lmbScan(m_spnData.subspan(static_cast<std::size_t>(ullOverlay)), static_cast<DWORD>(ullOverlay), L"Overlay");
+		}
+		catch (const std::bad_alloc&) {
+			m_pEmergencyMemory.reset();
+			MessageBoxW(nullptr, L"E_OUTOFMEMORY error while trying to copy embedded images.\nFile seems to be corrupted.",
+				L"Error", MB_ICONERROR);
+
+			m_pEmergencyMemory = std::make_unique<char[]>(0x8FFF);
+		}
+
+		if (m_vecEmbedded.empty())
+			return false;
+
+		m_stFileInfo.HasEmbedded = true;
+
+		return true;
+	}
+}
@@ -7,6 +7,8 @@
 #pragma once
 #include <Windows.h>
 #include <WinTrust.h> //WIN_CERTIFICATE struct.
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <span>
 #include <string>
@@ -146,6 +148,7 @@ namespace libpe
 		DWORD                Offset;   //File's raw offset of this section header descriptor.
 		IMAGE_SECTION_HEADER SecHdr;   //Standard section header.
 		std::string          SectionName; //Section full name.
+		double               Entropy { -1 }; //Bits per byte of the raw data (0-8) with fSectionEntropy, -1 otherwise.
 	};
 	using PESECHDR_VEC = std::vector<PESectionHeader>;
 	inline const std::unordered_map<DWORD, std::wstring_view> MapSecHdrCharact {
@@ -217,6 +220,8 @@ namespace libpe
 		} unThunk;
 		IMAGE_IMPORT_BY_NAME ImpByName; //Standard IMAGE_IMPORT_BY_NAME struct
 		std::string          FuncName; //Function name.
+		bool                 ByOrdinal { }; //The thunk has the ordinal flag set, ImpByName is empty.
+		DWORD                References { }; //call/jmp [IAT slot] instructions found in code, with fScanImportUsage.
 	};
 	struct PEImport {
 		DWORD                     Offset;      //File's raw offset of this Import descriptor.
@@ -241,6 +246,9 @@ namespace libpe
 	* IMAGE_RESOURCE_DIRECTORY_ENTRY of the last, third, level of resources.                            *
 	****************************************************************************************************/
 
+	//PEResLevel2/PEResLevel3::SharedDirIndex of a directory that is decoded in its place.
+	constexpr auto RESDIR_NOT_SHARED = static_cast<DWORD>(-1);
+
 	//Level 3/Lang (the lowest) resources.
 	struct PEResLevel3Data {
 		IMAGE_RESOURCE_DIRECTORY_ENTRY ResDirEntry;  //Level 3 (Lang) standard IMAGE_RESOURCE_DIRECTORY_ENTRY struct.
@@ -254,6 +262,8 @@ namespace libpe
 		DWORD                      Offset;   //File's raw offset of this level 3 IMAGE_RESOURCE_DIRECTORY descriptor.
 		IMAGE_RESOURCE_DIRECTORY   ResDir;   //Level 3 standard IMAGE_RESOURCE_DIRECTORY header.
 		std::vector<PEResLevel3Data> ResData; //Array of level 3 resource entries.
+		DWORD                      DirIndex { };  //Decode order index of this directory, root is 0.
+		DWORD                      SharedDirIndex { RESDIR_NOT_SHARED }; //Directory already decoded under this index (loop or shared subtree), ResData is empty then.
 	};
 	using PERESLANG = PEResLevel3;
 
@@ -271,6 +281,8 @@ namespace libpe
 		DWORD                      Offset;   //File's raw offset of this level 2 IMAGE_RESOURCE_DIRECTORY descriptor.
 		IMAGE_RESOURCE_DIRECTORY   ResDir;   //Level 2 standard IMAGE_RESOURCE_DIRECTORY header.
 		std::vector<PEResLevel2Data> ResData; //Array of level 2 resource entries.
+		DWORD                      DirIndex { };  //Decode order index of this directory, root is 0.
+		DWORD                      SharedDirIndex { RESDIR_NOT_SHARED }; //Directory already decoded under this index (loop or shared subtree), ResData is empty then.
 	};
 	using PERESNAME = PEResLevel2;
 
@@ -338,9 +350,19 @@ namespace libpe
 	using PEEXCEPTION_VEC = std::vector<PEException>;
 
 	//Security table.
+	//Authenticode signer, decoded from the PKCS#7 SignedData of a WIN_CERT_TYPE_PKCS_SIGNED_DATA certificate.
+	//Signers are shared between all files signed with the same certificate (see Authenticode.h).
+	struct PESigner {
+		std::wstring Subject;         //Signer certificate subject ("CN=..., O=..., C=...").
+		std::wstring Issuer;          //Signer certificate issuer.
+		std::string  Serial;          //Signer certificate serial number, hex.
+		std::string  DigestAlgorithm; //SignerInfo digest algorithm ("SHA256", ... or dotted OID).
+		ULONGLONG    CertHash;        //FNV-1a hash of the signer certificate DER encoding, with the digest OID the signer cache key.
+	};
 	struct PESecurity {
 		DWORD           Offset;  //File's raw offset of this security descriptor.
 		WIN_CERTIFICATE WinCert; //Standard WIN_CERTIFICATE header.
+		std::shared_ptr<const PESigner> Signer; //Decoded signer, nullptr if not PKCS#7 or undecodable.
 	};
 	using PESECURITY_VEC = std::vector<PESecurity>;
 	inline const std::unordered_map<DWORD, std::wstring_view> MapWinCertRevision {
@@ -382,6 +404,12 @@ namespace libpe
 
 
 	//Debug table.
+	//IMAGE_DEBUG_TYPE_POGO record: a COFF section group the linker merged, e.g. ".CRT$XCU".
+	struct PEPogoEntry {
+		DWORD       RVA;  //RVA of the group.
+		DWORD       Size; //Size of the group.
+		std::string Name; //Group name.
+	};
 	struct PEDebugHeader {
 		//dwHdr[6] is an array of the first six DWORDs of IMAGE_DEBUG_DIRECTORY::PointerToRawData data (Debug info header).
 		//Their meaning varies depending on dwHdr[0] (Signature) value.
@@ -391,6 +419,7 @@ namespace libpe
 		// Then dwHdr[1] is Offset. dwHdr[2] is Time/Signature. dwHdr[3] is Counter/Age.
 		DWORD       Header[6];
 		std::string PDBName; //PDB file name/path.
+		std::vector<PEPogoEntry> PogoEntries; //IMAGE_DEBUG_TYPE_POGO section groups.
 	};
 	struct PEDebug {
 		DWORD                 Offset;       //File's raw offset of this Debug descriptor.
@@ -425,7 +454,7 @@ namespace libpe
 			IMAGE_TLS_DIRECTORY32 TLSDir32; //x86 standard TLS header.
 			IMAGE_TLS_DIRECTORY64 TLSDir64; //x64 TLS header.
 		} unTLS;
-		std::vector<DWORD> TLSCallbacks;   //Array of the TLS callbacks.
+		std::vector<DWORD> TLSCallbacks;   //Array of the TLS callbacks RVAs.
 	};
 	inline const std::unordered_map<DWORD, std::wstring_view> MapTLSCharact {
 		{ IMAGE_SCN_ALIGN_1BYTES, L"IMAGE_SCN_ALIGN_1BYTES" },
@@ -446,12 +475,84 @@ namespace libpe
 	};
 
 	//LoadConfigDirectory.
+#ifndef IMAGE_GUARD_EH_CONTINUATION_TABLE_PRESENT
+#define IMAGE_GUARD_EH_CONTINUATION_TABLE_PRESENT 0x00400000
+#endif
+#ifndef IMAGE_GUARD_XFG_ENABLED
+#define IMAGE_GUARD_XFG_ENABLED 0x00800000
+#endif
+#ifndef IMAGE_GUARD_FLAG_FID_LANGEXCPTHANDLER
+#define IMAGE_GUARD_FLAG_FID_LANGEXCPTHANDLER 0x04
+#endif
+#ifndef IMAGE_GUARD_FLAG_FID_XFG
+#define IMAGE_GUARD_FLAG_FID_XFG 0x08
+#endif
+#ifndef IMAGE_DEBUG_TYPE_EX_DLLCHARACTERISTICS
+#define IMAGE_DEBUG_TYPE_EX_DLLCHARACTERISTICS 20
+#endif
+#ifndef IMAGE_DLLCHARACTERISTICS_EX_CET_COMPAT
+#define IMAGE_DLLCHARACTERISTICS_EX_CET_COMPAT 0x01
+#endif
+
+	//Guard tables (GuardCFFunctionTable, GuardAddressTakenIatEntryTable, etc...) are not copied.
+	//They are described in place and can be decoded lazily from the file data with PEGuardTableView.
+	struct PEGuardTable {
+		DWORD Offset; //File's raw offset of the table, 0 if absent.
+		DWORD Count;  //Amount of entries.
+		DWORD Stride; //Entry size: RVA DWORD + extra bytes from IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_MASK.
+	};
+	struct PEGuardInfo {
+		DWORD        GuardFlags;        //LCD GuardFlags, 0 if the LCD is too old to have them.
+		PEGuardTable CFFunctions;       //GuardCFFunctionTable.
+		PEGuardTable AddressTakenIAT;   //GuardAddressTakenIatEntryTable.
+		PEGuardTable LongJumpTargets;   //GuardLongJumpTargetTable.
+		PEGuardTable EHContinuations;   //GuardEHContinuationTable.
+		DWORD        SuppressedFuncs;   //CF functions with IMAGE_GUARD_FLAG_FID_SUPPRESSED.
+		DWORD        ExpSuppressedFuncs;//CF functions with IMAGE_GUARD_FLAG_EXPORT_SUPPRESSED.
+		DWORD        LangExcptFuncs;    //CF functions with IMAGE_GUARD_FLAG_FID_LANGEXCPTHANDLER.
+		DWORD        XFGFuncs;          //CF functions with IMAGE_GUARD_FLAG_FID_XFG.
+		DWORD        DynRelocOffset;    //File's raw offset of the IMAGE_DYNAMIC_RELOCATION_TABLE, 0 if absent.
+		DWORD        DynRelocVersion;   //IMAGE_DYNAMIC_RELOCATION_TABLE::Version.
+		DWORD        DynRelocCount;     //Amount of IMAGE_DYNAMIC_RELOCATION entries.
+		DWORD        DynRelocSymbols;   //Bit mask of the entries' Symbol values (1 << Symbol), for Symbol < 32.
+	};
 	struct PELoadConfig {
 		DWORD dwOffset;                            //File's raw offset of the LCD descriptor.
 		union {
 			IMAGE_LOAD_CONFIG_DIRECTORY32 LCD32; //x86 LCD descriptor.
 			IMAGE_LOAD_CONFIG_DIRECTORY64 LCD64; //x64 LCD descriptor.
 		};
+		PEGuardInfo Guard;                         //Guard tables and their coverage counts.
+	};
+
+	struct PEGuardTableEntry {
+		DWORD RVA;   //Target RVA.
+		BYTE  Flags; //IMAGE_GUARD_FLAG_* byte, 0 if the table stride has no extra bytes.
+	};
+	//In place decoder of a PEGuardTable, over the same data the PE was loaded from.
+	class PEGuardTableView {
+	public:
+		PEGuardTableView(std::span<const std::byte> spnFile, const PEGuardTable& stTable) {
+			if (stTable.Offset == 0 || stTable.Stride < sizeof(DWORD) || stTable.Offset > spnFile.size())
+				return;
+			const auto ullAvail = (spnFile.size() - stTable.Offset) / stTable.Stride;
+			m_pData = spnFile.data() + stTable.Offset;
+			m_dwCount = static_cast<DWORD>(ullAvail < stTable.Count ? ullAvail : stTable.Count);
+			m_dwStride = stTable.Stride;
+		}
+		[[nodiscard]] auto Size()const->DWORD { return m_dwCount; }
+		[[nodiscard]] auto operator[](DWORD dwIndex)const->PEGuardTableEntry {
+			const auto pEntry = m_pData + static_cast<std::size_t>(dwIndex) * m_dwStride;
+			PEGuardTableEntry stEntry{ };
+			memcpy(&stEntry.RVA, pEntry, sizeof(DWORD));
+			if (m_dwStride > sizeof(DWORD))
+				stEntry.Flags = static_cast<BYTE>(pEntry[sizeof(DWORD)]);
+			return stEntry;
+		}
+	private:
+		const std::byte* m_pData{ };
+		DWORD m_dwCount{ };
+		DWORD m_dwStride{ };
 	};
 	inline const std::unordered_map<DWORD, std::wstring_view> MapLCDGuardFlags {
 		{ IMAGE_GUARD_CF_INSTRUMENTED, L"IMAGE_GUARD_CF_INSTRUMENTED (Module performs control flow integrity checks using system-supplied support)" },
@@ -527,6 +628,38 @@ namespace libpe
 		{ ReplacesCorHdrNumericDefines::COMIMAGE_FLAGS_32BITPREFERRED, L"COMIMAGE_FLAGS_32BITPREFERRED" }
 	};
 
+	//PE image embedded in a resource or in the overlay (the data after the last section).
+	struct PEEmbedded {
+		DWORD                  Offset;  //Offset of the image inside the resource data, or file's raw offset for the overlay.
+		DWORD                  Size;    //Size of the image on disk: headers and sections' raw data.
+		std::wstring           Source;  //"Overlay", or the resource path: L"RT_RCDATA\\101\\1033".
+		std::vector<std::byte> Data;    //Copy of the image, to load with LoadPe(std::span).
+	};
+	using PEEMBEDDED_VEC = std::vector<PEEmbedded>;
+
+	//Parsing options, limits for the tables a hostile file can blow up.
+	//Import and export callbacks stream entries while the tables are parsed, return false to stop.
+	//With fStoreImports/fStoreExports off the entries are only streamed and not kept in GetImport/GetExport.
+	//Parsing checks pfCancel and ullMaxAlloc between entries; when either stops it the tables parsed
+	//so far are kept, LoadPe still returns PEOK and GetParseStatus tells why the rest is missing.
+	struct PEParseOptions {
+		DWORD dwMaxImportModules { 1000 };  //Import descriptors, the rest is considered bogus.
+		DWORD dwMaxImportFuncs { 5000 };    //Functions per import descriptor.
+		DWORD dwMaxExportFuncs { 0x10000 }; //Export address table entries, ordinals are 16 bit anyway.
+		DWORD dwMaxNameLength { 4096 };     //Longest import/export/module name, longer names are dropped.
+		bool  fStoreImports { true };
+		bool  fStoreExports { true };
+		bool  fScanEmbedded { true };       //Look for PE images in resources and in the overlay.
+		DWORD dwMaxEmbedded { 64 };         //Embedded images, the rest is not searched for.
+		bool  fSectionEntropy { true };     //Byte entropy of every section's raw data.
+		bool  fScanImportUsage { false };   //Count the code references to every IAT slot (needs fStoreImports), or later with ScanImportUsage.
+		DWORD dwUsageThreads { 0 };         //Threads for that code scan, 0 - one per logical processor.
+		std::function<bool(const PEImport& stImport, const PEImportFunction& stFunc)> fnImportFunc; //stImport.ImportFunc isn't complete yet.
+		std::function<bool(const PEExportFunction& stFunc)> fnExportFunc;
+		const std::atomic<bool>* pfCancel { }; //Set from another thread to stop parsing, must outlive LoadPe.
+		ULONGLONG ullMaxAlloc { 0 };           //Bytes the parsed tables may take (roughly), 0 - no limit.
+	};
+
 	//File information struct.
 	struct PEFILEINFO {
 		bool IsPE32 : 1 {};
@@ -551,6 +684,8 @@ namespace libpe
 		bool HasIAT : 1 {};
 		bool HasDelayImp : 1 {};
 		bool HasCOMDescr : 1 {};
+		bool HasEmbedded : 1 {};
+		bool HasImportUsage : 1 {};
 	};
 
 	//Pure abstract base class Ilibpe.
@@ -559,6 +694,9 @@ namespace libpe
 	public:
 		virtual auto LoadPe(LPCWSTR pwszFile) -> int = 0;                   //Load PE file from file.
 		virtual auto LoadPe(std::span<const std::byte> spnFile) -> int = 0; //Load PE file from memory.
+		virtual void SetParseOptions(const PEParseOptions& stOpts) = 0;    //Options for the following LoadPe calls.
+		[[nodiscard]] virtual auto GetParseStatus()const->int = 0;         //PEOK, or why the last LoadPe stopped parsing early.
+		virtual auto ScanImportUsage() -> bool = 0;                        //Count the IAT references of the loaded file if LoadPe didn't.
 		[[nodiscard]] virtual auto IsLoaded() const -> bool = 0;
 		[[nodiscard]] virtual auto GetFileInfo()const->PEFILEINFO const* = 0;
 		[[nodiscard]] virtual auto GetOffsetFromRVA(ULONGLONG ullRVA)const->DWORD = 0;
@@ -580,6 +718,7 @@ namespace libpe
 		[[nodiscard]] virtual auto GetBoundImport() -> PEBOUNDIMPORT_VEC* = 0;
 		[[nodiscard]] virtual auto GetDelayImport() -> PEDELAYIMPORT_VEC* = 0;
 		[[nodiscard]] virtual auto GetCOMDescriptor() -> PECOMDESCRIPTOR* = 0;
+		[[nodiscard]] virtual auto GetEmbedded() -> PEEMBEDDED_VEC* = 0;
 		[[nodiscard]] virtual auto GetImageBase()const->ULONGLONG = 0;
 		[[nodiscard]] virtual auto GetSecHdrFromName(LPCSTR lpszName)const->PIMAGE_SECTION_HEADER = 0;
 		[[nodiscard]] virtual auto GetSecHdrFromRVA(ULONGLONG ullRVA)const->PIMAGE_SECTION_HEADER = 0;
@@ -597,6 +736,8 @@ namespace libpe
 	constexpr auto ERR_FILE_SIZESMALL = 0x02;
 	constexpr auto ERR_FILE_MAPPING = 0x03;
 	constexpr auto ERR_FILE_NODOSHDR = 0x04;
+	constexpr auto ERR_PARSE_CANCELLED = 0x05; //GetParseStatus: PEParseOptions::pfCancel was set.
+	constexpr auto ERR_PARSE_BUDGET = 0x06;    //GetParseStatus: PEParseOptions::ullMaxAlloc was exceeded.
 
 #ifdef LIBPE_SHARED_DLL
 #ifdef LIBPE_SHARED_DLL_EXPORT
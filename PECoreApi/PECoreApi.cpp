@@ -0,0 +1,231 @@
+#include <Windows.h>
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include "PECoreApi.h"
+#include <libpe.h>
+#include <MappedFile.h>
+
+//
+// the mapping (for files opened by path) stays alive with the parsed tables, which point into it
+//
+struct PeCoreFile {
+	MappedFile File;
+	libpe::IlibpePtr PE{ libpe::Createlibpe() };
+	std::optional<libpe::PERESFLAT_VEC> Resources;		// flattened on the first resource walk
+};
+
+namespace {
+	PeCoreFile* Load(std::unique_ptr<PeCoreFile> file, std::span<const std::byte> data, int* error) {
+		auto result = data.empty() ? PECORE_ERR_FILE_SIZESMALL : file->PE->LoadPe(data);
+		if (error)
+			*error = result;
+		return result == libpe::PEOK ? file.release() : nullptr;
+	}
+}
+
+uint32_t PeCoreGetApiVersion(void) {
+	return PECORE_API_VERSION;
+}
+
+PeCoreFile* PeCoreOpen(const char* path, int* error) {
+	if (path == nullptr) {
+		if (error)
+			*error = PECORE_ERR_INVALID_ARG;
+		return nullptr;
+	}
+
+	try {
+		auto chars = ::MultiByteToWideChar(CP_UTF8, 0, path, -1, nullptr, 0);
+		std::wstring widePath(chars, L'\0');
+		::MultiByteToWideChar(CP_UTF8, 0, path, -1, widePath.data(), chars);
+		widePath.resize(wcslen(widePath.c_str()));
+
+		auto file = std::make_unique<PeCoreFile>();
+		if (!file->File.Open(widePath)) {
+			if (error)
+				*error = PECORE_ERR_FILE_OPEN;
+			return nullptr;
+		}
+		auto data = file->File.GetData();
+		return Load(std::move(file), data, error);
+	}
+	catch (...) {
+		if (error)
+			*error = PECORE_ERR_FILE_MAPPING;
+		return nullptr;
+	}
+}
+
+PeCoreFile* PeCoreOpenMemory(const void* data, size_t size, int* error) {
+	if (data == nullptr) {
+		if (error)
+			*error = PECORE_ERR_INVALID_ARG;
+		return nullptr;
+	}
+
+	try {
+		return Load(std::make_unique<PeCoreFile>(), { static_cast<const std::byte*>(data), size }, error);
+	}
+	catch (...) {
+		if (error)
+			*error = PECORE_ERR_FILE_MAPPING;
+		return nullptr;
+	}
+}
+
+void PeCoreClose(PeCoreFile* file) {
+	delete file;
+}
+
+int PeCoreGetInfo(PeCoreFile* file, PeCoreInfo* info) {
+	if (file == nullptr || info == nullptr)
+		return 0;
+
+	auto& pe = file->PE;
+	*info = {};
+	info->Data = reinterpret_cast<const uint8_t*>(pe->GetBaseAddr());
+	info->DataSize = static_cast<size_t>(pe->GetDataSize());
+
+	auto nt = pe->GetNTHeader();
+	if (nt == nullptr)
+		return 1;
+
+	auto& fh = nt->NTHdr32.FileHeader;
+	info->Machine = fh.Machine;
+	info->Characteristics = fh.Characteristics;
+	info->TimeDateStamp = fh.TimeDateStamp;
+	info->Is64 = pe->GetFileInfo()->IsPE64;
+	if (info->Is64) {
+		auto& oh = nt->NTHdr64.OptionalHeader;
+		info->Subsystem = oh.Subsystem;
+		info->DllCharacteristics = oh.DllCharacteristics;
+		info->EntryPoint = oh.AddressOfEntryPoint;
+		info->SizeOfImage = oh.SizeOfImage;
+		info->ImageBase = oh.ImageBase;
+	}
+	else {
+		auto& oh = nt->NTHdr32.OptionalHeader;
+		info->Subsystem = oh.Subsystem;
+		info->DllCharacteristics = oh.DllCharacteristics;
+		info->EntryPoint = oh.AddressOfEntryPoint;
+		info->SizeOfImage = oh.SizeOfImage;
+		info->ImageBase = oh.ImageBase;
+	}
+	return 1;
+}
+
+int PeCoreNextImport(PeCoreFile* file, PeCoreIterator* it, PeCoreImport* entry) {
+	if (file == nullptr || it == nullptr || entry == nullptr)
+		return 0;
+
+	auto imports = file->PE->GetImport();
+	if (imports == nullptr)
+		return 0;
+
+	auto is64 = file->PE->GetFileInfo()->IsPE64;
+	for (; it->Index < imports->size(); it->Index++, it->SubIndex = 0) {
+		auto& lib = (*imports)[it->Index];
+		if (it->SubIndex >= lib.ImportFunc.size())
+			continue;
+
+		auto& func = lib.ImportFunc[it->SubIndex++];
+		*entry = {};
+		entry->Module = lib.ModuleName.data();
+		entry->ModuleLength = lib.ModuleName.size();
+		auto byOrdinal = is64 ? IMAGE_SNAP_BY_ORDINAL64(func.unThunk.Thunk64.u1.Ordinal) : IMAGE_SNAP_BY_ORDINAL32(func.unThunk.Thunk32.u1.Ordinal);
+		if (byOrdinal)
+			entry->Ordinal = static_cast<uint16_t>(is64 ? IMAGE_ORDINAL64(func.unThunk.Thunk64.u1.Ordinal) : IMAGE_ORDINAL32(func.unThunk.Thunk32.u1.Ordinal));
+		else {
+			entry->Name = func.FuncName.data();
+			entry->NameLength = func.FuncName.size();
+			entry->Hint = func.ImpByName.Hint;
+		}
+		entry->References = func.References;
+		return 1;
+	}
+	return 0;
+}
+
+int PeCoreNextExport(PeCoreFile* file, PeCoreIterator* it, PeCoreExport* entry) {
+	if (file == nullptr || it == nullptr || entry == nullptr)
+		return 0;
+
+	auto exports = file->PE->GetExport();
+	if (exports == nullptr || it->Index >= exports->Funcs.size())
+		return 0;
+
+	auto& func = exports->Funcs[it->Index++];
+	*entry = {};
+	if (!func.FuncName.empty()) {
+		entry->Name = func.FuncName.data();
+		entry->NameLength = func.FuncName.size();
+	}
+	if (!func.ForwarderName.empty()) {
+		entry->Forwarder = func.ForwarderName.data();
+		entry->ForwarderLength = func.ForwarderName.size();
+	}
+	entry->Ordinal = exports->ExportDesc.Base + func.Ordinal;
+	entry->Rva = func.FuncRVA;
+	return 1;
+}
+
+int PeCoreNextSection(PeCoreFile* file, PeCoreIterator* it, PeCoreSection* entry) {
+	if (file == nullptr || it == nullptr || entry == nullptr)
+		return 0;
+
+	auto sections = file->PE->GetSecHeaders();
+	if (sections == nullptr || it->Index >= sections->size())
+		return 0;
+
+	auto& sec = (*sections)[it->Index++];
+	auto& header = sec.SecHdr;
+	*entry = {};
+	entry->Name = sec.SectionName.data();
+	entry->NameLength = sec.SectionName.size();
+	entry->VirtualAddress = header.VirtualAddress;
+	entry->VirtualSize = header.Misc.VirtualSize;
+	entry->Characteristics = header.Characteristics;
+	entry->Entropy = sec.Entropy;
+
+	auto size = file->PE->GetDataSize();
+	if (header.PointerToRawData < size) {
+		entry->Data = reinterpret_cast<const uint8_t*>(file->PE->GetBaseAddr()) + header.PointerToRawData;
+		entry->DataSize = static_cast<size_t>((std::min)(ULONGLONG(header.SizeOfRawData), size - header.PointerToRawData));
+	}
+	return 1;
+}
+
+int PeCoreNextResource(PeCoreFile* file, PeCoreIterator* it, PeCoreResource* entry) {
+	if (file == nullptr || it == nullptr || entry == nullptr)
+		return 0;
+
+	if (!file->Resources) {
+		try {
+			auto root = file->PE->GetResources();
+			file->Resources = root ? libpe::Ilibpe::FlatResources(*root) : libpe::PERESFLAT_VEC();
+		}
+		catch (...) {
+			return 0;
+		}
+	}
+	if (it->Index >= file->Resources->size())
+		return 0;
+
+	auto& res = (*file->Resources)[it->Index++];
+	*entry = {};
+	if (!res.TypeStr.empty()) {
+		entry->Type = reinterpret_cast<const uint16_t*>(res.TypeStr.data());
+		entry->TypeLength = res.TypeStr.size();
+	}
+	if (!res.NameStr.empty()) {
+		entry->Name = reinterpret_cast<const uint16_t*>(res.NameStr.data());
+		entry->NameLength = res.NameStr.size();
+	}
+	entry->TypeId = res.TypeID;
+	entry->NameId = res.NameID;
+	entry->Language = res.LangID;
+	entry->Data = reinterpret_cast<const uint8_t*>(res.Data.data());
+	entry->DataSize = res.Data.size();
+	return 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * C interface of PECore, for embedding from C and from other languages.
+ *
+ * A PeCoreFile keeps the image mapped for as long as it is open. Strings and data handed out are
+ * pointers with lengths into the mapping or into the parsed tables the file owns; they are not
+ * NUL terminated and stay valid until PeCoreClose. Nothing is copied at the boundary.
+ *
+ * Tables are walked with an iterator that starts zeroed (PECORE_ITERATOR_INIT): each PeCoreNext*
+ * call fills the entry and returns 1, or returns 0 at the end. Structs only grow at their end;
+ * PeCoreGetApiVersion tells which fields a library has.
+ *
+ * Define PECORE_API_EXPORTS when building the shared library, PECORE_API_STATIC when linking the
+ * sources in directly.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(PECORE_API_STATIC)
+#define PECORE_API
+#elif defined(_WIN32)
+#ifdef PECORE_API_EXPORTS
+#define PECORE_API __declspec(dllexport)
+#else
+#define PECORE_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define PECORE_API __attribute__((visibility("default")))
+#else
+#define PECORE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PECORE_API_VERSION 1
+
+/* error codes, the libpe ones */
+#define PECORE_OK 0
+#define PECORE_ERR_FILE_OPEN 1
+#define PECORE_ERR_FILE_SIZESMALL 2
+#define PECORE_ERR_FILE_MAPPING 3
+#define PECORE_ERR_FILE_NODOSHDR 4
+#define PECORE_ERR_INVALID_ARG 0x100
+
+typedef struct PeCoreFile PeCoreFile;
+
+typedef struct PeCoreIterator {
+	uint32_t Index;
+	uint32_t SubIndex;
+} PeCoreIterator;
+
+#define PECORE_ITERATOR_INIT { 0, 0 }
+
+typedef struct PeCoreInfo {
+	int Is64;
+	uint16_t Machine;				/* IMAGE_FILE_MACHINE_* */
+	uint16_t Characteristics;
+	uint16_t Subsystem;
+	uint16_t DllCharacteristics;
+	uint32_t TimeDateStamp;
+	uint32_t EntryPoint;			/* RVA */
+	uint32_t SizeOfImage;
+	uint64_t ImageBase;
+	const uint8_t* Data;			/* the whole file */
+	size_t DataSize;
+} PeCoreInfo;
+
+typedef struct PeCoreImport {
+	const char* Module;
+	size_t ModuleLength;
+	const char* Name;				/* NULL for imports by ordinal */
+	size_t NameLength;
+	uint16_t Ordinal;				/* imports by ordinal only */
+	uint16_t Hint;
+	uint32_t References;			/* calls/jumps through the IAT slot, when import usage was scanned */
+} PeCoreImport;
+
+typedef struct PeCoreExport {
+	const char* Name;				/* NULL for exports by ordinal only */
+	size_t NameLength;
+	const char* Forwarder;			/* NULL unless forwarded */
+	size_t ForwarderLength;
+	uint32_t Ordinal;				/* biased by the export directory's base */
+	uint32_t Rva;
+} PeCoreExport;
+
+typedef struct PeCoreSection {
+	const char* Name;
+	size_t NameLength;
+	uint32_t VirtualAddress;
+	uint32_t VirtualSize;
+	uint32_t Characteristics;
+	const uint8_t* Data;			/* raw data, cut at the end of the file */
+	size_t DataSize;
+	double Entropy;					/* bits per byte, -1 if not computed */
+} PeCoreSection;
+
+typedef struct PeCoreResource {
+	const uint16_t* Type;			/* UTF-16, NULL for numeric types */
+	size_t TypeLength;
+	const uint16_t* Name;			/* UTF-16, NULL for numeric names */
+	size_t NameLength;
+	uint16_t TypeId;
+	uint16_t NameId;
+	uint16_t Language;
+	const uint8_t* Data;
+	size_t DataSize;
+} PeCoreResource;
+
+PECORE_API uint32_t PeCoreGetApiVersion(void);
+
+/* path is UTF-8; error (optional) gets a PECORE_ERR_* code on failure */
+PECORE_API PeCoreFile* PeCoreOpen(const char* path, int* error);
+/* data is not copied and has to outlive the file */
+PECORE_API PeCoreFile* PeCoreOpenMemory(const void* data, size_t size, int* error);
+PECORE_API void PeCoreClose(PeCoreFile* file);
+
+PECORE_API int PeCoreGetInfo(PeCoreFile* file, PeCoreInfo* info);
+PECORE_API int PeCoreNextImport(PeCoreFile* file, PeCoreIterator* it, PeCoreImport* entry);
+PECORE_API int PeCoreNextExport(PeCoreFile* file, PeCoreIterator* it, PeCoreExport* entry);
+PECORE_API int PeCoreNextSection(PeCoreFile* file, PeCoreIterator* it, PeCoreSection* entry);
+PECORE_API int PeCoreNextResource(PeCoreFile* file, PeCoreIterator* it, PeCoreResource* entry);
+
+#ifdef __cplusplus
+}
+#endif